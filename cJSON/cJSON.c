@@ -30,6 +30,15 @@
 #include <float.h>
 #include <limits.h>
 #include <ctype.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#ifndef CJSON_NO_THREADS
+#include <pthread.h>
+#include <unistd.h>
+#endif
 #include "cJSON.h"
 
 static const char *ep;
@@ -69,6 +78,79 @@ void cJSON_InitHooks(cJSON_Hooks* hooks)
 	cJSON_free	 = (hooks->free_fn)?hooks->free_fn:free;
 }
 
+/* Index over an array/object: a contiguous view of the items plus, for objects, two hashes of the keys,
+   case folded for cJSON_GetObjectItem and exact for the case sensitive lookup, so that one skips tolower.
+   The arrays follow the header; capacity is a power of two at least twice the item count. */
+typedef struct {unsigned hash;cJSON *item;} index_slot;
+typedef struct cJSON_Index {int capacity,count;cJSON **items;index_slot *slots,*exact;} cJSON_Index;
+static int index_threshold=0;
+
+#ifndef CJSON_COMPACT
+/* FNV-1a; folded is consistent with cJSON_strcasecmp, exact with strcmp. */
+static unsigned index_hash(const char *str,int fold)
+{
+	unsigned h=2166136261u;
+	if (fold) while (*str) h=(h^(unsigned)tolower(*(const unsigned char*)str++))*16777619u;
+	else while (*str) h=(h^(unsigned)*(const unsigned char*)str++)*16777619u;
+	return h;
+}
+/* Equal keys land on the same probe sequence in insertion order, so lookups still find the first one. */
+static void slot_insert(index_slot *slots,int capacity,unsigned hash,cJSON *item)
+{
+	int i=hash&(capacity-1);
+	while (slots[i].item) i=(i+1)&(capacity-1);
+	slots[i].hash=hash;slots[i].item=item;
+}
+static void index_insert(cJSON_Index *index,cJSON *item)
+{
+	index->items[index->count++]=item;
+	if (!index->slots || !item->string) return;
+	slot_insert(index->slots,index->capacity,index_hash(item->string,1),item);
+	slot_insert(index->exact,index->capacity,index_hash(item->string,0),item);
+}
+static void index_free(cJSON *container) {if (container->index) cJSON_free(container->index);container->index=0;}
+/* Lookups build the index, and a container in a chain shared by cJSON_DuplicateShared is looked up from every tree
+   holding it, so the index is published the way share counts are: threads race to install theirs and one wins. */
+#if defined(__GNUC__)
+#define index_get(c)		__atomic_load_n(&(c)->index,__ATOMIC_ACQUIRE)
+#define index_set(c,i)		__sync_bool_compare_and_swap(&(c)->index,0,i)
+#else
+#define index_get(c)		((c)->index)
+#define index_set(c,i)		((c)->index?0:((c)->index=(i),1))
+#endif
+static cJSON_Index *container_index(cJSON *container)
+{
+	cJSON *c;cJSON_Index *index=index_get(container);int capacity=8,keyed=((container->type&255)==cJSON_Object);
+	if (index || !index_threshold || container->size<index_threshold || (container->type&cJSON_IsReference)) return index;	/* references share children the index would not see change */
+	while (capacity<container->size*2) capacity<<=1;
+	index=(cJSON_Index*)cJSON_malloc(sizeof(cJSON_Index)+capacity*(sizeof(cJSON*)+(keyed?2*sizeof(index_slot):0)));
+	if (!index) return 0;
+	index->capacity=capacity;index->count=0;index->items=(cJSON**)(index+1);index->slots=keyed?(index_slot*)(index->items+capacity):0;index->exact=keyed?index->slots+capacity:0;
+	if (keyed) memset(index->slots,0,2*capacity*sizeof(index_slot));
+	for (c=container->child;c;c=c->next) index_insert(index,c);
+	if (!index_set(container,index)) {cJSON_free(index);index=index_get(container);}
+	return index;
+}
+/* Keep the index in step with appends; drop it when nearly full so the next lookup rebuilds it bigger. */
+static void index_append(cJSON *container,cJSON *item)
+{
+	if (!container->index) return;
+	if ((container->index->count+1)*2>container->index->capacity) index_free(container); else index_insert(container->index,item);
+}
+static cJSON *index_find(cJSON_Index *index,const char *string,int case_sensitive)
+{
+	index_slot *slots=case_sensitive?index->exact:index->slots;unsigned hash=index_hash(string,!case_sensitive);int i=hash&(index->capacity-1);
+	for (;slots[i].item;i=(i+1)&(index->capacity-1))
+		if (slots[i].hash==hash && !(case_sensitive?strcmp(slots[i].item->string,string):cJSON_strcasecmp(slots[i].item->string,string))) return slots[i].item;
+	return 0;
+}
+#else	/* the compact layout has no index: every lookup walks the chain */
+static void index_free(cJSON *container) {(void)container;}
+static cJSON_Index *container_index(cJSON *container) {(void)container;return 0;}
+static void index_append(cJSON *container,cJSON *item) {(void)container;(void)item;}
+static cJSON *index_find(cJSON_Index *index,const char *string,int case_sensitive) {(void)index;(void)string;(void)case_sensitive;return 0;}
+#endif
+
 /* Internal constructor. */
 static cJSON *cJSON_New_Item(void)
 {
@@ -76,34 +158,107 @@ static cJSON *cJSON_New_Item(void)
 	if (node) memset(node,0,sizeof(cJSON));
 	return node;
 }
+/* The parser allocates through its context only, so concurrent parses share nothing. */
+static cJSON *parse_new_item(cJSON_Context *ctx)
+{
+	cJSON* node = (cJSON*)ctx->hooks.malloc_fn(sizeof(cJSON));
+	if (node) memset(node,0,sizeof(cJSON));
+	return node;
+}
 
-/* Delete a cJSON structure. */
-void cJSON_Delete(cJSON *c)
+#ifndef CJSON_COMPACT
+/* Copy-on-write sharing: every item holding the same child chain and valuestring points to one count of its holders.
+   The count is created on first share with 1 for the original item; the last holder to let go frees the body. */
+typedef struct cJSON_Share {int refs;} cJSON_Share;
+#if defined(__GNUC__)
+#define share_inc(s)		__atomic_add_fetch(&(s)->refs,1,__ATOMIC_RELAXED)
+#define share_dec(s)		__atomic_sub_fetch(&(s)->refs,1,__ATOMIC_ACQ_REL)
+#define share_refs(s)		__atomic_load_n(&(s)->refs,__ATOMIC_ACQUIRE)
+#define share_get(p)		__atomic_load_n(p,__ATOMIC_ACQUIRE)
+#define share_set(p,s)		__sync_bool_compare_and_swap(p,0,s)
+#else	/* no atomics: copies of one template must be made and changed from one thread at a time */
+#define share_inc(s)		(++(s)->refs)
+#define share_dec(s)		(--(s)->refs)
+#define share_refs(s)		((s)->refs)
+#define share_get(p)		(*(p))
+#define share_set(p,s)		(*(p)?0:(*(p)=(s),1))
+#endif
+/* Count one more holder of c's body. Two threads copying the same template item race to create the count; one wins. */
+static cJSON_Share *share_acquire(cJSON *c)
+{
+	cJSON_Share *s=share_get(&c->share);
+	if (!s)
+	{
+		if (!(s=(cJSON_Share*)cJSON_malloc(sizeof(cJSON_Share)))) return 0;
+		s->refs=1;
+		if (!share_set(&c->share,s)) {cJSON_free(s);s=share_get(&c->share);}
+	}
+	share_inc(s);
+	return s;
+}
+/* Drop c's hold on its body; returns 1 when c was the last holder, so the body is now c's to free. */
+static int share_release(cJSON *c)
 {
-	cJSON *next;
+	cJSON_Share *s=c->share;
+	c->share=0;
+	if (share_dec(s)) return 0;
+	cJSON_free(s);
+	return 1;
+}
+#define size_add(c,n)		((c)->size+=(n))
+#define size_set(c,n)		((c)->size=(n))
+#define item_shared(c)		((c)->share)
+#define item_valuestring(c)	((c)->valuestring)
+#define clear_aux(c)		((c)->index=0,(c)->share=0)
+#else	/* compact layout: no size, share or separate valuestring field */
+#define share_release(c)	1
+#define size_add(c,n)		((void)0)
+#define size_set(c,n)		((void)0)
+#define item_shared(c)		0
+#define item_valuestring(c)	(((c)->type&255)==cJSON_String?(c)->valuestring:0)
+#define clear_aux(c)		((void)0)
+#endif
+#ifndef CJSON_INLINE_STRING
+#define CJSON_INLINE_STRING 0
+#endif
+
+/* Delete a cJSON structure, handing nodes and strings to free_fn. */
+static void delete_item(cJSON *c,void (*free_fn)(void *ptr))
+{
+	cJSON *next;int owner;
 	while (c)
 	{
 		next=c->next;
-		if (!(c->type&cJSON_IsReference) && c->child) cJSON_Delete(c->child);
-		if (!(c->type&cJSON_IsReference) && c->valuestring) cJSON_free(c->valuestring);
-		if (!(c->type&cJSON_StringIsConst) && c->string) cJSON_free(c->string);
-		cJSON_free(c);
+		owner=!(c->type&cJSON_IsReference) && (!item_shared(c) || share_release(c));
+		if (owner && c->child) delete_item(c->child,free_fn);
+		index_free(c);	/* indexes are built on lookup, always from the global hooks */
+		if (owner && !(c->type&cJSON_ValueIsInline) && item_valuestring(c)) free_fn(c->valuestring);
+		if (!(c->type&cJSON_StringIsConst) && c->string) free_fn(c->string);
+		free_fn(c);
 		c=next;
 	}
 }
+void cJSON_Delete(cJSON *c)	{delete_item(c,cJSON_free);}
+void cJSON_DeleteWithContext(cJSON_Context *ctx,cJSON *c)	{delete_item(c,ctx?ctx->hooks.free_fn:cJSON_free);}
+
+/* The scanners read the text through peek, which returns 0 at ctx->end as well as at the terminator, so a parse with a
+   length never looks past its buffer. have checks that n bytes can be read at p before they are read directly. */
+static char peek(const char *p,const cJSON_Context *ctx)	{return (!ctx->end || p<ctx->end)?*p:0;}
+static int have(const char *p,int n,const cJSON_Context *ctx)	{while (n--) if (!peek(p++,ctx)) return 0; return 1;}
+static int digit(const char *p,const cJSON_Context *ctx)	{char c=peek(p,ctx);return c>='0' && c<='9';}
 
 /* Parse the input text to generate a number, and populate the result into item. */
-static const char *parse_number(cJSON *item,const char *num)
+static const char *parse_number(cJSON *item,const char *num,const cJSON_Context *ctx)
 {
-	double n=0,sign=1,scale=0;int subscale=0,signsubscale=1;
-
-	if (*num=='-') sign=-1,num++;	/* Has sign? */
-	if (*num=='0') num++;			/* is zero */
-	if (*num>='1' && *num<='9')	do	n=(n*10.0)+(*num++ -'0');	while (*num>='0' && *num<='9');	/* Number? */
-	if (*num=='.' && num[1]>='0' && num[1]<='9') {num++;		do	n=(n*10.0)+(*num++ -'0'),scale--; while (*num>='0' && *num<='9');}	/* Fractional part? */
-	if (*num=='e' || *num=='E')		/* Exponent? */
-	{	num++;if (*num=='+') num++;	else if (*num=='-') signsubscale=-1,num++;		/* With sign? */
-		while (*num>='0' && *num<='9') subscale=(subscale*10)+(*num++ - '0');	/* Number? */
+	double n=0,sign=1,scale=0;int subscale=0,signsubscale=1;char c;
+
+	if (peek(num,ctx)=='-') sign=-1,num++;	/* Has sign? */
+	if (peek(num,ctx)=='0') num++;			/* is zero */
+	if ((c=peek(num,ctx))>='1' && c<='9')	do	n=(n*10.0)+(*num++ -'0');	while (digit(num,ctx));	/* Number? */
+	if (peek(num,ctx)=='.' && digit(num+1,ctx)) {num++;		do	n=(n*10.0)+(*num++ -'0'),scale--; while (digit(num,ctx));}	/* Fractional part? */
+	if ((c=peek(num,ctx))=='e' || c=='E')		/* Exponent? */
+	{	num++;if ((c=peek(num,ctx))=='+') num++;	else if (c=='-') signsubscale=-1,num++;		/* With sign? */
+		while (digit(num,ctx)) subscale=(subscale*10)+(*num++ - '0');	/* Number? */
 	}
 
 	n=sign*n*pow(10.0,(scale+subscale*signsubscale));	/* number = +/- number.fraction * 10^+/- exponent */
@@ -116,20 +271,21 @@ static const char *parse_number(cJSON *item,const char *num)
 
 static int pow2gt (int x)	{	--x;	x|=x>>1;	x|=x>>2;	x|=x>>4;	x|=x>>8;	x|=x>>16;	return x+1;	}
 
-typedef struct {char *buffer; int length; int offset; } printbuffer;
+typedef cJSON_PrintBuffer printbuffer;
 
 static char* ensure(printbuffer *p,int needed)
 {
 	char *newbuffer;int newsize;
 	if (!p || !p->buffer) return 0;
 	needed+=p->offset;
+	if (needed>p->needed) p->needed=needed;		/* High-water mark, so a buffer of this size never has to grow. */
 	if (needed<=p->length) return p->buffer+p->offset;
 
 	newsize=pow2gt(needed);
-	newbuffer=(char*)cJSON_malloc(newsize);
-	if (!newbuffer) {cJSON_free(p->buffer);p->length=0,p->buffer=0;return 0;}
+	newbuffer=(char*)(p->hooks?p->hooks->malloc_fn:cJSON_malloc)(newsize);
+	if (!newbuffer) {(p->hooks?p->hooks->free_fn:cJSON_free)(p->buffer);p->length=0,p->buffer=0;return 0;}
 	if (newbuffer) memcpy(newbuffer,p->buffer,p->length);
-	cJSON_free(p->buffer);
+	(p->hooks?p->hooks->free_fn:cJSON_free)(p->buffer);
 	p->length=newsize;
 	p->buffer=newbuffer;
 	return newbuffer+p->offset;
@@ -187,40 +343,53 @@ static unsigned parse_hex4(const char *str)
 	return h;
 }
 
-/* Parse the input text into an unescaped cstring, and populate item. */
 static const unsigned char firstByteMark[7] = { 0x00, 0x00, 0xC0, 0xE0, 0xF0, 0xF8, 0xFC };
-static const char *parse_string(cJSON *item,const char *str)
+/* Find the end of the string at str: returns the byte after the closing quote and, in len, a bound on the decoded length. */
+static const char *scan_string(const char *str,int *len,const cJSON_Context *ctx)
 {
-	const char *ptr=str+1;char *ptr2;char *out;int len=0;unsigned uc,uc2;
-	if (*str!='\"') {ep=str;return 0;}	/* not a string! */
-	
-	while (*ptr!='\"' && *ptr && ++len) if (*ptr++ == '\\') ptr++;	/* Skip escaped quotes. */
-	
-	out=(char*)cJSON_malloc(len+1);	/* This is how long we need for the string, roughly. */
-	if (!out) return 0;
-	
-	ptr=str+1;ptr2=out;
-	while (*ptr!='\"' && *ptr)
+	const char *ptr=str+1;char c;int n=0;	/* count in a local: a store through len might alias the text, forcing a store per byte */
+	while ((c=peek(ptr,ctx))!='\"' && c && ++n) if (*ptr++ == '\\' && peek(ptr,ctx)) ptr++;	/* Skip escaped quotes. */
+	*len=n;
+	return c=='\"'?ptr+1:ptr;
+}
+#if CJSON_INLINE_STRING
+/* scan_string for strings that fit in CJSON_INLINE_STRING bytes with their terminator: gives up after that many, so a
+   long string is not read once more just to learn it is long. Returns 0 for a long or unterminated string. */
+static const char *scan_inline(const char *str,int *len,const cJSON_Context *ctx)
+{
+	const char *ptr=str+1;char c;int n=0;
+	while ((c=peek(ptr,ctx))!='\"') {if (!c || ++n+1>=CJSON_INLINE_STRING) return 0;if (*ptr++ == '\\' && peek(ptr,ctx)) ptr++;}
+	*len=n;
+	return ptr+1;
+}
+#endif
+/* Decode the string at str into out, which holds the length scan_string found plus the terminator. Fails if the closing quote is missing. */
+static const char *decode_string(char *out,const char *str,cJSON_Context *ctx)
+{
+	const char *ptr=str+1;char *ptr2=out,c;int len;unsigned uc,uc2;
+	while ((c=peek(ptr,ctx))!='\"' && c)
 	{
-		if (*ptr!='\\') *ptr2++=*ptr++;
+		if (c!='\\') *ptr2++=*ptr++;
 		else
 		{
 			ptr++;
-			switch (*ptr)
+			switch (peek(ptr,ctx))
 			{
+				case 0:	continue;	/* the text ends after the backslash */
 				case 'b': *ptr2++='\b';	break;
 				case 'f': *ptr2++='\f';	break;
 				case 'n': *ptr2++='\n';	break;
 				case 'r': *ptr2++='\r';	break;
 				case 't': *ptr2++='\t';	break;
 				case 'u':	 /* transcode utf16 to utf8. */
+					if (!have(ptr+1,4,ctx))	break;	/* truncated escape. */
 					uc=parse_hex4(ptr+1);ptr+=4;	/* get the unicode char. */
 
 					if ((uc>=0xDC00 && uc<=0xDFFF) || uc==0)	break;	/* check for invalid.	*/
 
 					if (uc>=0xD800 && uc<=0xDBFF)	/* UTF16 surrogate pairs.	*/
 					{
-						if (ptr[1]!='\\' || ptr[2]!='u')	break;	/* missing second-half of surrogate.	*/
+						if (peek(ptr+1,ctx)!='\\' || peek(ptr+2,ctx)!='u' || !have(ptr+3,4,ctx))	break;	/* missing second-half of surrogate.	*/
 						uc2=parse_hex4(ptr+3);ptr+=6;
 						if (uc2<0xDC00 || uc2>0xDFFF)		break;	/* invalid second-half of surrogate.	*/
 						uc=0x10000 + (((uc&0x3FF)<<10) | (uc2&0x3FF));
@@ -242,10 +411,20 @@ static const char *parse_string(cJSON *item,const char *str)
 		}
 	}
 	*ptr2=0;
-	if (*ptr=='\"') ptr++;
+	if (c!='\"') {ctx->error=str;return 0;}	/* unterminated string */
+	return ptr+1;
+}
+/* Parse the input text into an unescaped cstring, and populate item. */
+static const char *parse_string(cJSON *item,const char *str,cJSON_Context *ctx)
+{
+	char *out;int len;
+	if (peek(str,ctx)!='\"') {ctx->error=str;return 0;}	/* not a string! */
+	scan_string(str,&len,ctx);
+	out=(char*)ctx->hooks.malloc_fn(len+1);	/* This is how long we need for the string, roughly. */
+	if (!out) return 0;
 	item->valuestring=out;
 	item->type=cJSON_String;
-	return ptr;
+	return decode_string(out,str,ctx);
 }
 
 /* Render the cstring provided to an escaped version that can be printed. */
@@ -309,35 +488,150 @@ static char *print_string_ptr(const char *str,printbuffer *p)
 static char *print_string(cJSON *item,printbuffer *p)	{return print_string_ptr(item->valuestring,p);}
 
 /* Predeclare these prototypes. */
-static const char *parse_value(cJSON *item,const char *value);
+static const char *parse_value(cJSON *item,const char *value,cJSON_Context *ctx);
 static char *print_value(cJSON *item,int depth,int fmt,printbuffer *p);
-static const char *parse_array(cJSON *item,const char *value);
+static const char *parse_array(cJSON *item,const char *value,cJSON_Context *ctx);
 static char *print_array(cJSON *item,int depth,int fmt,printbuffer *p);
-static const char *parse_object(cJSON *item,const char *value);
+static const char *parse_object(cJSON *item,const char *value,cJSON_Context *ctx);
 static char *print_object(cJSON *item,int depth,int fmt,printbuffer *p);
 
 /* Utility to jump whitespace and cr/lf */
-static const char *skip(const char *in) {while (in && *in && (unsigned char)*in<=32) in++; return in;}
+static const char *skip(const char *in,const cJSON_Context *ctx) {while (in && peek(in,ctx) && (unsigned char)*in<=32) in++; return in;}
 
 /* Parse an object - create a new root, and populate. */
 cJSON *cJSON_ParseWithOpts(const char *value,const char **return_parse_end,int require_null_terminated)
+{
+	cJSON_Context ctx;cJSON *c;
+	ctx.hooks.malloc_fn=cJSON_malloc;ctx.hooks.free_fn=cJSON_free;
+	c=cJSON_ParseWithContext(&ctx,value,return_parse_end,require_null_terminated);
+	ep=ctx.error;
+	return c;
+}
+/* Parse value up to its terminator, or up to ctx->end if that is set. */
+static cJSON *parse_root(cJSON_Context *ctx,const char *value,const char **return_parse_end,int require_null_terminated)
 {
 	const char *end=0;
-	cJSON *c=cJSON_New_Item();
-	ep=0;
+	cJSON *c=parse_new_item(ctx);
+	ctx->error=0;
 	if (!c) return 0;       /* memory fail */
 
-	end=parse_value(c,skip(value));
-	if (!end)	{cJSON_Delete(c);return 0;}	/* parse failure. ep is set. */
+	end=parse_value(c,skip(value,ctx),ctx);
+	if (!end)	{delete_item(c,ctx->hooks.free_fn);return 0;}	/* parse failure. ctx->error is set. */
 
-	/* if we require null-terminated JSON without appended garbage, skip and then check for a null terminator */
-	if (require_null_terminated) {end=skip(end);if (*end) {cJSON_Delete(c);ep=end;return 0;}}
+	/* if we require null-terminated JSON without appended garbage, skip and then check for a null terminator (or the end of the buffer) */
+	if (require_null_terminated) {end=skip(end,ctx);if (peek(end,ctx)) {delete_item(c,ctx->hooks.free_fn);ctx->error=end;return 0;}}
 	if (return_parse_end) *return_parse_end=end;
 	return c;
 }
+cJSON *cJSON_ParseWithContext(cJSON_Context *ctx,const char *value,const char **return_parse_end,int require_null_terminated)
+{
+	ctx->end=0;
+	return parse_root(ctx,value,return_parse_end,require_null_terminated);
+}
 /* Default options for cJSON_Parse */
 cJSON *cJSON_Parse(const char *value) {return cJSON_ParseWithOpts(value,0,0);}
 
+/* Length-delimited text: the parse stops after length bytes, or earlier at a terminator. */
+cJSON *cJSON_ParseWithLengthContext(cJSON_Context *ctx,const char *value,size_t length,const char **return_parse_end,int require_null_terminated)
+{
+	ctx->end=value?value+length:0;
+	return parse_root(ctx,value,return_parse_end,require_null_terminated);
+}
+cJSON *cJSON_ParseWithLengthOpts(const char *value,size_t length,const char **return_parse_end,int require_null_terminated)
+{
+	cJSON_Context ctx;cJSON *c;
+	ctx.hooks.malloc_fn=cJSON_malloc;ctx.hooks.free_fn=cJSON_free;
+	c=cJSON_ParseWithLengthContext(&ctx,value,length,return_parse_end,require_null_terminated);
+	ep=ctx.error;
+	return c;
+}
+cJSON *cJSON_ParseWithLength(const char *value,size_t length) {return cJSON_ParseWithLengthOpts(value,length,0,0);}
+
+/* NDJSON batches. Lines are found up front; workers then claim blocks of them from a shared cursor and parse each with
+   their own context, so the cursor is the only thing they share. Define CJSON_NO_THREADS to parse on the caller only. */
+#define BATCH_BLOCK 64	/* records a worker claims at a time */
+typedef struct {const char *start,*end;} batch_line;	/* a record and its newline (or terminator) */
+typedef struct {batch_line *lines;cJSON **records;int count,next;
+#ifndef CJSON_NO_THREADS
+	pthread_mutex_t lock;
+#endif
+} batch_job;
+
+static void batch_parse(batch_job *job,int first,int last)
+{
+	cJSON_Context ctx;int i;
+	ctx.hooks.malloc_fn=cJSON_malloc;ctx.hooks.free_fn=cJSON_free;
+	for (i=first;i<last;i++)	/* each record is bounded by its newline and must fill its line */
+		job->records[i]=cJSON_ParseWithLengthContext(&ctx,job->lines[i].start,job->lines[i].end-job->lines[i].start,0,1);
+}
+
+#ifndef CJSON_NO_THREADS
+static void *batch_worker(void *arg)
+{
+	batch_job *job=(batch_job*)arg;int first;
+	for (;;)
+	{
+		pthread_mutex_lock(&job->lock);first=job->next;if (first<job->count) job->next+=BATCH_BLOCK;pthread_mutex_unlock(&job->lock);
+		if (first>=job->count) return 0;
+		batch_parse(job,first,job->count-first>BATCH_BLOCK?first+BATCH_BLOCK:job->count);
+	}
+}
+#endif
+
+int cJSON_ParseBatch(const char *ndjson,int threads,cJSON ***records)
+{
+	batch_job job;const char *p=ndjson,*q,*eol;batch_line *grown;int capacity=1024;
+	*records=0;
+	if (!ndjson) return -1;
+	job.count=job.next=0;
+	if (!(job.lines=(batch_line*)cJSON_malloc(capacity*sizeof(batch_line)))) return -1;
+	for (;*p;p=eol+1)	/* one entry per line that is not blank */
+	{
+		for (q=p;*q==' ' || *q=='\t' || *q=='\r';q++);
+		if (!(eol=strchr(q,'\n'))) eol=q+strlen(q);
+		if (eol!=q)
+		{
+			if (job.count==capacity)
+			{
+				if (!(grown=(batch_line*)cJSON_malloc(capacity*2*sizeof(batch_line)))) {cJSON_free(job.lines);return -1;}
+				memcpy(grown,job.lines,capacity*sizeof(batch_line));cJSON_free(job.lines);job.lines=grown;capacity*=2;
+			}
+			job.lines[job.count].start=p;job.lines[job.count++].end=eol;
+		}
+		if (!*eol) break;
+	}
+	if (!(job.records=(cJSON**)cJSON_malloc((job.count?job.count:1)*sizeof(cJSON*)))) {cJSON_free(job.lines);return -1;}
+
+#ifndef CJSON_NO_THREADS
+	{
+		pthread_t *workers=0;int i,started=0;
+		if (threads<=0) threads=(int)sysconf(_SC_NPROCESSORS_ONLN);
+		if (threads>(job.count+BATCH_BLOCK-1)/BATCH_BLOCK) threads=(job.count+BATCH_BLOCK-1)/BATCH_BLOCK;
+		pthread_mutex_init(&job.lock,0);
+		if (threads>1 && (workers=(pthread_t*)cJSON_malloc((threads-1)*sizeof(pthread_t))))
+			for (i=0;i<threads-1;i++) if (!pthread_create(&workers[started],0,batch_worker,&job)) started++;
+		batch_worker(&job);	/* the caller works too, and finishes alone if no thread could be started */
+		for (i=0;i<started;i++) pthread_join(workers[i],0);
+		if (workers) cJSON_free(workers);
+		pthread_mutex_destroy(&job.lock);
+	}
+#else
+	(void)threads;
+	batch_parse(&job,0,job.count);
+#endif
+	cJSON_free(job.lines);
+	*records=job.records;
+	return job.count;
+}
+
+void cJSON_DeleteBatch(cJSON **records,int count)
+{
+	int i;
+	if (!records) return;
+	for (i=0;i<count;i++) cJSON_Delete(records[i]);
+	cJSON_free(records);
+}
+
 /* Render a cJSON item/entity/structure to text. */
 char *cJSON_Print(cJSON *item)				{return print_value(item,0,1,0);}
 char *cJSON_PrintUnformatted(cJSON *item)	{return print_value(item,0,0,0);}
@@ -348,24 +642,84 @@ char *cJSON_PrintBuffered(cJSON *item,int prebuffer,int fmt)
 	p.buffer=(char*)cJSON_malloc(prebuffer);
 	p.length=prebuffer;
 	p.offset=0;
+	p.needed=0;
+	p.hooks=0;
 	return print_value(item,0,fmt,&p);
 	return p.buffer;
 }
 
+/* Persistent print buffers: the memory is kept between renders, so a steady-state loop never touches the heap. */
+void cJSON_InitPrintBuffer(cJSON_PrintBuffer *pb,int prebuffer)
+{
+	pb->buffer=prebuffer>0?(char*)cJSON_malloc(prebuffer):0;
+	pb->length=pb->buffer?prebuffer:0;
+	pb->offset=0;
+	pb->needed=0;
+	pb->hooks=0;
+}
+
+const char *cJSON_PrintToBuffer(cJSON *item,cJSON_PrintBuffer *pb,int fmt)
+{
+	char *out;
+	if (!item || !pb) return 0;
+	if (!pb->buffer)	/* Never allocated, or released by a failed grow: start from the last known size. */
+	{
+		pb->length=pb->needed>256?pb->needed:256;
+		pb->buffer=(char*)(pb->hooks?pb->hooks->malloc_fn:cJSON_malloc)(pb->length);
+		if (!pb->buffer) {pb->length=0;return 0;}
+	}
+	pb->offset=0;pb->needed=0;
+	out=print_value(item,0,fmt,pb);
+	pb->offset=0;
+	return out;
+}
+
+int cJSON_PrintBufferNeeded(const cJSON_PrintBuffer *pb)	{return pb?pb->needed:0;}
+
+void cJSON_FreePrintBuffer(cJSON_PrintBuffer *pb)
+{
+	if (pb->buffer) (pb->hooks?pb->hooks->free_fn:cJSON_free)(pb->buffer);
+	pb->buffer=0;pb->length=pb->offset=0;
+}
+
+/* Contexts: everything a parse or print mutates lives here rather than in the globals above. */
+void cJSON_InitContext(cJSON_Context *ctx,cJSON_Hooks *hooks)
+{
+	ctx->hooks.malloc_fn=(hooks && hooks->malloc_fn)?hooks->malloc_fn:malloc;
+	ctx->hooks.free_fn=(hooks && hooks->free_fn)?hooks->free_fn:free;
+	ctx->error=ctx->end=0;
+	cJSON_InitPrintBuffer(&ctx->print,0);
+	ctx->print.hooks=&ctx->hooks;
+}
+void cJSON_FreeContext(cJSON_Context *ctx)	{ctx->print.hooks=&ctx->hooks;cJSON_FreePrintBuffer(&ctx->print);}
+
+char *cJSON_PrintWithContext(cJSON_Context *ctx,cJSON *item,int fmt)
+{
+	const char *out;char *copy;size_t len;
+	ctx->print.hooks=&ctx->hooks;
+	if (!(out=cJSON_PrintToBuffer(item,&ctx->print,fmt))) return 0;
+	len=strlen(out)+1;	/* the scratch stays with the context; hand back an exact-size copy */
+	if (!(copy=(char*)ctx->hooks.malloc_fn(len))) return 0;
+	memcpy(copy,out,len);
+	return copy;
+}
+
 
 /* Parser core - when encountering text, process appropriately. */
-static const char *parse_value(cJSON *item,const char *value)
+static const char *parse_value(cJSON *item,const char *value,cJSON_Context *ctx)
 {
+	char c;
 	if (!value)						return 0;	/* Fail on null. */
-	if (!strncmp(value,"null",4))	{ item->type=cJSON_NULL;  return value+4; }
-	if (!strncmp(value,"false",5))	{ item->type=cJSON_False; return value+5; }
-	if (!strncmp(value,"true",4))	{ item->type=cJSON_True; item->valueint=1;	return value+4; }
-	if (*value=='\"')				{ return parse_string(item,value); }
-	if (*value=='-' || (*value>='0' && *value<='9'))	{ return parse_number(item,value); }
-	if (*value=='[')				{ return parse_array(item,value); }
-	if (*value=='{')				{ return parse_object(item,value); }
-
-	ep=value;return 0;	/* failure. */
+	c=peek(value,ctx);
+	if (c=='n' && have(value,4,ctx) && !strncmp(value,"null",4))	{ item->type=cJSON_NULL;  return value+4; }
+	if (c=='f' && have(value,5,ctx) && !strncmp(value,"false",5))	{ item->type=cJSON_False; return value+5; }
+	if (c=='t' && have(value,4,ctx) && !strncmp(value,"true",4))	{ item->type=cJSON_True; item->valueint=1;	return value+4; }
+	if (c=='\"')				{ return parse_string(item,value,ctx); }
+	if (c=='-' || (c>='0' && c<='9'))	{ return parse_number(item,value,ctx); }
+	if (c=='[')				{ return parse_array(item,value,ctx); }
+	if (c=='{')				{ return parse_object(item,value,ctx); }
+
+	ctx->error=value;return 0;	/* failure. */
 }
 
 /* Render a value to text. */
@@ -402,32 +756,72 @@ static char *print_value(cJSON *item,int depth,int fmt,printbuffer *p)
 	return out;
 }
 
+/* Append a new item to the array/object item and parse it, key first for objects. Keys and string values shorter
+   than CJSON_INLINE_STRING bytes (compact layout only) are decoded into the item's own allocation. */
+static const char *parse_member(cJSON *item,const char *value,cJSON_Context *ctx)
+{
+	const char *key=0,*end;cJSON *child;int keylen=0,inkey=0,len=0;
+	if ((item->type&255)==cJSON_Object)
+	{
+		key=value;
+#if CJSON_INLINE_STRING
+		if (peek(key,ctx)!='\"') {ctx->error=key;return 0;}	/* not a key! */
+		value=skip(scan_string(key,&keylen,ctx),ctx);keylen++;inkey=keylen<CJSON_INLINE_STRING?keylen:0;	/* with the terminator */
+		if (peek(value,ctx)!=':') {ctx->error=value;return 0;}	/* fail! */
+		value=skip(value+1,ctx);
+#endif
+	}
+#if CJSON_INLINE_STRING
+	if (peek(value,ctx)=='\"') len=scan_inline(value,&len,ctx)?len+1:0;
+#endif
+	if (!(child=(cJSON*)ctx->hooks.malloc_fn(sizeof(cJSON)+inkey+len))) return 0;	/* memory fail */
+	memset(child,0,sizeof(cJSON));
+	if (item->tail) {item->tail->next=child;child->prev=item->tail;} else item->child=child;
+	item->tail=child;size_add(item,1);
+
+	if (inkey) decode_string(child->string=(char*)(child+1),key,ctx);
+	else if (keylen)	/* a long key, already scanned: decode it straight into its own allocation */
+	{
+		if (!(child->string=(char*)ctx->hooks.malloc_fn(keylen))) return 0;
+		decode_string(child->string,key,ctx);
+	}
+	else if (key)
+	{
+		end=skip(parse_string(child,key,ctx),ctx);
+		if (!end) return 0;
+		child->string=child->valuestring;child->valuestring=0;
+		if (key==value)	/* the key was not scanned ahead */
+		{
+			if (peek(end,ctx)!=':') {ctx->error=end;return 0;}	/* fail! */
+			value=skip(end+1,ctx);
+		}
+	}
+	if (len) {value=decode_string(child->valuestring=(char*)(child+1)+inkey,value,ctx);child->type=cJSON_String|cJSON_ValueIsInline;}
+	else value=parse_value(child,value,ctx);	/* skip any spacing, get the value. */
+	if (inkey) child->type|=cJSON_StringIsConst;
+	return value;
+}
+
 /* Build an array from input text. */
-static const char *parse_array(cJSON *item,const char *value)
+static const char *parse_array(cJSON *item,const char *value,cJSON_Context *ctx)
 {
-	cJSON *child;
-	if (*value!='[')	{ep=value;return 0;}	/* not an array! */
+	if (peek(value,ctx)!='[')	{ctx->error=value;return 0;}	/* not an array! */
 
 	item->type=cJSON_Array;
-	value=skip(value+1);
-	if (*value==']') return value+1;	/* empty array. */
+	value=skip(value+1,ctx);
+	if (peek(value,ctx)==']') return value+1;	/* empty array. */
 
-	item->child=child=cJSON_New_Item();
-	if (!item->child) return 0;		 /* memory fail */
-	value=skip(parse_value(child,skip(value)));	/* skip any spacing, get the value. */
+	value=skip(parse_member(item,value,ctx),ctx);
 	if (!value) return 0;
 
-	while (*value==',')
+	while (peek(value,ctx)==',')
 	{
-		cJSON *new_item;
-		if (!(new_item=cJSON_New_Item())) return 0; 	/* memory fail */
-		child->next=new_item;new_item->prev=child;child=new_item;
-		value=skip(parse_value(child,skip(value+1)));
+		value=skip(parse_member(item,skip(value+1,ctx),ctx),ctx);
 		if (!value) return 0;	/* memory fail */
 	}
 
-	if (*value==']') return value+1;	/* end of array */
-	ep=value;return 0;	/* malformed. */
+	if (peek(value,ctx)==']') return value+1;	/* end of array */
+	ctx->error=value;return 0;	/* malformed. */
 }
 
 /* Render an array to text */
@@ -511,39 +905,25 @@ static char *print_array(cJSON *item,int depth,int fmt,printbuffer *p)
 }
 
 /* Build an object from the text. */
-static const char *parse_object(cJSON *item,const char *value)
+static const char *parse_object(cJSON *item,const char *value,cJSON_Context *ctx)
 {
-	cJSON *child;
-	if (*value!='{')	{ep=value;return 0;}	/* not an object! */
+	if (peek(value,ctx)!='{')	{ctx->error=value;return 0;}	/* not an object! */
 	
 	item->type=cJSON_Object;
-	value=skip(value+1);
-	if (*value=='}') return value+1;	/* empty array. */
+	value=skip(value+1,ctx);
+	if (peek(value,ctx)=='}') return value+1;	/* empty array. */
 	
-	item->child=child=cJSON_New_Item();
-	if (!item->child) return 0;
-	value=skip(parse_string(child,skip(value)));
-	if (!value) return 0;
-	child->string=child->valuestring;child->valuestring=0;
-	if (*value!=':') {ep=value;return 0;}	/* fail! */
-	value=skip(parse_value(child,skip(value+1)));	/* skip any spacing, get the value. */
+	value=skip(parse_member(item,value,ctx),ctx);
 	if (!value) return 0;
 	
-	while (*value==',')
+	while (peek(value,ctx)==',')
 	{
-		cJSON *new_item;
-		if (!(new_item=cJSON_New_Item()))	return 0; /* memory fail */
-		child->next=new_item;new_item->prev=child;child=new_item;
-		value=skip(parse_string(child,skip(value+1)));
-		if (!value) return 0;
-		child->string=child->valuestring;child->valuestring=0;
-		if (*value!=':') {ep=value;return 0;}	/* fail! */
-		value=skip(parse_value(child,skip(value+1)));	/* skip any spacing, get the value. */
+		value=skip(parse_member(item,skip(value+1,ctx),ctx),ctx);
 		if (!value) return 0;
 	}
 	
-	if (*value=='}') return value+1;	/* end of array */
-	ep=value;return 0;	/* malformed. */
+	if (peek(value,ctx)=='}') return value+1;	/* end of array */
+	ctx->error=value;return 0;	/* malformed. */
 }
 
 /* Render an object to text. */
@@ -658,34 +1038,40 @@ static char *print_object(cJSON *item,int depth,int fmt,printbuffer *p)
 }
 
 /* Get Array size/item / object item. */
+#ifndef CJSON_COMPACT
+int    cJSON_GetArraySize(cJSON *array)							{return array->size;}
+#else
 int    cJSON_GetArraySize(cJSON *array)							{cJSON *c=array->child;int i=0;while(c)i++,c=c->next;return i;}
-cJSON *cJSON_GetArrayItem(cJSON *array,int item)				{cJSON *c=array->child;  while (c && item>0) item--,c=c->next; return c;}
-cJSON *cJSON_GetObjectItem(cJSON *object,const char *string)	{cJSON *c=object->child; while (c && cJSON_strcasecmp(c->string,string)) c=c->next; return c;}
+#endif
+cJSON *cJSON_GetArrayItem(cJSON *array,int item)				{cJSON *c=array->child;cJSON_Index *index=item>0?container_index(array):0; if (index) return item<index->count?index->items[item]:0; while (c && item>0) item--,c=c->next; return c;}
+cJSON *cJSON_GetObjectItem(cJSON *object,const char *string)	{cJSON *c=object->child;cJSON_Index *index=string?container_index(object):0; if (index && index->slots) return index_find(index,string,0); while (c && cJSON_strcasecmp(c->string,string)) c=c->next; return c;}
+cJSON *cJSON_GetObjectItemCaseSensitive(cJSON *object,const char *string)	{cJSON *c=object->child;cJSON_Index *index;if (!string) return 0;index=container_index(object); if (index && index->slots) return index_find(index,string,1); while (c && (!c->string || strcmp(c->string,string))) c=c->next; return c;}
+void   cJSON_SetIndexThreshold(int threshold)						{index_threshold=threshold>0?threshold:0;}
 
 /* Utility for array list handling. */
 static void suffix_object(cJSON *prev,cJSON *item) {prev->next=item;item->prev=prev;}
 /* Utility for handling references. */
-static cJSON *create_reference(cJSON *item) {cJSON *ref=cJSON_New_Item();if (!ref) return 0;memcpy(ref,item,sizeof(cJSON));ref->string=0;ref->type|=cJSON_IsReference;ref->next=ref->prev=0;return ref;}
+static cJSON *create_reference(cJSON *item) {cJSON *ref=cJSON_New_Item();if (!ref) return 0;memcpy(ref,item,sizeof(cJSON));ref->string=0;ref->type|=cJSON_IsReference;ref->next=ref->prev=0;clear_aux(ref);return ref;}
 
 /* Add item to array/object. */
-void   cJSON_AddItemToArray(cJSON *array, cJSON *item)						{cJSON *c=array->child;if (!item) return; if (!c) {array->child=item;} else {while (c && c->next) c=c->next; suffix_object(c,item);}}
-void   cJSON_AddItemToObject(cJSON *object,const char *string,cJSON *item)	{if (!item) return; if (item->string) cJSON_free(item->string);item->string=cJSON_strdup(string);cJSON_AddItemToArray(object,item);}
+void   cJSON_AddItemToArray(cJSON *array, cJSON *item)						{if (!item || !cJSON_Unshare(array)) return; if (!array->child) {array->child=item;} else suffix_object(array->tail,item); array->tail=item;size_add(array,1);index_append(array,item);}
+void   cJSON_AddItemToObject(cJSON *object,const char *string,cJSON *item)	{if (!item) return; if (!(item->type&cJSON_StringIsConst) && item->string) cJSON_free(item->string);item->string=cJSON_strdup(string);item->type&=~cJSON_StringIsConst;cJSON_AddItemToArray(object,item);}
 void   cJSON_AddItemToObjectCS(cJSON *object,const char *string,cJSON *item)	{if (!item) return; if (!(item->type&cJSON_StringIsConst) && item->string) cJSON_free(item->string);item->string=(char*)string;item->type|=cJSON_StringIsConst;cJSON_AddItemToArray(object,item);}
 void	cJSON_AddItemReferenceToArray(cJSON *array, cJSON *item)						{cJSON_AddItemToArray(array,create_reference(item));}
 void	cJSON_AddItemReferenceToObject(cJSON *object,const char *string,cJSON *item)	{cJSON_AddItemToObject(object,string,create_reference(item));}
 
-cJSON *cJSON_DetachItemFromArray(cJSON *array,int which)			{cJSON *c=array->child;while (c && which>0) c=c->next,which--;if (!c) return 0;
-	if (c->prev) c->prev->next=c->next;if (c->next) c->next->prev=c->prev;if (c==array->child) array->child=c->next;c->prev=c->next=0;return c;}
+cJSON *cJSON_DetachItemFromArray(cJSON *array,int which)			{cJSON *c;if (!cJSON_Unshare(array)) return 0;c=array->child;while (c && which>0) c=c->next,which--;if (!c) return 0;index_free(array);
+	if (c->prev) c->prev->next=c->next;if (c->next) c->next->prev=c->prev;if (c==array->child) array->child=c->next;if (c==array->tail) array->tail=c->prev;size_add(array,-1);c->prev=c->next=0;return c;}
 void   cJSON_DeleteItemFromArray(cJSON *array,int which)			{cJSON_Delete(cJSON_DetachItemFromArray(array,which));}
 cJSON *cJSON_DetachItemFromObject(cJSON *object,const char *string) {int i=0;cJSON *c=object->child;while (c && cJSON_strcasecmp(c->string,string)) i++,c=c->next;if (c) return cJSON_DetachItemFromArray(object,i);return 0;}
 void   cJSON_DeleteItemFromObject(cJSON *object,const char *string) {cJSON_Delete(cJSON_DetachItemFromObject(object,string));}
 
 /* Replace array/object items with new ones. */
-void   cJSON_InsertItemInArray(cJSON *array,int which,cJSON *newitem)		{cJSON *c=array->child;while (c && which>0) c=c->next,which--;if (!c) {cJSON_AddItemToArray(array,newitem);return;}
-	newitem->next=c;newitem->prev=c->prev;c->prev=newitem;if (c==array->child) array->child=newitem; else newitem->prev->next=newitem;}
-void   cJSON_ReplaceItemInArray(cJSON *array,int which,cJSON *newitem)		{cJSON *c=array->child;while (c && which>0) c=c->next,which--;if (!c) return;
-	newitem->next=c->next;newitem->prev=c->prev;if (newitem->next) newitem->next->prev=newitem;
-	if (c==array->child) array->child=newitem; else newitem->prev->next=newitem;c->next=c->prev=0;cJSON_Delete(c);}
+void   cJSON_InsertItemInArray(cJSON *array,int which,cJSON *newitem)		{cJSON *c;if (!cJSON_Unshare(array)) return;c=array->child;while (c && which>0) c=c->next,which--;if (!c) {cJSON_AddItemToArray(array,newitem);return;}
+	index_free(array);newitem->next=c;newitem->prev=c->prev;c->prev=newitem;if (c==array->child) array->child=newitem; else newitem->prev->next=newitem;size_add(array,1);}
+void   cJSON_ReplaceItemInArray(cJSON *array,int which,cJSON *newitem)		{cJSON *c;if (!cJSON_Unshare(array)) return;c=array->child;while (c && which>0) c=c->next,which--;if (!c) return;
+	index_free(array);newitem->next=c->next;newitem->prev=c->prev;if (newitem->next) newitem->next->prev=newitem;
+	if (c==array->child) array->child=newitem; else newitem->prev->next=newitem;if (c==array->tail) array->tail=newitem;c->next=c->prev=0;cJSON_Delete(c);}
 void   cJSON_ReplaceItemInObject(cJSON *object,const char *string,cJSON *newitem){int i=0;cJSON *c=object->child;while(c && cJSON_strcasecmp(c->string,string))i++,c=c->next;if(c){newitem->string=cJSON_strdup(string);cJSON_ReplaceItemInArray(object,i,newitem);}}
 
 /* Create basic types: */
@@ -699,10 +1085,10 @@ cJSON *cJSON_CreateArray(void)					{cJSON *item=cJSON_New_Item();if(item)item->t
 cJSON *cJSON_CreateObject(void)					{cJSON *item=cJSON_New_Item();if(item)item->type=cJSON_Object;return item;}
 
 /* Create Arrays: */
-cJSON *cJSON_CreateIntArray(const int *numbers,int count)		{int i;cJSON *n=0,*p=0,*a=cJSON_CreateArray();for(i=0;a && i<count;i++){n=cJSON_CreateNumber(numbers[i]);if(!i)a->child=n;else suffix_object(p,n);p=n;}return a;}
-cJSON *cJSON_CreateFloatArray(const float *numbers,int count)	{int i;cJSON *n=0,*p=0,*a=cJSON_CreateArray();for(i=0;a && i<count;i++){n=cJSON_CreateNumber(numbers[i]);if(!i)a->child=n;else suffix_object(p,n);p=n;}return a;}
-cJSON *cJSON_CreateDoubleArray(const double *numbers,int count)	{int i;cJSON *n=0,*p=0,*a=cJSON_CreateArray();for(i=0;a && i<count;i++){n=cJSON_CreateNumber(numbers[i]);if(!i)a->child=n;else suffix_object(p,n);p=n;}return a;}
-cJSON *cJSON_CreateStringArray(const char **strings,int count)	{int i;cJSON *n=0,*p=0,*a=cJSON_CreateArray();for(i=0;a && i<count;i++){n=cJSON_CreateString(strings[i]);if(!i)a->child=n;else suffix_object(p,n);p=n;}return a;}
+cJSON *cJSON_CreateIntArray(const int *numbers,int count)		{int i;cJSON *n=0,*p=0,*a=cJSON_CreateArray();for(i=0;a && i<count;i++){n=cJSON_CreateNumber(numbers[i]);if(!i)a->child=n;else suffix_object(p,n);p=n;}if (a) a->tail=p,size_set(a,i);return a;}
+cJSON *cJSON_CreateFloatArray(const float *numbers,int count)	{int i;cJSON *n=0,*p=0,*a=cJSON_CreateArray();for(i=0;a && i<count;i++){n=cJSON_CreateNumber(numbers[i]);if(!i)a->child=n;else suffix_object(p,n);p=n;}if (a) a->tail=p,size_set(a,i);return a;}
+cJSON *cJSON_CreateDoubleArray(const double *numbers,int count)	{int i;cJSON *n=0,*p=0,*a=cJSON_CreateArray();for(i=0;a && i<count;i++){n=cJSON_CreateNumber(numbers[i]);if(!i)a->child=n;else suffix_object(p,n);p=n;}if (a) a->tail=p,size_set(a,i);return a;}
+cJSON *cJSON_CreateStringArray(const char **strings,int count)	{int i;cJSON *n=0,*p=0,*a=cJSON_CreateArray();for(i=0;a && i<count;i++){n=cJSON_CreateString(strings[i]);if(!i)a->child=n;else suffix_object(p,n);p=n;}if (a) a->tail=p,size_set(a,i);return a;}
 
 /* Duplication */
 cJSON *cJSON_Duplicate(cJSON *item,int recurse)
@@ -714,8 +1100,8 @@ cJSON *cJSON_Duplicate(cJSON *item,int recurse)
 	newitem=cJSON_New_Item();
 	if (!newitem) return 0;
 	/* Copy over all vars */
-	newitem->type=item->type&(~cJSON_IsReference),newitem->valueint=item->valueint,newitem->valuedouble=item->valuedouble;
-	if (item->valuestring)	{newitem->valuestring=cJSON_strdup(item->valuestring);	if (!newitem->valuestring)	{cJSON_Delete(newitem);return 0;}}
+	newitem->type=item->type&(~(cJSON_IsReference|cJSON_StringIsConst|cJSON_ValueIsInline)),newitem->valueint=item->valueint,newitem->valuedouble=item->valuedouble;
+	if (item_valuestring(item))	{newitem->valuestring=cJSON_strdup(item->valuestring);	if (!newitem->valuestring)	{cJSON_Delete(newitem);return 0;}}
 	if (item->string)		{newitem->string=cJSON_strdup(item->string);			if (!newitem->string)		{cJSON_Delete(newitem);return 0;}}
 	/* If non-recursive, then we're done! */
 	if (!recurse) return newitem;
@@ -727,24 +1113,183 @@ cJSON *cJSON_Duplicate(cJSON *item,int recurse)
 		if (!newchild) {cJSON_Delete(newitem);return 0;}
 		if (nptr)	{nptr->next=newchild,newchild->prev=nptr;nptr=newchild;}	/* If newitem->child already set, then crosswire ->prev and ->next and move on */
 		else		{newitem->child=newchild;nptr=newchild;}					/* Set newitem->child and move to it */
+		newitem->tail=nptr;size_add(newitem,1);
 		cptr=cptr->next;
 	}
 	return newitem;
 }
 
+#ifndef CJSON_COMPACT
+/* Copy-on-write duplication. A copy of c shares c's body (child chain and valuestring) and has its own key. */
+static cJSON *share_copy(cJSON *c)
+{
+	cJSON *copy=cJSON_New_Item();
+	if (!copy) return 0;
+	memcpy(copy,c,sizeof(cJSON));copy->next=copy->prev=0;copy->index=0;copy->share=0;
+	if (c->string && !(c->type&cJSON_StringIsConst) && !(copy->string=cJSON_strdup(c->string))) {cJSON_free(copy);return 0;}
+	if (!(c->type&cJSON_IsReference) && (c->child || c->valuestring) && !(copy->share=share_acquire(c)))
+	{
+		if (copy->string && !(c->type&cJSON_StringIsConst)) cJSON_free(copy->string);
+		cJSON_free(copy);return 0;
+	}
+	return copy;
+}
+cJSON *cJSON_DuplicateShared(cJSON *item)	{return item?share_copy(item):0;}
+
+/* Replace a shared body by private copies: the item chain one level deep (each copy sharing its original's body) and
+   valuestring. The last holder just takes the body over. */
+cJSON *cJSON_Unshare(cJSON *item)
+{
+	cJSON *c,*copy,*child=0,*tail=0;char *valuestring=0;
+	if (!item || !item->share) return item;
+	if (share_refs(item->share)==1) {share_release(item);return item;}	/* only item can reach the count, so nobody can join meanwhile */
+	if (item->valuestring && !(valuestring=cJSON_strdup(item->valuestring))) return 0;
+	for (c=item->child;c;c=c->next)
+	{
+		if (!(copy=share_copy(c))) {cJSON_Delete(child);if (valuestring) cJSON_free(valuestring);return 0;}
+		if (tail) suffix_object(tail,copy); else child=copy;
+		tail=copy;
+	}
+	if (share_release(item))	/* the other holders let go while we copied */
+	{
+		cJSON_Delete(item->child);
+		if (item->valuestring) cJSON_free(item->valuestring);
+	}
+	index_free(item);
+	item->child=child;item->tail=tail;item->valuestring=valuestring;
+	return item;
+}
+#else	/* no share counts in the compact layout: duplicates are deep and always private */
+cJSON *cJSON_DuplicateShared(cJSON *item)	{return cJSON_Duplicate(item,1);}
+cJSON *cJSON_Unshare(cJSON *item)			{return item;}
+#endif
+cJSON *cJSON_GetArrayItemForWrite(cJSON *array,int item)				{return cJSON_Unshare(array)?cJSON_GetArrayItem(array,item):0;}
+cJSON *cJSON_GetObjectItemForWrite(cJSON *object,const char *string)	{return cJSON_Unshare(object)?cJSON_GetObjectItem(object,string):0;}
+
+/* Minify kernels: classify a block of 32 (AVX2) or 16 (SSE2) bytes per step. A block is loaded unaligned only when it
+   cannot cross into the next page, so reading past the terminator never faults; near page ends the scalar step runs. */
+#if defined(__AVX2__)
+#define MINIFY_BLOCK 32
+typedef __m256i minify_vec;
+#define MV_LOADU(p)		_mm256_loadu_si256((const __m256i*)(p))
+#define MV_STOREU(p,v)	_mm256_storeu_si256((__m256i*)(p),v)
+#define MV_SET1(c)		_mm256_set1_epi8(c)
+#define MV_EQ(a,b)		_mm256_cmpeq_epi8(a,b)
+#define MV_OR(a,b)		_mm256_or_si256(a,b)
+#define MV_MASK(v)		((unsigned)_mm256_movemask_epi8(v))
+#define MINIFY_FULL		0xFFFFFFFFu
+#elif defined(__SSE2__)
+#define MINIFY_BLOCK 16
+typedef __m128i minify_vec;
+#define MV_LOADU(p)		_mm_loadu_si128((const __m128i*)(p))
+#define MV_STOREU(p,v)	_mm_storeu_si128((__m128i*)(p),v)
+#define MV_SET1(c)		_mm_set1_epi8(c)
+#define MV_EQ(a,b)		_mm_cmpeq_epi8(a,b)
+#define MV_OR(a,b)		_mm_or_si128(a,b)
+#define MV_MASK(v)		((unsigned)_mm_movemask_epi8(v))
+#define MINIFY_FULL		0xFFFFu
+#endif
+#if defined(MINIFY_BLOCK)
+#define MINIFY_NO_PAGE_CROSS(p)	(((size_t)(p)&4095)<=4096-MINIFY_BLOCK)
+#endif
+
+/* Loads may read past the terminator within the same page; tell AddressSanitizer that is intended. */
+#if defined(__SANITIZE_ADDRESS__)
+#define NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address))
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address))
+#endif
+#endif
+#ifndef NO_SANITIZE_ADDRESS
+#define NO_SANITIZE_ADDRESS
+#endif
+
+/* Copy JSON outside strings and comments, dropping whitespace; stop on a quote, slash or the terminator. into never passes json,
+   so a whole block may be stored once all of it has been consumed. */
+NO_SANITIZE_ADDRESS static void minify_plain(char **pjson,char **pinto)
+{
+	char *json=*pjson,*into=*pinto;unsigned i;
+#if defined(MINIFY_BLOCK)
+	const minify_vec sp=MV_SET1(' '),tab=MV_SET1('\t'),cr=MV_SET1('\r'),lf=MV_SET1('\n'),quote=MV_SET1('\"'),slash=MV_SET1('/'),zero=MV_SET1(0);
+	minify_vec v;unsigned ws,stop,n;
+#endif
+	for (i=0;i<8;i++)	/* runs between strings in compact JSON are short: try a few bytes before setting up a block */
+	{
+		if (*json==' ' || *json=='\t' || *json=='\r' || *json=='\n') json++;
+		else if (*json=='\"' || *json=='/' || !*json) {*pjson=json;*pinto=into;return;}
+		else *into++=*json++;
+	}
+	for (;;)
+	{
+#if defined(MINIFY_BLOCK)
+		if (MINIFY_NO_PAGE_CROSS(json))
+		{
+			v=MV_LOADU(json);
+			ws=MV_MASK(MV_OR(MV_OR(MV_EQ(v,sp),MV_EQ(v,tab)),MV_OR(MV_EQ(v,cr),MV_EQ(v,lf))));
+			stop=MV_MASK(MV_OR(MV_OR(MV_EQ(v,quote),MV_EQ(v,slash)),MV_EQ(v,zero)));
+			if (!stop)
+			{
+				if (!ws)				{MV_STOREU(into,v);into+=MINIFY_BLOCK;json+=MINIFY_BLOCK;continue;}	/* all tokens */
+				if (ws==MINIFY_FULL)	{json+=MINIFY_BLOCK;continue;}										/* all whitespace */
+			}
+			n=stop?(unsigned)__builtin_ctz(stop):MINIFY_BLOCK;
+			for (i=0;i<n;i++) {*into=json[i];into+=!((ws>>i)&1);}	/* compact the mixed part without branching */
+			json+=n;
+			if (stop) break;
+			continue;
+		}
+#endif
+		if (*json==' ' || *json=='\t' || *json=='\r' || *json=='\n') json++;
+		else if (*json=='\"' || *json=='/' || !*json) break;
+		else *into++=*json++;
+	}
+	*pjson=json;*pinto=into;
+}
+
+/* Copy the inside of a string literal verbatim up to a quote, backslash or the terminator. */
+NO_SANITIZE_ADDRESS static void minify_string(char **pjson,char **pinto)
+{
+	char *json=*pjson,*into=*pinto;
+#if defined(MINIFY_BLOCK)
+	const minify_vec quote=MV_SET1('\"'),backslash=MV_SET1('\\'),zero=MV_SET1(0);
+	minify_vec v;unsigned stop;
+	for (stop=0;stop<8;stop++)	/* most keys and short values end within a few bytes */
+	{
+		if (!*json || *json=='\"' || *json=='\\') {*pjson=json;*pinto=into;return;}
+		*into++=*json++;
+	}
+	while (MINIFY_NO_PAGE_CROSS(json))
+	{
+		v=MV_LOADU(json);
+		stop=MV_MASK(MV_OR(MV_OR(MV_EQ(v,quote),MV_EQ(v,backslash)),MV_EQ(v,zero)));
+		if (stop) {for (stop=__builtin_ctz(stop);stop;stop--) *into++=*json++;break;}	/* a whole-block store could clobber unread input */
+		MV_STOREU(into,v);into+=MINIFY_BLOCK;json+=MINIFY_BLOCK;
+	}
+#endif
+	while (*json && *json!='\"' && *json!='\\') *into++=*json++;
+	*pjson=json;*pinto=into;
+}
+
 void cJSON_Minify(char *json)
 {
 	char *into=json;
 	while (*json)
 	{
-		if (*json==' ') json++;
-		else if (*json=='\t') json++;	/* Whitespace characters. */
-		else if (*json=='\r') json++;
-		else if (*json=='\n') json++;
-		else if (*json=='/' && json[1]=='/')  while (*json && *json!='\n') json++;	/* double-slash comments, to end of line. */
-		else if (*json=='/' && json[1]=='*') {while (*json && !(*json=='*' && json[1]=='/')) json++;json+=2;}	/* multiline comments. */
-		else if (*json=='\"'){*into++=*json++;while (*json && *json!='\"'){if (*json=='\\') *into++=*json++;*into++=*json++;}*into++=*json++;} /* string literals, which are \" sensitive. */
-		else *into++=*json++;			/* All other characters. */
+		minify_plain(&json,&into);	/* Whitespace and tokens, up to the next quote, slash or the end. */
+		if (*json=='/' && json[1]=='/')  while (*json && *json!='\n') json++;	/* double-slash comments, to end of line. */
+		else if (*json=='/' && json[1]=='*') {json+=2;while (*json && !(*json=='*' && json[1]=='/')) json++;if (*json) json+=2;}	/* multiline comments; an unterminated one runs to the end. */
+		else if (*json=='\"')	/* string literals, which are \" sensitive. */
+		{
+			*into++=*json++;
+			for (;;)
+			{
+				minify_string(&json,&into);
+				if (*json=='\\' && json[1]) {*into++=*json++;*into++=*json++;} else break;
+			}
+			if (*json=='\"') *into++=*json++;
+		}
+		else if (*json) *into++=*json++;	/* a slash that starts no comment. */
 	}
 	*into=0;	/* and null-terminate. */
 }
@@ -39,11 +39,34 @@ extern "C"
 	
 #define cJSON_IsReference 256
 #define cJSON_StringIsConst 512
+#define cJSON_ValueIsInline 1024	/* valuestring lives in the item's own allocation (compact layout): don't free it */
 
 /* The cJSON structure: */
+#ifdef CJSON_COMPACT
+/* Compact layout, chosen by defining CJSON_COMPACT for cJSON.c and everything that includes cJSON.h: 56 bytes per item
+   on 64-bit targets instead of 88, which also drops it into a smaller malloc size class. valuestring and valuedouble
+   share storage, so read only the one type calls for. Keys and string values parsed from text that are shorter than
+   CJSON_INLINE_STRING bytes live in the item's own allocation (flagged cJSON_StringIsConst / cJSON_ValueIsInline).
+   There is no size, index or share: GetArraySize counts the chain, lookups walk it, cJSON_SetIndexThreshold has no
+   effect and cJSON_DuplicateShared makes a deep copy. Needs anonymous unions (C11, C++ or GNU C). */
+typedef struct cJSON {
+	struct cJSON *next,*prev;
+	struct cJSON *child;
+	struct cJSON *tail;
+	char *string;
+	union {char *valuestring;double valuedouble;};
+	int valueint;
+	int type;
+} cJSON;
+#ifndef CJSON_INLINE_STRING
+#define CJSON_INLINE_STRING 16
+#endif
+#else
 typedef struct cJSON {
 	struct cJSON *next,*prev;	/* next/prev allow you to walk array/object chains. Alternatively, use GetArraySize/GetArrayItem/GetObjectItem */
 	struct cJSON *child;		/* An array or object item will have a child pointer pointing to a chain of the items in the array/object. */
+	struct cJSON *tail;			/* The last item in the child chain of an array/object, so appends don't walk the chain. */
+	int size;					/* The number of items in an array/object. tail and size are only maintained by the cJSON calls, not by hand-linked chains. */
 
 	int type;					/* The type of the item, as above. */
 
@@ -52,15 +75,41 @@ typedef struct cJSON {
 	double valuedouble;			/* The item's number, if type==cJSON_Number */
 
 	char *string;				/* The item's name string, if this item is the child of, or is in the list of subitems of an object. */
+	struct cJSON_Index *index;	/* Index over an array/object's items and keys, built on demand by the GetArrayItem/GetObjectItem calls. */
+	struct cJSON_Share *share;	/* Set when child and valuestring are shared with other items by cJSON_DuplicateShared; they are then read-only. */
 } cJSON;
+#endif
+
+/* A reusable output buffer for cJSON_PrintToBuffer. buffer grows on demand and is kept between renders;
+   needed is the most space the last render asked for, i.e. a buffer of that size renders it without growing. */
+typedef struct cJSON_PrintBuffer {
+	char *buffer;
+	int length;
+	int offset;
+	int needed;
+	const struct cJSON_Hooks *hooks;	/* allocator for buffer; 0 means the global hooks */
+} cJSON_PrintBuffer;
 
 typedef struct cJSON_Hooks {
       void *(*malloc_fn)(size_t sz);
       void (*free_fn)(void *ptr);
 } cJSON_Hooks;
 
+/* Per-thread parse/print state. Calls taking a context allocate through its hooks and record errors in it instead of
+   the globals, so one context per thread parses and prints concurrently. A context must not be shared between threads. */
+typedef struct cJSON_Context {
+	cJSON_Hooks hooks;			/* allocator for nodes, strings and output */
+	const char *error;			/* where the last cJSON_ParseWithContext failed, 0 on success */
+	const char *end;			/* where the current parse stops, 0 for NUL-terminated text; set by the parse calls */
+	cJSON_PrintBuffer print;	/* scratch cJSON_PrintWithContext renders into, kept between calls */
+} cJSON_Context;
+
 /* Supply malloc, realloc and free functions to cJSON */
 extern void cJSON_InitHooks(cJSON_Hooks* hooks);
+/* Prepare a context; hooks (or its members) may be 0 for malloc/free. */
+extern void cJSON_InitContext(cJSON_Context *ctx,cJSON_Hooks *hooks);
+/* Release the scratch memory a context holds. Trees parsed with it are unaffected. */
+extern void cJSON_FreeContext(cJSON_Context *ctx);
 
 
 /* Supply a block of JSON, and this returns a cJSON object you can interrogate. Call cJSON_Delete when finished. */
@@ -71,15 +120,47 @@ extern char  *cJSON_Print(cJSON *item);
 extern char  *cJSON_PrintUnformatted(cJSON *item);
 /* Render a cJSON entity to text using a buffered strategy. prebuffer is a guess at the final size. guessing well reduces reallocation. fmt=0 gives unformatted, =1 gives formatted */
 extern char *cJSON_PrintBuffered(cJSON *item,int prebuffer,int fmt);
+/* Prepare a persistent print buffer with prebuffer bytes reserved (0 allocates on first use). Keep one per thread. */
+extern void cJSON_InitPrintBuffer(cJSON_PrintBuffer *pb,int prebuffer);
+/* Render into pb, reusing its memory; once it is large enough no allocation happens. Returns pb->buffer, which pb still owns and which is overwritten by the next call, or 0 on failure. */
+extern const char *cJSON_PrintToBuffer(cJSON *item,cJSON_PrintBuffer *pb,int fmt);
+/* Bytes the last cJSON_PrintToBuffer needed to render without growing; pass it as prebuffer to pre-size another buffer. */
+extern int cJSON_PrintBufferNeeded(const cJSON_PrintBuffer *pb);
+/* Release the memory held by a print buffer. It can be reused after cJSON_InitPrintBuffer. */
+extern void cJSON_FreePrintBuffer(cJSON_PrintBuffer *pb);
 /* Delete a cJSON entity and all subentities. */
 extern void   cJSON_Delete(cJSON *c);
-
-/* Returns the number of items in an array (or object). */
+/* Parse newline-delimited JSON, one record per line (blank lines are skipped), on up to threads workers (<=0: one per online CPU).
+   *records receives the roots in input order, 0 for a record that is invalid or does not end at its newline.
+   Returns the number of records, or -1 if memory ran out. Allocates through the global hooks, which must be thread-safe. */
+extern int    cJSON_ParseBatch(const char *ndjson,int threads,cJSON ***records);
+/* Delete the roots and the array returned by cJSON_ParseBatch. */
+extern void   cJSON_DeleteBatch(cJSON **records,int count);
+/* As cJSON_ParseWithOpts, but allocating through ctx->hooks and reporting failure in ctx->error. Free the result with cJSON_DeleteWithContext. */
+extern cJSON *cJSON_ParseWithContext(cJSON_Context *ctx,const char *value,const char **return_parse_end,int require_null_terminated);
+/* Parse text that is not NUL-terminated: nothing past value+length is read, and a NUL byte before it also ends the text.
+   require_null_terminated then asks for nothing but whitespace after the value up to that end. */
+extern cJSON *cJSON_ParseWithLength(const char *value,size_t length);
+extern cJSON *cJSON_ParseWithLengthOpts(const char *value,size_t length,const char **return_parse_end,int require_null_terminated);
+extern cJSON *cJSON_ParseWithLengthContext(cJSON_Context *ctx,const char *value,size_t length,const char **return_parse_end,int require_null_terminated);
+/* Render through the context's scratch buffer. The result is allocated with ctx->hooks.malloc_fn; release it with ctx->hooks.free_fn. */
+extern char  *cJSON_PrintWithContext(cJSON_Context *ctx,cJSON *item,int fmt);
+/* Delete a tree parsed with cJSON_ParseWithContext. Items added later with cJSON_Create* come from the global hooks and must not be mixed in. */
+extern void   cJSON_DeleteWithContext(cJSON_Context *ctx,cJSON *c);
+
+/* Returns the number of items in an array (or object). The compact layout keeps no count and walks the chain. */
 extern int	  cJSON_GetArraySize(cJSON *array);
 /* Retrieve item number "item" from array "array". Returns NULL if unsuccessful. */
 extern cJSON *cJSON_GetArrayItem(cJSON *array,int item);
 /* Get item "string" from object. Case insensitive. */
 extern cJSON *cJSON_GetObjectItem(cJSON *object,const char *string);
+/* Get item "string" from object. Case sensitive, skips the tolower work. */
+extern cJSON *cJSON_GetObjectItemCaseSensitive(cJSON *object,const char *string);
+/* Arrays/objects with at least threshold items get an index (a contiguous view of the items plus a hash of the keys)
+the first time they are searched by position or key, making later lookups O(1). The index is kept on append and
+dropped on any other modification. 0 (the default) disables indexing. The compact layout (CJSON_COMPACT) has no index:
+there this call does nothing and every lookup walks the chain. */
+extern void cJSON_SetIndexThreshold(int threshold);
 
 /* For analysing failed parses. This returns a pointer to the parse error. You'll probably need to look a few chars back to make sense of it. Defined when cJSON_Parse() returns 0. 0 when cJSON_Parse() succeeds. */
 extern const char *cJSON_GetErrorPtr(void);
@@ -125,6 +206,22 @@ extern cJSON *cJSON_Duplicate(cJSON *item,int recurse);
 need to be released. With recurse!=0, it will duplicate any children connected to the item.
 The item->next and ->prev pointers are always zero on return from Duplicate. */
 
+/* Copy-on-write duplicate: the copy shares item's children and valuestring, so it costs one node however big item is.
+   Shared children are copied a level at a time, only when a cJSON call changes them: Add/Insert/Replace/Detach/Delete
+   on either tree copy that container's item chain (not the grandchildren), leaving the other tree as it was.
+   Before writing fields by hand (valueint, valuedouble, ...), reach the item through the ForWrite getters, which unshare
+   every container on the way; items found with plain GetArrayItem/GetObjectItem may belong to both trees.
+   Both trees are released with cJSON_Delete as usual, in any order. Sharing counts, and the indexes lookups build, are
+   installed atomically under GCC/Clang, so copies of one template can be made, searched and changed from several
+   threads; the template itself must not change meanwhile.
+   The compact layout (CJSON_COMPACT) cannot share: there this is cJSON_Duplicate(item,1), a full deep copy, cJSON_Unshare
+   does nothing and the ForWrite getters are the plain ones. */
+extern cJSON *cJSON_DuplicateShared(cJSON *item);
+/* Give item its own copy of its item chain and valuestring if they are shared. Returns item, or 0 when out of memory. */
+extern cJSON *cJSON_Unshare(cJSON *item);
+extern cJSON *cJSON_GetArrayItemForWrite(cJSON *array,int item);
+extern cJSON *cJSON_GetObjectItemForWrite(cJSON *object,const char *string);
+
 /* ParseWithOpts allows you to require (and check) that the JSON is null terminated, and to retrieve the pointer to the final byte parsed. */
 extern cJSON *cJSON_ParseWithOpts(const char *value,const char **return_parse_end,int require_null_terminated);
 
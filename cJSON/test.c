@@ -22,7 +22,12 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "cJSON.h"
+#if defined(__unix__)
+#include <sys/mman.h>
+#include <pthread.h>
+#endif
 
 /* Parse text to JSON, then render back to text, and print! */
 void doit(char *text)
@@ -133,6 +138,458 @@ void create_objects()
 
 }
 
+/* The tests below check themselves: a failed check is reported with its line and counted, and main returns the count. */
+static int failures=0;
+#define CHECK(cond) do {if (!(cond)) {failures++;printf("%s:%d: check failed: %s\n",__FILE__,__LINE__,#cond);}} while (0)
+
+/* Counting allocator, to see which calls touch the heap and that everything allocated is released. */
+static int allocations=0,live=0;
+static void *counting_malloc(size_t sz) {allocations++;live++;return malloc(sz);}
+static void counting_free(void *ptr) {if (ptr) live--;free(ptr);}
+
+/* An array of count small objects. */
+static cJSON *create_records(int count)
+{
+	cJSON *root=cJSON_CreateArray(),*fld;char name[32];int i;
+	for (i=0;i<count;i++)
+	{
+		cJSON_AddItemToArray(root,fld=cJSON_CreateObject());
+		sprintf(name,"record \"%d\"",i);
+		cJSON_AddNumberToObject(fld,"id",i);
+		cJSON_AddStringToObject(fld,"name",name);
+		cJSON_AddItemToObject(fld,"flags",cJSON_CreateIntArray(&i,1));
+	}
+	return root;
+}
+
+/* One print buffer reused across trees of growing size renders what cJSON_Print does and stops allocating once grown;
+   a buffer of exactly cJSON_PrintBufferNeeded bytes renders the same tree without growing, one byte less has to grow. */
+void test_print_buffer()
+{
+	cJSON_PrintBuffer pb,exact;cJSON_Hooks hooks={counting_malloc,free};cJSON *root=0;
+	char *expected;const char *out,*buffer;int count,fmt,needed;
+
+	cJSON_InitHooks(&hooks);
+	cJSON_InitPrintBuffer(&pb,0);
+	for (count=0;count<=3000;count+=count/2+1)
+	{
+		cJSON_Delete(root);root=create_records(count);
+		for (fmt=0;fmt<2;fmt++)
+		{
+			expected=fmt?cJSON_Print(root):cJSON_PrintUnformatted(root);
+			out=cJSON_PrintToBuffer(root,&pb,fmt);
+			CHECK(out && out==pb.buffer && !strcmp(out,expected));
+			needed=cJSON_PrintBufferNeeded(&pb);
+			CHECK(needed>=(int)strlen(expected)+1 && needed<=pb.length);
+
+			cJSON_InitPrintBuffer(&exact,needed);buffer=exact.buffer;allocations=0;
+			out=cJSON_PrintToBuffer(root,&exact,fmt);
+			CHECK(out==buffer && allocations==0 && exact.length==needed && !strcmp(out,expected));
+			CHECK(cJSON_PrintBufferNeeded(&exact)==needed);
+			cJSON_FreePrintBuffer(&exact);
+
+			cJSON_InitPrintBuffer(&exact,needed-1);allocations=0;
+			out=cJSON_PrintToBuffer(root,&exact,fmt);
+			CHECK(out && allocations==1 && exact.length>=needed && !strcmp(out,expected));
+			cJSON_FreePrintBuffer(&exact);
+			free(expected);
+		}
+	}
+	allocations=0;
+	out=cJSON_PrintToBuffer(root,&pb,1);
+	CHECK(out && allocations==0);
+
+	/* A released buffer is reallocated at the last needed size on the next render. */
+	needed=cJSON_PrintBufferNeeded(&pb);
+	cJSON_FreePrintBuffer(&pb);allocations=0;
+	out=cJSON_PrintToBuffer(root,&pb,1);
+	CHECK(out && allocations==1 && pb.length==needed);
+	cJSON_FreePrintBuffer(&pb);
+	cJSON_Delete(root);
+	cJSON_InitHooks(0);
+	printf("test_print_buffer: done\n");
+}
+
+/* Parse ndjson with cJSON_ParseBatch on the given number of threads and compare every record with a serial cJSON_Parse
+   of its line; blank lines are not records, and a malformed line is a 0 record, as is a line with a second value. */
+static void check_batch(const char *ndjson,int threads,int expected_count)
+{
+	cJSON **records,*serial;const char *p=ndjson,*eol;char *line,*a,*b;int count,i=0;
+	count=cJSON_ParseBatch(ndjson,threads,&records);
+	CHECK(count==expected_count && records);
+	for (;*p && i<count;p=*eol?eol+1:eol)
+	{
+		if (!(eol=strchr(p,'\n'))) eol=p+strlen(p);
+		if (strspn(p," \t\r")>=(size_t)(eol-p)) continue;
+		line=(char*)malloc(eol-p+1);memcpy(line,p,eol-p);line[eol-p]=0;
+		serial=cJSON_ParseWithOpts(line,0,1);
+		CHECK(!serial==!records[i]);
+		if (serial && records[i])
+		{
+			a=cJSON_PrintUnformatted(serial);b=cJSON_PrintUnformatted(records[i]);
+			CHECK(!strcmp(a,b));
+			free(a);free(b);
+		}
+		cJSON_Delete(serial);free(line);i++;
+	}
+	CHECK(i==count);
+	cJSON_DeleteBatch(records,count);
+}
+
+void test_parse_batch()
+{
+	static const int threads[]={1,2,4,100,0};
+	char *big=(char*)malloc(1000*64),*p=big;int i,t;
+
+	for (i=0;i<1000;i++)	/* more records than a block per thread, with blank and malformed lines mixed in */
+	{
+		if (i%97==0) p+=sprintf(p,"\n  \t\r\n");
+		if (i%131==0) p+=sprintf(p,"{\"id\":%d,}\n",i);
+		else if (i%151==0) p+=sprintf(p,"[%d] [%d]\n",i,i);
+		else p+=sprintf(p,"{\"id\":%d,\"name\":\"r\\n%d\",\"tags\":[%d,true,null]}\r\n",i,i,i);
+	}
+	for (t=0;t<5;t++)
+	{
+		check_batch("",threads[t],0);
+		check_batch("\n\n  \r\n\t",threads[t],0);
+		check_batch("[1]",threads[t],1);
+		check_batch("\n{\"a\":1}\n\n  \n[2,3]\n",threads[t],2);	/* blank lines around and between records */
+		check_batch("{\"a\":1}\n{\"a\":\n2}\n\"x\"",threads[t],4);	/* a value split over lines is two bad records */
+		check_batch(big,threads[t],1000);
+	}
+	free(big);
+	printf("test_parse_batch: done\n");
+}
+
+/* Scalar cJSON_Minify, the reference for the vector kernels: drop whitespace and comments, copy strings verbatim. */
+static void minify_reference(char *json)
+{
+	char *into=json;
+	while (*json)
+	{
+		if (*json==' ' || *json=='\t' || *json=='\r' || *json=='\n') json++;
+		else if (*json=='/' && json[1]=='/') while (*json && *json!='\n') json++;
+		else if (*json=='/' && json[1]=='*') {json+=2;while (*json && !(*json=='*' && json[1]=='/')) json++;if (*json) json+=2;}
+		else if (*json=='\"')
+		{
+			*into++=*json++;
+			while (*json && *json!='\"') {if (*json=='\\' && json[1]) *into++=*json++;*into++=*json++;}
+			if (*json=='\"') *into++=*json++;
+		}
+		else *into++=*json++;
+	}
+	*into=0;
+}
+
+/* Random text made of runs of whitespace, tokens, strings with escapes and comments, so that every kind of run
+   straddles the 16 and 32 byte block boundaries somewhere. */
+static unsigned test_seed=1;
+static int test_rand(int n) {test_seed=test_seed*1103515245u+12345u;return (int)((test_seed>>16)%(unsigned)n);}
+static int random_minify_input(char *out,int limit)
+{
+	static const char *pieces[]={" ","\t\n  ","\r\n","                                        ","{","}","[1,2]",":",",","true",
+		"-12.5e3","\"","\"key\"","\"a\\\"b\"","\\","\"\\\\\"","\"long string without any escapes at all, 40\"",
+		"// line comment\n","//","/* block */","/*","*/","/","*","\"/* not a comment */\"","\"// nor this\""};
+	int len=0,n;const char *piece;
+	while (len<limit)
+	{
+		piece=pieces[test_rand(sizeof(pieces)/sizeof(*pieces))];n=(int)strlen(piece);
+		if (len+n>limit) break;
+		memcpy(out+len,piece,n);len+=n;
+	}
+	out[len]=0;
+	return len;
+}
+
+/* A page of memory followed by one that cannot be read, so a read past the end of text placed at the end of the page
+   faults instead of going unnoticed. Without mmap the next page is only ordinary memory. */
+enum {PAGE=4096};
+static char *guarded_page(void)
+{
+#if defined(__unix__)
+	char *page=(char*)mmap(0,2*PAGE,PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_ANONYMOUS,-1,0);
+	if (page==(char*)MAP_FAILED) return 0;
+	mprotect(page+PAGE,PAGE,PROT_NONE);
+	return page;
+#else
+	return (char*)malloc(2*PAGE);
+#endif
+}
+static void release_page(char *page)
+{
+#if defined(__unix__)
+	munmap(page,2*PAGE);
+#else
+	free(page);
+#endif
+}
+
+/* cJSON_Minify against the scalar reference, with each input ending at every offset just before an unreadable page
+   (where a block load that crossed it would fault) and starting at every offset into a block. */
+void test_minify()
+{
+	enum {SHIFTS=40};
+	char input[1024],expected[1024],*page=guarded_page(),*at;int round,len,shift;
+	if (!page) {printf("test_minify: no guarded page\n");failures++;return;}
+	for (round=0;round<3000;round++)
+	{
+		len=random_minify_input(input,test_rand(round<100?64:sizeof(input)-1));
+		memcpy(expected,input,len+1);minify_reference(expected);
+		for (shift=0;shift<SHIFTS;shift++)
+		{
+			at=page+PAGE-1-len-shift;	/* the terminator at the last byte of the page, then shift bytes before it */
+			memcpy(at,input,len+1);cJSON_Minify(at);
+			CHECK(!strcmp(at,expected));
+			at=page+shift;
+			memcpy(at,input,len+1);cJSON_Minify(at);
+			CHECK(!strcmp(at,expected));
+		}
+	}
+	release_page(page);
+	printf("test_minify: done\n");
+}
+
+/* Render item unformatted and compare with text. */
+static int prints_as(cJSON *item,const char *text)
+{
+	char *out=cJSON_PrintUnformatted(item);int same=out && !strcmp(out,text);
+	if (!same) printf("printed %s, expected %s\n",out?out:"(null)",text);
+	counting_free(out);	/* out comes from cJSON_malloc, which may be counting_malloc */
+	return same;
+}
+
+/* Parse length bytes of text placed at the very end of a guarded page, so nothing follows it, not even a terminator. */
+static cJSON *parse_at_page_end(char *page,const char *text,size_t length,const char **end,int require_null_terminated)
+{
+	char *at=page+PAGE-length;
+	memcpy(at,text,length);
+	return cJSON_ParseWithLengthOpts(at,length,end,require_null_terminated);
+}
+
+/* Length-delimited parsing: text that is not NUL-terminated, lengths that cut a token, and bytes past the length. */
+void test_parse_with_length()
+{
+	static const char *whole[]={"[1,2,{\"a\":\"b\\u00e9\\n\"}]","{\"k\":[true,false,null]}","-12.5e+3","12345","true","null","\"\\ud83d\\ude00\"","[]"};
+	static const char *cut[]={"[1,2","{\"a\"","{\"a\":","\"abc","\"ab\\","\"\\u00e","\"\\ud83d\\u","tru","nul","[1,","{\"a\":1,","[-","[1.5e"};
+	char *page=guarded_page(),text[64];const char *end;cJSON *c,*expected;size_t i,n;
+	if (!page) {printf("test_parse_with_length: no guarded page\n");failures++;return;}
+
+	for (i=0;i<sizeof(whole)/sizeof(*whole);i++)
+	{
+		n=strlen(whole[i]);
+		expected=cJSON_Parse(whole[i]);
+		c=parse_at_page_end(page,whole[i],n,&end,1);
+		CHECK(c && expected && end==page+PAGE);
+		if (c && expected)
+		{
+			char *out=cJSON_PrintUnformatted(expected);
+			CHECK(prints_as(c,out));
+			free(out);
+		}
+		cJSON_Delete(c);cJSON_Delete(expected);
+	}
+	for (i=0;i<sizeof(cut)/sizeof(*cut);i++)	/* a token cut by the length is an error, not a read past it */
+	{
+		c=parse_at_page_end(page,cut[i],strlen(cut[i]),0,0);
+		CHECK(!c && cJSON_GetErrorPtr());
+		cJSON_Delete(c);
+	}
+	c=parse_at_page_end(page,"12345",3,0,1);	/* a number cut short is still a number */
+	CHECK(c && c->valueint==123);
+	cJSON_Delete(c);
+	c=parse_at_page_end(page,"1.5e",4,0,1);	/* and cJSON reads a dangling exponent as none, as it does before a terminator */
+	CHECK(c && c->valuedouble==1.5);
+	cJSON_Delete(c);
+
+	/* Bytes past the length are never looked at, whatever they are. */
+	strcpy(text,"[1,2] x");
+	c=cJSON_ParseWithLengthOpts(text,5,&end,1);
+	CHECK(c && end==text+5 && prints_as(c,"[1,2]"));
+	cJSON_Delete(c);
+	c=cJSON_ParseWithLengthOpts(text,6,&end,1);	/* whitespace up to the end is fine */
+	CHECK(c && end==text+6);
+	cJSON_Delete(c);
+	c=cJSON_ParseWithLengthOpts(text,7,&end,1);	/* but not another token */
+	CHECK(!c);
+	c=cJSON_ParseWithLengthOpts(text,7,&end,0);
+	CHECK(c && end==text+5);
+	cJSON_Delete(c);
+	memcpy(text,"[1]\0[2]",8);		/* a NUL before the length ends the text too */
+	c=cJSON_ParseWithLengthOpts(text,7,&end,1);
+	CHECK(c && end==text+3 && prints_as(c,"[1]"));
+	cJSON_Delete(c);
+	release_page(page);
+	printf("test_parse_with_length: done\n");
+}
+
+#ifndef CJSON_COMPACT
+#if defined(__unix__)
+/* Each thread makes copies of one template, searches and changes them, and checks the template shows through. */
+static void *duplicate_shared_worker(void *arg)
+{
+	cJSON *template=(cJSON*)arg,*copy,*item;int i,ok=1;
+	for (i=0;i<200;i++)
+	{
+		copy=cJSON_DuplicateShared(template);
+		ok&=cJSON_GetObjectItem(cJSON_GetObjectItem(copy,"shared"),"k5")->valueint==5;	/* indexes a container of both trees */
+		ok&=cJSON_GetArrayItem(cJSON_GetObjectItem(copy,"list"),6)->valueint==6;
+		item=cJSON_GetObjectItemForWrite(cJSON_GetObjectItemForWrite(copy,"shared"),"k3");
+		item->valueint=i;item->valuedouble=i;
+		ok&=cJSON_GetObjectItemCaseSensitive(cJSON_GetObjectItem(copy,"shared"),"k3")->valueint==i;
+		ok&=cJSON_GetObjectItem(cJSON_GetObjectItem(template,"shared"),"k3")->valueint==3;
+		cJSON_Delete(copy);
+	}
+	return ok?arg:0;
+}
+#endif
+
+/* Copy-on-write duplicates: writes through either tree leave the other as it was, sharing ends once only one holder is
+   left, and the trees release everything in any order, here counted by the allocator hooks. */
+void test_duplicate_shared()
+{
+	const char *text="{\"a\":1,\"obj\":{\"name\":\"x\",\"list\":[1,2,3]},\"s\":\"string\"}";
+	cJSON_Hooks hooks={counting_malloc,counting_free};cJSON *template,*copy,*copy2,*item,*child;
+
+	cJSON_InitHooks(&hooks);live=0;
+	cJSON_SetIndexThreshold(2);
+	template=cJSON_Parse(text);
+	copy=cJSON_DuplicateShared(template);
+	copy2=cJSON_DuplicateShared(template);
+	CHECK(copy->child==template->child && copy2->child==template->child);
+	CHECK(template->share && copy->share==template->share && copy2->share==template->share);
+	CHECK(cJSON_GetObjectItem(cJSON_GetObjectItem(copy,"obj"),"list")==cJSON_GetObjectItem(cJSON_GetObjectItem(template,"obj"),"list"));
+
+	/* ForWrite unshares each container on the way, and only those. */
+	item=cJSON_GetObjectItemForWrite(cJSON_GetObjectItemForWrite(copy,"obj"),"list");
+	CHECK(item!=cJSON_GetObjectItem(cJSON_GetObjectItem(template,"obj"),"list"));
+	CHECK(item->child==cJSON_GetObjectItem(cJSON_GetObjectItem(template,"obj"),"list")->child);
+	cJSON_GetArrayItemForWrite(item,1)->valueint=20;cJSON_GetArrayItem(item,1)->valuedouble=20;
+	cJSON_AddItemToArray(item,cJSON_CreateNumber(4));
+	cJSON_GetObjectItemForWrite(copy,"a")->valuedouble=10;
+	CHECK(prints_as(copy,"{\"a\":10,\"obj\":{\"name\":\"x\",\"list\":[1,20,3,4]},\"s\":\"string\"}"));
+	CHECK(prints_as(template,text) && prints_as(copy2,text));
+	CHECK(cJSON_GetObjectItem(copy,"s")->valuestring==cJSON_GetObjectItem(template,"s")->valuestring);
+
+	/* Structural changes on one copy. */
+	cJSON_DeleteItemFromObject(copy2,"a");
+	cJSON_ReplaceItemInObject(copy2,"s",cJSON_CreateString("other"));
+	cJSON_DeleteItemFromArray(cJSON_GetObjectItemForWrite(cJSON_GetObjectItemForWrite(copy2,"obj"),"list"),0);
+	CHECK(prints_as(copy2,"{\"obj\":{\"name\":\"x\",\"list\":[2,3]},\"s\":\"other\"}"));
+	CHECK(prints_as(template,text));
+	CHECK(!copy2->share);
+	cJSON_Delete(copy2);
+
+	/* Unshare by the last holder takes the body over without copying. */
+	cJSON_Delete(copy);
+	CHECK(template->share);
+	child=template->child;
+	CHECK(cJSON_Unshare(template)==template && !template->share && template->child==child);
+	CHECK(prints_as(template,text));
+
+	/* Copies of copies, released template first. */
+	copy=cJSON_DuplicateShared(template);
+	copy2=cJSON_DuplicateShared(copy);
+	cJSON_Delete(template);
+	CHECK(prints_as(copy2,text));
+	cJSON_Delete(copy2);
+	CHECK(prints_as(copy,text));
+	cJSON_Delete(copy);
+	CHECK(live==0);
+
+	/* A string value is shared and unshared like a body. */
+	template=cJSON_CreateString("value");
+	copy=cJSON_DuplicateShared(template);
+	CHECK(copy->valuestring==template->valuestring);
+	CHECK(cJSON_Unshare(copy) && copy->valuestring!=template->valuestring && !strcmp(copy->valuestring,"value"));
+	cJSON_Delete(template);cJSON_Delete(copy);
+	CHECK(live==0);
+	cJSON_InitHooks(0);
+
+#if defined(__unix__)
+	{
+		pthread_t threads[4];void *result;int i,started=0;char key[16];
+		template=cJSON_CreateObject();
+		cJSON_AddItemToObject(template,"shared",item=cJSON_CreateObject());
+		for (i=0;i<16;i++) {sprintf(key,"k%d",i);cJSON_AddNumberToObject(item,key,i);}
+		cJSON_AddItemToObject(template,"list",item=cJSON_CreateArray());
+		for (i=0;i<16;i++) cJSON_AddItemToArray(item,cJSON_CreateNumber(i));
+		for (i=0;i<4;i++) if (!pthread_create(&threads[started],0,duplicate_shared_worker,template)) started++;
+		for (i=0;i<started;i++) {pthread_join(threads[i],&result);CHECK(result==template);}
+		cJSON_Delete(template);
+	}
+#endif
+	cJSON_SetIndexThreshold(0);
+	printf("test_duplicate_shared: done\n");
+}
+#endif
+
+/* Keys and string values either side of the compact layout's inline limit (CJSON_INLINE_STRING), through parse, lookup,
+   print, duplicate and change; in the default layout the same calls simply use separate strings. */
+void test_inline_strings()
+{
+	cJSON_Hooks hooks={counting_malloc,counting_free};cJSON *root,*copy,*item;
+	char text[1024],keys[24][32],values[24][40],*p=text;int n,i;
+
+	cJSON_InitHooks(&hooks);live=0;
+	*p++='{';
+	for (n=1;n<24;n++)	/* lengths 1..23, escapes counted as their two source bytes */
+	{
+		for (i=0;i<n;i++) keys[n][i]=(char)('a'+(n+i)%26);
+		keys[n][n]=0;
+		for (i=0;i<n;i++) values[n][i]=(char)('A'+i%26);
+		if (n%3==0) values[n][n/2]='\"';
+		if (n%4==0) values[n][n/3]='\n';
+		values[n][n]=0;
+		p+=sprintf(p,"%s\"%s\":\"",n>1?",":"",keys[n]);
+		for (i=0;i<n;i++) p+=sprintf(p,values[n][i]=='\"'?"\\\"":values[n][i]=='\n'?"\\n":"%c",values[n][i]);
+		*p++='\"';
+	}
+	*p++='}';*p=0;
+
+	root=cJSON_Parse(text);
+	CHECK(root && prints_as(root,text));
+	for (n=1;n<24;n++)
+	{
+		item=cJSON_GetObjectItemCaseSensitive(root,keys[n]);
+		CHECK(item && (item->type&255)==cJSON_String && !strcmp(item->valuestring,values[n]) && !strcmp(item->string,keys[n]));
+	}
+	copy=cJSON_Duplicate(root,1);
+	CHECK(prints_as(copy,text));
+	cJSON_Delete(copy);
+	copy=cJSON_DuplicateShared(root);
+	CHECK(prints_as(copy,text));
+#ifdef CJSON_COMPACT
+	CHECK(copy->child!=root->child);	/* no sharing: a deep copy */
+#endif
+
+	/* Replace, delete and move items whose key and value live in the node. */
+	cJSON_ReplaceItemInObject(copy,keys[5],cJSON_CreateString("replaced"));
+	cJSON_DeleteItemFromObject(copy,keys[6]);
+	item=cJSON_DetachItemFromObject(copy,keys[7]);
+	CHECK(item && !strcmp(item->valuestring,values[7]));
+	cJSON_AddItemToObject(copy,"moved with a key past the inline limit",item);
+	item=cJSON_DetachItemFromObject(copy,keys[20]);
+	cJSON_AddItemToObject(copy,"m",item);
+	CHECK(!strcmp(cJSON_GetObjectItem(copy,keys[5])->valuestring,"replaced") && !cJSON_GetObjectItem(copy,keys[6]));
+	CHECK(!strcmp(cJSON_GetObjectItem(copy,"moved with a key past the inline limit")->valuestring,values[7]));
+	CHECK(!strcmp(cJSON_GetObjectItem(copy,"m")->valuestring,values[20]));
+	CHECK(prints_as(cJSON_GetObjectItem(copy,keys[8]),"\"AB\\nDEFGH\""));
+	cJSON_Delete(copy);
+	cJSON_Delete(root);
+
+	/* Escapes in keys either side of the limit. */
+	root=cJSON_Parse("{\"\\u00e9\\\"\":1,\"a long key with \\\"quotes\\\" and \\u00e9\":2}");
+	CHECK(root && cJSON_GetObjectItemCaseSensitive(root,"\xc3\xa9\"")->valueint==1);
+	CHECK(root && cJSON_GetObjectItemCaseSensitive(root,"a long key with \"quotes\" and \xc3\xa9")->valueint==2);
+	cJSON_Delete(root);
+
+	/* A text cut inside a short value fails cleanly. */
+	CHECK(!cJSON_ParseWithLength("{\"ab\":\"cd\"}",8) && !cJSON_ParseWithLength("{\"ab\":\"cd",10));
+	CHECK(live==0);
+	cJSON_InitHooks(0);
+	printf("test_inline_strings: done\n");
+}
+
 int main (int argc, const char * argv[]) {
 	/* a bunch of json: */
 	char text1[]="{\n\"name\": \"Jack (\\\"Bee\\\") Nimble\", \n\"format\": {\"type\":       \"rect\", \n\"width\":      1920, \n\"height\":     1080, \n\"interlace\":  false,\"frame rate\": 24\n}\n}";	
@@ -157,6 +614,16 @@ int main (int argc, const char * argv[]) {
 
 	/* Now some samplecode for building objects concisely: */
 	create_objects();
+
+	/* And the self-checking tests: */
+	test_print_buffer();
+	test_parse_batch();
+	test_minify();
+	test_inline_strings();
+	test_parse_with_length();
+#ifndef CJSON_COMPACT
+	test_duplicate_shared();
+#endif
 	
-	return 0;
+	return failures;
 }
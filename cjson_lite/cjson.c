@@ -11,36 +11,188 @@
 
 #include <stdio.h>
 #include <string.h>
-#include <math.h>
 #include <stdlib.h>
-#include <float.h>      // DBL_EPSILON
 #include <limits.h>     // INT_MAX INT_MIN
 #include <ctype.h>
+#include <locale.h>     // localeconv
+#include <fcntl.h>      // open
+#include <unistd.h>     // close
+#include <sys/mman.h>   // mmap madvise munmap
+#include <sys/stat.h>   // fstat
 #include "cjson.h"
 
-// 定义 printbuffer 格式：地址，长度，偏移
-typedef struct {char *buffer; int length; int offset; } printbuffer;
+#if defined(__SSE2__)
+#include <emmintrin.h>  // 字符串扫描使用 SSE2 每次处理 16 字节
+#endif
 
-// 错误指针 error_point，解析失败时，指向发生错误的地址
+// 错误指针 error_point，不带 context 的解析失败时，指向发生错误的地址
 static const char* ep;
 
-static void* (*cJSON_malloc)(size_t sz) = malloc;
-static void  (*cJSON_free)(void* ptr) = free;
-
-// 解析 json 字符串，并赋值给 item 节点，返回后续字符串的指针
-static const char* parse_value(cJSON *item, const char *value);
-
-// 输出 json 字符串
+// 全局分配函数，不带 context 的接口和 cJSON_Create* 使用，可由 cJSON_InitHooks 替换
+static cJSON_Hooks global_hooks = { malloc, free };
+#define cJSON_malloc(sz)    global_hooks.malloc_fn(sz)
+#define cJSON_free(ptr)     global_hooks.free_fn(ptr)
+
+// arena 默认块大小，与 rapidjson MemoryPoolAllocator 的 kDefaultChunkCapacity 一致
+#define CJSON_ARENA_CHUNK_CAPACITY  (64 * 1024)
+// arena 中分配的地址按 8 字节对齐，保证 cJSON 中的 double 和指针成员对齐
+#define CJSON_ARENA_ALIGN(x)        (((x) + 7u) & ~(size_t)7u)
+// 从 arena 中解析出的节点所带的标志位
+#define CJSON_ARENA_FLAGS           (cJSON_IsArena | cJSON_StringIsConst | cJSON_ValueIsConst)
+// 原地解析出的节点所带的标志位，字符串指向调用者的 buffer
+#define CJSON_INSITU_FLAGS          (cJSON_StringIsConst | cJSON_ValueIsConst)
+
+// cJSON_ParseFile 原地解析出的根节点，字符串指向文件的私有映射，映射随根节点一起解除
+typedef struct {
+    cJSON   item;
+    void    *map;
+    size_t  size;
+} mapped_root;
+
+// 哈希索引的槽位：key 的哈希值和对应的成员节点
+typedef struct { unsigned hash; cJSON *item; } index_slot;
+
+// 容器节点的辅助索引，items、slots 和 exact 数组紧跟在结构体之后
+typedef struct cJSON_Index {
+    int         capacity;   // 数组容量，为 2 的幂，成员数不超过其一半
+    int         count;      // 已加入索引的成员数
+    cJSON       **items;    // 按下标排列的成员，即连续的数组视图
+    index_slot  *slots;     // 按忽略大小写的 key 哈希的线性探测表，数组为 NULL
+    index_slot  *exact;     // 按区分大小写的 key 哈希的线性探测表，数组为 NULL
+} cJSON_Index;
+
+// 数组或对象的成员个数达到该值时建立索引，0 表示不建立
+static int index_threshold = 0;
+
+// 解析时允许的最大嵌套深度
+static int nesting_limit = CJSON_NESTING_LIMIT;
+
+// 显式栈的内置容量，嵌套不超过该深度时不申请内存
+#define STACK_LOCAL_SIZE    32
+
+// 遍历 json 树时保存未结束的数组和对象，代替函数递归
+typedef struct {
+    cJSON   **items;
+    int     size;
+    const cJSON_Hooks *hooks;   // 扩容时使用的分配函数
+    cJSON   *local[STACK_LOCAL_SIZE];
+} node_stack;
+
+// 解析器的状态栈，每层保存 (成员个数 << 1) | 是否为对象
+typedef struct {
+    int     *items;
+    int     size;
+    const cJSON_Hooks *hooks;
+    int     local[STACK_LOCAL_SIZE];
+} level_stack;
+
+// 解析过程中的上下文，解析用到的所有可变状态都在这里，不读写全局变量
+typedef struct {
+    const cJSON_Hooks *hooks;   // 节点、字符串和临时空间的分配函数
+    cJSON_Arena *arena;     // 非空时，节点和字符串都从 arena 中分配
+    char        *scratch;   // 字符串解码缓冲区，在整个解析过程中复用
+    size_t      scratch_size;
+    int         insitu;     // 非 0 时在输入 buffer 中原地解码字符串，不再分配
+    int         nesting_limit;
+    const char  *error;     // 解析失败的位置
+    const char  *end;       // 按长度解析时输入的结尾，不读取其后的字节；NULL 时输入以 '\0' 结束
+    level_stack levels;     // 尚未结束的数组和对象
+} parse_context;
+
+// 解析器展开到每个调用处，生成树时 handler 为常量，回调可以直接调用甚至内联
+#if defined(__GNUC__)
+#define PARSE_INLINE        static inline __attribute__((always_inline))
+#else
+#define PARSE_INLINE        static inline
+#endif
+
+// 解析 json 字符串，每识别出一个元素调用一次 handler 中的回调，返回后续字符串的指针
+PARSE_INLINE const char* parse_value(const char *value, const cJSON_Handler *h, void *ud, parse_context *ctx);
+
+// 释放 json 树，节点和字符串交给 hooks 的释放函数
+static void delete_tree(cJSON *c, const cJSON_Hooks *hooks);
+
+// 输出 json 字符串，返回输出的长度（不含结束符）
 // @param item:  json 树结构的根节点
-// @param depth: 节点的深度
 // @param fmt:   是否带格式输出（缩进换行）
-// @param p:     是否输出到指定的 buffer，这里为简便，忽略此参数
-static char* print_value(cJSON *item, int depth, int fmt, printbuffer *p);
+// @param out:   为 NULL 时只计算长度，否则写入 out，调用者保证空间足够
+// @param hooks: 显式栈扩容时使用的分配函数
+static size_t print_value(cJSON *item, int fmt, char *out, const cJSON_Hooks *hooks);
+
+static void stack_init(node_stack *s, const cJSON_Hooks *hooks)
+{
+    s->items = s->local;
+    s->size = STACK_LOCAL_SIZE;
+    s->hooks = hooks;
+}
+
+static void stack_free(node_stack *s)
+{
+    if (s->items != s->local) s->hooks->free_fn(s->items);
+    stack_init(s, s->hooks);
+}
+
+// 将 item 放在栈的 depth 处，空间不足时扩容为两倍，申请失败返回 0
+static int stack_push(node_stack *s, int depth, cJSON *item)
+{
+    if (depth >= s->size) {
+        cJSON **items = (cJSON**)s->hooks->malloc_fn(s->size * 2 * sizeof(cJSON*));
+        if (!items) return 0;
+        memcpy(items, s->items, s->size * sizeof(cJSON*));
+        if (s->items != s->local) s->hooks->free_fn(s->items);
+        s->items = items;
+        s->size *= 2;
+    }
+    s->items[depth] = item;
+    return 1;
+}
+
+static void levels_init(level_stack *s, const cJSON_Hooks *hooks)
+{
+    s->items = s->local;
+    s->size = STACK_LOCAL_SIZE;
+    s->hooks = hooks;
+}
+
+static void levels_free(level_stack *s)
+{
+    if (s->items != s->local) s->hooks->free_fn(s->items);
+    levels_init(s, s->hooks);
+}
+
+// 将 level 放在栈的 depth 处，空间不足时扩容为两倍，申请失败返回 0
+static int levels_push(level_stack *s, int depth, int level)
+{
+    if (depth >= s->size) {
+        int *items = (int*)s->hooks->malloc_fn(s->size * 2 * sizeof(int));
+        if (!items) return 0;
+        memcpy(items, s->items, s->size * sizeof(int));
+        if (s->items != s->local) s->hooks->free_fn(s->items);
+        s->items = items;
+        s->size *= 2;
+    }
+    s->items[depth] = level;
+    return 1;
+}
+
+// 读取 p 处的字符，到达 ctx->end 时与结束符一样返回 0。解析只会逐字节前进，或先用 parse_have
+// 确认剩余长度再跳过多个字节，不会越过 ctx->end，所以判断是否相等即可，不按长度解析时总是不等
+static inline char parse_peek(const parse_context *ctx, const char *p)
+{
+    return p != ctx->end ? *p : 0;
+}
+
+// p 之后是否还有 n 字节可以直接读取；不按长度解析时由结束符保证不越界
+static inline int parse_have(const parse_context *ctx, const char *p, size_t n)
+{
+    return !ctx->end || (size_t)(ctx->end - p) >= n;
+}
 
 // 跳过非打印字符（回车换行符、结束符）和空格符 (32)
-static const char* skip(const char *in)
+static const char* skip(const char *in, const parse_context *ctx)
 {
-    while (in && *in && (unsigned char)*in <= 32) in++;
+    char c;
+    while (in && (c = parse_peek(ctx, in)) && (unsigned char)c <= 32) in++;
     return in;
 }
 
@@ -53,38 +205,48 @@ static int pow2gt(int x)
     return x + 1;
 }
 
-// 确认 buffer 中是否有 needed 空间，若没有，则申请新的空间
-static char* ensure(printbuffer *p, int needed)
+// 生成一个 cJSON 节点对象，并置0
+static cJSON* cJSON_New_Item(void)
 {
-    char *newbuffer;
-    int newsize;
-    if (!p || !p->buffer) return NULL;
-    needed += p->offset;
-    if (needed <= p->length) return p->buffer + p->offset;
+    cJSON *node = cJSON_malloc(sizeof(cJSON));
+    if (node) memset(node, 0, sizeof(cJSON));
+    return node;
+}
+
+// 从 arena 中分配 size 字节，当前块空间不足时用 hooks 申请新块，块中记下对应的释放函数
+static void* arena_alloc(cJSON_Arena *arena, const cJSON_Hooks *hooks, size_t size)
+{
+    cJSON_ArenaChunk *chunk = arena->head;
+    size_t header = CJSON_ARENA_ALIGN(sizeof(cJSON_ArenaChunk));
+    void *buffer;
+
+    size = CJSON_ARENA_ALIGN(size);
+    if (!chunk || chunk->size + size > chunk->capacity) {
+        size_t capacity = arena->chunk_capacity > size ? arena->chunk_capacity : size;
+        chunk = (cJSON_ArenaChunk*)hooks->malloc_fn(header + capacity);
+        if (!chunk) return NULL;
+        chunk->free_fn = hooks->free_fn;
+        chunk->capacity = capacity;
+        chunk->size = 0;
+        chunk->next = arena->head;
+        arena->head = chunk;
+    }
 
-    newsize = pow2gt(needed);
-    newbuffer = (char*)cJSON_malloc(newsize);
-    if (!newbuffer) { cJSON_free(p->buffer); p->length = 0; p->offset = 0; return NULL; }
-    memcpy(newbuffer, p->buffer, p->length);
-    cJSON_free(p->buffer);  // free old space
-    p->length = newsize;
-    p->buffer = newbuffer;
-    return newbuffer + p->offset;
+    buffer = (char*)chunk + header + chunk->size;
+    chunk->size += size;
+    return buffer;
 }
 
-// 更新 printbuffer 中的偏移
-static int update(printbuffer *p)
+// 解析时申请空间，有 arena 时从 arena 中分配
+static void* parse_alloc(parse_context *ctx, size_t size)
 {
-    char *str;
-    if (!p || !p->buffer) return 0;
-    str = p->buffer + p->offset;
-    return p->offset + strlen(str);
+    return ctx->arena ? arena_alloc(ctx->arena, ctx->hooks, size) : ctx->hooks->malloc_fn(size);
 }
 
-// 生成一个 cJSON 节点对象，并置0
-static cJSON* cJSON_New_Item(void)
+// 解析时生成一个 cJSON 节点对象，并置0
+static cJSON* parse_new_item(parse_context *ctx)
 {
-    cJSON *node = cJSON_malloc(sizeof(cJSON));
+    cJSON *node = (cJSON*)parse_alloc(ctx, sizeof(cJSON));
     if (node) memset(node, 0, sizeof(cJSON));
     return node;
 }
@@ -111,32 +273,238 @@ static int cJSON_strcasecmp(const char *s1, const char *s2)
     return tolower(*s1) - tolower(*s2);
 }
 
-// 解析 json 字符串，并返回根节点
-// @param value:                    json 字符串指针
-// @param return_parse_end:         输出参数，返回解析结尾的指针
-// @param require_null_terminated:  是否要求 json 字符串必须有结束符
-cJSON* cJSON_ParseWithOpts(const char *value, const char **return_parse_end, int require_null_terminated)
+// key 哈希（FNV-1a），fold 非 0 时忽略大小写，与 cJSON_strcasecmp 一致，否则与 strcmp 一致
+static unsigned index_hash(const char *str, int fold)
+{
+    unsigned h = 2166136261u;
+    if (fold) while (*str) h = (h ^ (unsigned)tolower((unsigned char)*str++)) * 16777619u;
+    else while (*str) h = (h ^ (unsigned char)*str++) * 16777619u;
+    return h;
+}
+
+// 线性探测插入，同一 key 的成员按加入顺序排列，查找时总是先找到第一个
+static void slot_insert(index_slot *slots, int capacity, unsigned hash, cJSON *item)
+{
+    int i = hash & (capacity - 1);
+    while (slots[i].item) i = (i + 1) & (capacity - 1);
+    slots[i].hash = hash;
+    slots[i].item = item;
+}
+
+// 将成员加入索引，调用方保证还有空位
+static void index_insert(cJSON_Index *index, cJSON *item)
+{
+    index->items[index->count++] = item;
+    if (!index->slots || !item->string) return;
+
+    slot_insert(index->slots, index->capacity, index_hash(item->string, 1), item);
+    slot_insert(index->exact, index->capacity, index_hash(item->string, 0), item);
+}
+
+// 在哈希表中查找 key，case_sensitive 决定使用哪张表和比较方式
+static cJSON* index_find(cJSON_Index *index, const char *string, int case_sensitive)
+{
+    index_slot *slots = case_sensitive ? index->exact : index->slots;
+    unsigned hash = index_hash(string, !case_sensitive);
+    int i = hash & (index->capacity - 1);
+    cJSON *c;
+
+    for (; slots[i].item; i = (i + 1) & (index->capacity - 1)) {
+        c = slots[i].item;
+        if (slots[i].hash == hash && !(case_sensitive ? strcmp(c->string, string) : cJSON_strcasecmp(c->string, string))) return c;
+    }
+    return NULL;
+}
+
+// 为数组或对象建立索引，有 arena 时从 arena 中分配
+// ctx 非空时（解析 arena 中的容器）从 ctx 的 arena 中分配，否则使用全局分配函数
+static cJSON_Index* index_build(cJSON *container, const parse_context *ctx)
+{
+    cJSON_Index *index;
+    cJSON *c;
+    int capacity, keyed = (container->type & 255) == cJSON_Object;
+    size_t size;
+
+    capacity = pow2gt(container->size * 2 < 8 ? 8 : container->size * 2);
+    size = sizeof(cJSON_Index) + capacity * (sizeof(cJSON*) + (keyed ? 2 * sizeof(index_slot) : 0));
+
+    index = (cJSON_Index*)(ctx ? arena_alloc(ctx->arena, ctx->hooks, size) : cJSON_malloc(size));
+    if (!index) return NULL;
+    index->capacity = capacity;
+    index->count = 0;
+    index->items = (cJSON**)(index + 1);
+    index->slots = keyed ? (index_slot*)(index->items + capacity) : NULL;
+    index->exact = keyed ? index->slots + capacity : NULL;
+    if (keyed) memset(index->slots, 0, 2 * capacity * sizeof(index_slot));
+
+    for (c = container->child; c; c = c->next) index_insert(index, c);
+    return index;
+}
+
+// 释放容器节点的索引，arena 中的索引随 arena 一起释放
+static void index_free(cJSON *container)
+{
+    if (!container->index) return;
+    if (!(container->type & cJSON_IsArena)) cJSON_free(container->index);
+    container->index = NULL;
+}
+
+// 返回容器节点的索引，成员个数达到阈值时按需建立
+static cJSON_Index* container_index(cJSON *container)
+{
+    if (container->index) return container->index;
+    // arena 中的节点只在解析时建立索引，按需建立的索引无法随 arena 释放
+    if (!index_threshold || container->size < index_threshold || (container->type & cJSON_IsArena)) return NULL;
+    return container->index = index_build(container, NULL);
+}
+
+// 追加成员后同步索引，将满时丢弃，下次访问时按新的大小重建
+static void index_append(cJSON *container, cJSON *item)
+{
+    cJSON_Index *index = container->index;
+    if (!index) return;
+    if ((index->count + 1) * 2 > index->capacity) { index_free(container); return; }
+    index_insert(index, item);
+}
+
+// 准备解析上下文：有 context 时使用其中的分配函数、嵌套深度和解码缓冲区，否则使用全局设置
+static void parse_begin(parse_context *ctx, cJSON_Context *context)
+{
+    memset(ctx, 0, sizeof(*ctx));
+    if (context) {
+        ctx->hooks = &context->hooks;
+        ctx->arena = context->arena;
+        ctx->scratch = context->scratch;
+        ctx->scratch_size = context->scratch_size;
+        ctx->nesting_limit = context->nesting_limit > 0 ? context->nesting_limit : CJSON_NESTING_LIMIT;
+    }
+    else {
+        ctx->hooks = &global_hooks;
+        ctx->nesting_limit = nesting_limit;
+    }
+}
+
+// 结束解析：context 保留解码缓冲区供下次复用并记录错误位置，否则释放缓冲区并设置全局错误指针
+static void parse_end(parse_context *ctx, cJSON_Context *context)
+{
+    if (context) {
+        context->scratch = ctx->scratch;
+        context->scratch_size = ctx->scratch_size;
+        context->error = ctx->error;
+    }
+    else {
+        if (ctx->scratch) ctx->hooks->free_fn(ctx->scratch);
+        ep = ctx->error;
+    }
+}
+
+// 解析一段 json，依次调用 handler 中的回调
+PARSE_INLINE const char* parse_run(const char *value, const cJSON_Handler *h, void *ud, parse_context *ctx)
+{
+    const char *end;
+
+    levels_init(&ctx->levels, ctx->hooks);
+    end = parse_value(skip(value, ctx), h, ud, ctx);
+    levels_free(&ctx->levels);
+    return end;
+}
+
+// 生成 cJSON 树的 handler 状态
+typedef struct {
+    parse_context *ctx;
+    cJSON       *root;      // 根节点，由 parse_root 预先分配
+    node_stack  stack;      // 尚未结束的数组和对象
+    int         depth;
+    int         flags;      // 新节点所带的标志位（arena 或原地解析）
+} tree_builder;
+
+static const cJSON_Handler tree_handler;
+
+// 解析 json 字符串，并返回根节点。树的生成只是 tree_handler 对解析事件的一种处理
+// arena 模式下解析失败时已分配的节点留在 arena 中，随 cJSON_ClearArena 释放
+static cJSON* parse_root(const char *value, const char **return_parse_end, int require_null_terminated,
+                         parse_context *ctx)
 {
     const char *end = NULL;
-    cJSON *c = cJSON_New_Item();
-    ep = 0;
+    tree_builder b;
+    cJSON *c = parse_new_item(ctx);
     if (!c) return NULL;
 
-    end = parse_value(c, skip(value));
-    if (!end) { cJSON_Delete(c); return NULL; }
+    b.ctx = ctx;
+    b.root = c;
+    b.depth = 0;
+    b.flags = ctx->arena ? CJSON_ARENA_FLAGS : ctx->insitu ? CJSON_INSITU_FLAGS : 0;
+    stack_init(&b.stack, ctx->hooks);
+    end = parse_run(value, &tree_handler, &b, ctx);
+    stack_free(&b.stack);
+    if (!end) { if (!ctx->arena) delete_tree(c, ctx->hooks); return NULL; }
 
     // 判断是否需要检查结束符和返回解析结尾指针
     if (require_null_terminated) {
-        end = skip(end);
-        if(*end) {  // 非结束符结尾
-            cJSON_Delete(c); ep = end; return NULL;
+        end = skip(end, ctx);
+        if (parse_peek(ctx, end)) {  // 非结束符结尾
+            if (!ctx->arena) delete_tree(c, ctx->hooks);
+            ctx->error = end; return NULL;
         }
     }
-    if (require_null_terminated) *return_parse_end = end;
+    if (return_parse_end) *return_parse_end = end;
+
+    return c;
+}
+
+// 解析 json 字符串，并返回根节点
+// @param value:                    json 字符串指针
+// @param return_parse_end:         输出参数，返回解析结尾的指针
+// @param require_null_terminated:  是否要求 json 字符串必须有结束符
+cJSON* cJSON_ParseWithOpts(const char *value, const char **return_parse_end, int require_null_terminated)
+{
+    return cJSON_ParseWithContext(NULL, value, return_parse_end, require_null_terminated);
+}
+
+// 使用 context 解析，错误位置记录在 context 中，context 为 NULL 时与 cJSON_ParseWithOpts 相同
+cJSON* cJSON_ParseWithContext(cJSON_Context *context, const char *value, const char **return_parse_end,
+                              int require_null_terminated)
+{
+    parse_context ctx;
+    cJSON *c;
+
+    parse_begin(&ctx, context);
+    c = parse_root(value, return_parse_end, require_null_terminated, &ctx);
+    parse_end(&ctx, context);
+    return c;
+}
+
+// 按长度解析，不要求 value 以 '\0' 结尾，解析不读取 value + length 之后的字节
+cJSON* cJSON_ParseWithLengthContext(cJSON_Context *context, const char *value, size_t length,
+                                    const char **return_parse_end, int require_null_terminated)
+{
+    parse_context ctx;
+    cJSON *c;
 
+    parse_begin(&ctx, context);
+    ctx.end = value ? value + length : NULL;
+    c = parse_root(value, return_parse_end, require_null_terminated, &ctx);
+    parse_end(&ctx, context);
     return c;
 }
 
+cJSON* cJSON_ParseWithLength(const char *value, size_t length)
+{
+    return cJSON_ParseWithLengthContext(NULL, value, length, NULL, 0);
+}
+
+// 事件驱动解析，不生成 cJSON 树，返回解析结尾的指针，失败返回 NULL
+const char* cJSON_ParseWithHandler(const char *value, const cJSON_Handler *handler, void *user_data)
+{
+    parse_context ctx;
+    const char *end;
+
+    parse_begin(&ctx, NULL);
+    end = parse_run(value, handler, user_data, &ctx);
+    parse_end(&ctx, NULL);
+    return end;
+}
+
 // 解析一段 json 串，返回 cJSON 。完成后需要调用 cJSON_Delete 释放空间
 cJSON* cJSON_Parse(const char* value)
 {
@@ -144,403 +512,1480 @@ cJSON* cJSON_Parse(const char* value)
 }
 
 // 释放 cJSON 的空间
-extern void cJSON_Delete(cJSON* c)
+// 不递归：将子节点链表接到 next 之前，按链表顺序逐个释放，嵌套再深也不会栈溢出
+static void delete_tree(cJSON *c, const cJSON_Hooks *hooks)
 {
-    cJSON *next;
+    cJSON *next, *last;
     while (c) {
-        // 需要遍历生成子节点
-        next = c->next;
-        if (c->child) cJSON_Delete(c->child);
-        if (c->valuestring) cJSON_free(c->valuestring);
-        if (c->string) cJSON_free(c->string);
-        cJSON_free(c);
+        // 需要遍历生成子节点，arena 中的节点也可能挂接了 malloc 的子节点
+        if (c->child) {
+            last = c->tail;
+            if (!last) for (last = c->child; last->next; last = last->next) ;
+            last->next = c->next;
+            next = c->child;
+        }
+        else next = c->next;
+        index_free(c);
+        if (!(c->type & cJSON_ValueIsConst) && c->valuestring) hooks->free_fn(c->valuestring);
+        if (!(c->type & cJSON_StringIsConst) && c->string) hooks->free_fn(c->string);
+        if (c->type & cJSON_IsMapped) munmap(((mapped_root*)c)->map, ((mapped_root*)c)->size);
+        if (!(c->type & cJSON_IsArena)) hooks->free_fn(c);
         c = next;
     }
 }
 
+void cJSON_Delete(cJSON* c)
+{
+    delete_tree(c, &global_hooks);
+}
+
+// 释放用 context 解析出的 cJSON 树，节点和字符串交给 context 的释放函数
+void cJSON_DeleteWithContext(cJSON_Context *context, cJSON *c)
+{
+    delete_tree(c, context ? &context->hooks : &global_hooks);
+}
+
+// 初始化 arena，chunk_capacity 为每块的容量，为 0 时使用默认值 64KB
+void cJSON_InitArena(cJSON_Arena *arena, size_t chunk_capacity)
+{
+    arena->head = NULL;
+    arena->chunk_capacity = chunk_capacity ? chunk_capacity : CJSON_ARENA_CHUNK_CAPACITY;
+}
+
+// 释放 arena 中的所有块，只与块数相关，不需要遍历节点
+void cJSON_ClearArena(cJSON_Arena *arena)
+{
+    cJSON_ArenaChunk *next;
+    while (arena->head) {
+        next = arena->head->next;
+        arena->head->free_fn(arena->head);
+        arena->head = next;
+    }
+}
+
+// 原地解析一段 json 串，字符串直接解码在 json 中，解析后 json 的内容被改写
+cJSON* cJSON_ParseInsitu(char *json)
+{
+    parse_context ctx;
+    cJSON *c;
+
+    parse_begin(&ctx, NULL);
+    ctx.insitu = 1;
+    c = parse_root(json, NULL, 0, &ctx);
+    parse_end(&ctx, NULL);
+    return c;
+}
+
+// 映射整个文件并按长度解析，不经过 read 和拷贝。原地解析时使用私有的写时复制映射，
+// 字符串解码在映射中，不改动文件，也不再分配；根节点换成 mapped_root 接管映射
+cJSON* cJSON_ParseFile(const char *path, int flags)
+{
+    int insitu = flags & cJSON_FileInsitu, mode = MAP_PRIVATE, fd;
+    parse_context ctx;
+    struct stat st;
+    mapped_root *root;
+    cJSON *c;
+    char *map;
+    size_t size;
+
+    ep = NULL;
+    if ((fd = open(path, O_RDONLY)) < 0) return NULL;
+    if (fstat(fd, &st) < 0 || st.st_size <= 0) { close(fd); return NULL; }
+    size = (size_t)st.st_size;
+#ifdef MAP_POPULATE
+    if (insitu) mode |= MAP_POPULATE;   // 原地解析几乎改写每一页，建立映射时一次完成写时复制，代替逐页缺页
+#endif
+    map = (char*)mmap(NULL, size, insitu ? PROT_READ | PROT_WRITE : PROT_READ, mode, fd, 0);
+    close(fd);      // 映射不依赖文件描述符
+    if (map == MAP_FAILED) return NULL;
+    madvise(map, size, MADV_SEQUENTIAL);    // 解析从头到尾读一遍，内核可以加大预读并及早回收读过的页面
+
+    parse_begin(&ctx, NULL);
+    ctx.insitu = insitu;
+    ctx.end = map + size;
+    c = parse_root(map, NULL, 1, &ctx);
+    parse_end(&ctx, NULL);
+    ep = NULL;      // 错误位置在映射中，失败时映射随即解除
+
+    if (c && insitu) {
+        if ((root = (mapped_root*)cJSON_malloc(sizeof(mapped_root)))) {
+            root->item = *c;    // 子节点不指向父节点，复制根节点即可
+            root->item.type |= cJSON_IsMapped;
+            root->map = map;
+            root->size = size;
+            cJSON_free(c);
+            return &root->item;
+        }
+        cJSON_Delete(c);
+        c = NULL;
+    }
+    munmap(map, size);
+    return c;
+}
+
+// 解析一段 json 串，节点和字符串都从 arena 中分配
+cJSON* cJSON_ParseArena(const char *value, cJSON_Arena *arena)
+{
+    parse_context ctx;
+    cJSON *c;
+
+    parse_begin(&ctx, NULL);
+    ctx.arena = arena;
+    c = parse_root(value, NULL, 0, &ctx);
+    parse_end(&ctx, NULL);
+    return c;
+}
+
+// 计算长度失败（显式栈申请内存失败）时 print_value 的返回值
+#define PRINT_FAILED        ((size_t)-1)
+
+// 两遍输出：第一遍只计算长度，按准确长度申请一次空间后，第二遍写入
+static char* print_alloc(cJSON *item, int fmt, const cJSON_Hooks *hooks)
+{
+    size_t len;
+    char *out;
+    if (!item) return NULL;
+
+    len = print_value(item, fmt, NULL, hooks);
+    if (len == PRINT_FAILED) return NULL;
+    out = (char*)hooks->malloc_fn(len + 1);
+    if (!out) return NULL;
+    print_value(item, fmt, out, hooks);
+    out[len] = 0;
+    return out;
+}
+
 // 返回 cJSON 对象的输出字符串，带格式（缩进换行），使用完成后需要手动 free
 char*  cJSON_Print(cJSON* item)
 {
-    printbuffer p;
-    p.offset = 0;
-    p.length = 64;
-    p.buffer = (char*)cJSON_malloc(p.length);
-
-    return print_value(item, 0, 1, &p);
+    return print_alloc(item, 1, &global_hooks);
 }
 
 // 返回 cJSON 对象的输出字符串，不带格式（只有一行），使用完成后需要手动 free
 extern char*  cJSON_PrintUnformatted(cJSON* item)
 {
-    printbuffer p;
-    p.offset = 0;
-    p.length = 64;
-    p.buffer = (char*)cJSON_malloc(p.length);
+    return print_alloc(item, 0, &global_hooks);
+}
 
-    return print_value(item, 0, 0, &p);;
+// 使用 context 的分配函数输出，返回的字符串需要用 context 的 free_fn 释放
+char*  cJSON_PrintWithContext(cJSON_Context *context, cJSON *item, int fmt)
+{
+    return print_alloc(item, fmt, context ? &context->hooks : &global_hooks);
 }
 
-// 解析字符串格式的 json 串，返回后续字符串的指针
-static const char* parse_string(cJSON *item, const char *str)
+// 输出到调用者提供的 buffer 中，len 为 buffer 的大小，空间不足时返回 0，不申请内存
+int    cJSON_PrintPreallocated(cJSON *item, char *buf, int len, int fmt)
 {
-    const char *ptr = str + 1;
-    char *ptr2, *out;
-    int  len = 0;
+    size_t needed;
+    if (!item || !buf || len <= 0) return 0;
+
+    needed = print_value(item, fmt, NULL, &global_hooks);
+    if (needed == PRINT_FAILED || needed >= (size_t)len) return 0;
+    print_value(item, fmt, buf, &global_hooks);
+    buf[needed] = 0;
+    return 1;
+}
 
-    if (*str != '\"') { ep = str; return NULL; }    // 非字符串
+// 字符串解码缓冲区的初始大小
+#define PARSE_SCRATCH_SIZE  256
 
-    // 统计字符串长度，跳过斜线，斜线为转义符
-    while (*ptr != '\"' && *ptr && ++len) { if (*ptr++ == '\\') ptr++; }
+// 确保解码缓冲区在 offset 之后至少还有 needed 字节，返回 offset 处的地址
+static char* scratch_reserve(parse_context *ctx, size_t offset, size_t needed)
+{
+    char *buffer;
+    size_t size;
+
+    if (offset + needed <= ctx->scratch_size) return ctx->scratch + offset;
+
+    size = ctx->scratch_size ? ctx->scratch_size : PARSE_SCRATCH_SIZE;
+    while (size < offset + needed) size *= 2;
+    buffer = (char*)ctx->hooks->malloc_fn(size);
+    if (!buffer) return NULL;
+    if (offset) memcpy(buffer, ctx->scratch, offset);
+    if (ctx->scratch) ctx->hooks->free_fn(ctx->scratch);
+    ctx->scratch = buffer;
+    ctx->scratch_size = size;
+    return buffer + offset;
+}
 
-    out = (char*)cJSON_malloc(len + 1);
-    if (!out) return NULL;
+// SSE2 的对齐读取可能读到结束符之后的字节（不跨页，不会出错），需要告诉 AddressSanitizer 跳过检查
+#if defined(__SANITIZE_ADDRESS__)
+#define NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address))
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address))
+#endif
+#endif
+#ifndef NO_SANITIZE_ADDRESS
+#define NO_SANITIZE_ADDRESS
+#endif
+
+#if defined(__SSE2__)
+// 16 字节中引号、斜线和控制字符（小于等于 0x1F）所在位置的掩码
+static inline int scan_mask(__m128i s)
+{
+    const __m128i t1 = _mm_cmpeq_epi8(s, _mm_set1_epi8('\"'));
+    const __m128i t2 = _mm_cmpeq_epi8(s, _mm_set1_epi8('\\'));
+    const __m128i t3 = _mm_cmpeq_epi8(_mm_max_epu8(s, _mm_set1_epi8(0x1F)), _mm_set1_epi8(0x1F));
+    return _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(t1, t2), t3));
+}
 
-    ptr = str + 1; ptr2 = out;
-    while (*ptr != '\"' && *ptr) {
-        if (*ptr != '\\') *ptr2++ = *ptr++;         // 非转义字符，直接赋值
-        else {
-            ptr++;
-            switch (*ptr) {
-                case 'n': *ptr2++ = '\n'; break;    // 换行符
-                case 't': *ptr2++ = '\t'; break;    // TAB 符
-                // TODO: 源码中还有其他转移字符和 utf16 的字符，非重点，这里不做处理
-                default: *ptr2++ = *ptr;  break;
-            }
-            ptr++;
+// p 之后的 16 字节不跨页时可以直接非对齐读取，短字符串通常一次即可找到结尾
+#define SCAN_NO_PAGE_CROSS(p)   (((size_t)(p) & 4095) <= 4096 - 16)
+#define SCAN_ALIGN_UP(p)        ((const char*)(((size_t)(p) + 16) & ~(size_t)15))
+// 按长度解析时 end 也视为停止字符（可以正好在这 16 字节之后），保证不会在 end 上读取下一块，
+// end 之后的页面可能不存在。end 为 NULL 时为 0
+#define SCAN_END_MASK(p, end)   ((end) && (end) - (p) <= 16 ? 1 << ((end) - (p)) : 0)
+#endif
+
+// 将不需要转义的字符拷贝到解码缓冲区的 *len 处，停在引号、斜线或控制字符（包括结束符）上，或者 ctx->end 上
+// 参考 rapidjson 的 ScanCopyUnescapedString，每次扫描 16 字节
+NO_SANITIZE_ADDRESS
+static int scan_copy_unescaped(parse_context *ctx, const char **str, size_t *len)
+{
+    const char *p = *str, *next, *end = ctx->end;
+    size_t n = *len;
+    char *out;
+    int i, mask;
+
+#if defined(__SSE2__)
+    if (!(out = scratch_reserve(ctx, n, 16))) return 0;
+    if (p == end) return 1;
+    if (SCAN_NO_PAGE_CROSS(p)) {
+        const __m128i s = _mm_loadu_si128((const __m128i*)p);
+        if ((mask = scan_mask(s) | SCAN_END_MASK(p, end))) {
+            i = __builtin_ctz(mask);
+            memcpy(out, p, i);
+            *str = p + i; *len = n + i;
+            return 1;
+        }
+        // 多拷贝的字节会被之后的写入覆盖，从下一个 16 字节边界继续
+        _mm_storeu_si128((__m128i*)out, s);
+        next = SCAN_ALIGN_UP(p);
+        n += next - p;
+        p = next;
+    }
+    else {  // 逐字节处理到 16 字节对齐，之后的对齐读取不会跨越页边界
+        for (i = 0; (size_t)p & 15; i++, p++) {
+            if (p == end || *p == '\"' || *p == '\\' || (unsigned char)*p < 0x20) { *str = p; *len = n + i; return 1; }
+            out[i] = *p;
         }
+        n += i;
+        if (p == end) { *str = p; *len = n; return 1; }
     }
 
-    *ptr2 = 0;
-    if (*ptr == '\"') ptr++;
-    item->valuestring = out;
-    item->type = cJSON_String;
+    for (;;) {
+        const __m128i s = _mm_load_si128((const __m128i*)p);
+        mask = scan_mask(s) | SCAN_END_MASK(p, end);
+        if (!(out = scratch_reserve(ctx, n, 16))) return 0;
+        if (mask) {
+            i = __builtin_ctz(mask);
+            memcpy(out, p, i);
+            p += i; n += i;
+            break;
+        }
+        _mm_storeu_si128((__m128i*)out, s);
+        p += 16; n += 16;
+    }
+#else
+    (void)next; (void)mask;
+    for (;;) {
+        if (!(out = scratch_reserve(ctx, n, 16))) return 0;
+        for (i = 0; i < 16; i++, p++) {
+            if (p == end || *p == '\"' || *p == '\\' || (unsigned char)*p < 0x20) break;
+            out[i] = *p;
+        }
+        n += i;
+        if (i < 16) break;
+    }
+#endif
 
-    return ptr;
+    *str = p; *len = n;
+    return 1;
 }
 
-// 解析数据格式的 json 串，返回后续字符串的指针
-static const char* parse_number(cJSON *item, const char *num)
+// 返回 p 之后第一个引号、斜线或控制字符（包括结束符）的位置，end 非 NULL 时最多到 end，不拷贝，用于原地解析和输出字符串
+NO_SANITIZE_ADDRESS
+static const char* scan_unescaped(const char *p, const char *end)
 {
-    double n = 0, sign = 1, scale = 0;      // sign 符号位； scale 小数位
-    int subscale = 0, signsubscale = 1;     // 科学计数法 signsubscale 符号位； subscale 指数
+#if defined(__SSE2__)
+    int mask;
 
-    if (*num == '-') sign = -1, num++;      // 负数
-    if (*num == '0') num++;                 // 0 开头，忽略不计
-    if (*num >= '1' && *num <= '9') { do n = (n * 10.0) + (*num++ - '0'); while(*num >= '0' && *num <= '9'); }
-    if (*num == '.' && num[1] >= '0' && num[1] <= '9') {   // 小数点
-        num++;                              // 注意统计小数位 scale
-        do n = (n * 10.0) + (*num++ - '0'), scale--; while(*num >= '0' && *num <= '9'); 
+    if (p == end) return p;
+    if (SCAN_NO_PAGE_CROSS(p)) {
+        if ((mask = scan_mask(_mm_loadu_si128((const __m128i*)p)) | SCAN_END_MASK(p, end))) return p + __builtin_ctz(mask);
+        p = SCAN_ALIGN_UP(p);
     }
-    if (*num == 'e' || *num == 'E') {       // 科学计数法
-        num++;
-        if (*num == '+') num++; else if (*num == '-') signsubscale = -1, num++;
-        while (*num >= '0' && *num <= '9') subscale = (subscale * 10) + (*num++ - '0');
+    else {
+        for (; (size_t)p & 15; p++)
+            if (p == end || *p == '\"' || *p == '\\' || (unsigned char)*p < 0x20) return p;
+        if (p == end) return p;
     }
 
-    // 计算数据的值
-    n = sign * n * pow(10.0, (scale + subscale * signsubscale));
+    for (;; p += 16)
+        if ((mask = scan_mask(_mm_load_si128((const __m128i*)p)) | SCAN_END_MASK(p, end))) return p + __builtin_ctz(mask);
+#else
+    while (p != end && *p != '\"' && *p != '\\' && (unsigned char)*p >= 0x20) p++;
+    return p;
+#endif
+}
+
+// 解析 4 位十六进制数，非法字符返回 -1
+static int parse_hex4(const char *str)
+{
+    int h = 0, i;
+    for (i = 0; i < 4; i++, str++) {
+        h <<= 4;
+        if (*str >= '0' && *str <= '9') h += *str - '0';
+        else if (*str >= 'A' && *str <= 'F') h += 10 + *str - 'A';
+        else if (*str >= 'a' && *str <= 'f') h += 10 + *str - 'a';
+        else return -1;
+    }
+    return h;
+}
+
+// 将 unicode 码点编码为 utf8，返回字节数
+static int utf8_encode(unsigned uc, char *out)
+{
+    if (uc < 0x80) { out[0] = (char)uc; return 1; }
+    if (uc < 0x800) {
+        out[0] = (char)(0xC0 | (uc >> 6));
+        out[1] = (char)(0x80 | (uc & 0x3F));
+        return 2;
+    }
+    if (uc < 0x10000) {
+        out[0] = (char)(0xE0 | (uc >> 12));
+        out[1] = (char)(0x80 | ((uc >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (uc & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | (uc >> 18));
+    out[1] = (char)(0x80 | ((uc >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((uc >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (uc & 0x3F));
+    return 4;
+}
+
+// 解析字符串格式的 json 串，返回后续字符串的指针
+// 只扫描一遍：解码到 ctx 的缓冲区中，由 *out 和 *out_len 返回，内容在下一个字符串解析前有效
+// 原地解析时解码到输入 buffer 中引号之后的位置，解码结果不会比原串长，不会覆盖未读的内容
+// 未结束的字符串、未转义的控制字符、非法的转义和 utf16 代理对都视为错误
+static const char* parse_string(const char *str, parse_context *ctx, const char **out_str, size_t *out_len)
+{
+    const char *ptr = str + 1, *run;
+    char *base = (char*)str + 1;    // 原地解析时的输出位置，输入 buffer 本身可写
+    size_t len = 0;
+    char *out;
+    int uc, uc2, n, skip_len;
+    char c;
+
+    if (parse_peek(ctx, str) != '\"') { ctx->error = str; return NULL; }    // 非字符串
+
+    for (;;) {
+        if (ctx->insitu) {  // 出现转义之前 base + len 与 ptr 重合，不需要移动
+            run = scan_unescaped(ptr, ctx->end);
+            if (base + len != ptr) memmove(base + len, ptr, run - ptr);
+            len += run - ptr;
+            ptr = run;
+        }
+        else if (!scan_copy_unescaped(ctx, &ptr, &len)) return NULL;
+        if ((c = parse_peek(ctx, ptr)) == '\"') break;
+        if (c != '\\' || !parse_have(ctx, ptr, 2)) { ctx->error = ptr; return NULL; }    // 控制字符或结束符
+
+        out = ctx->insitu ? base + len : scratch_reserve(ctx, len, 4);
+        if (!out) return NULL;
+        skip_len = 2;
+        switch (ptr[1]) {
+            case '\"': case '\\': case '/':
+                      *out = ptr[1]; n = 1; break;
+            case 'b': *out = '\b';   n = 1; break;
+            case 'f': *out = '\f';   n = 1; break;
+            case 'n': *out = '\n';   n = 1; break;  // 换行符
+            case 'r': *out = '\r';   n = 1; break;
+            case 't': *out = '\t';   n = 1; break;  // TAB 符
+            case 'u':   // utf16 转为 utf8
+                uc = parse_have(ctx, ptr, 6) ? parse_hex4(ptr + 2) : -1;
+                if (uc < 0 || (uc >= 0xDC00 && uc <= 0xDFFF)) { ctx->error = ptr; return NULL; }
+                skip_len = 6;
+                if (uc >= 0xD800 && uc <= 0xDBFF) { // 代理对，后面必须紧跟低位代理
+                    if (!parse_have(ctx, ptr, 12) || ptr[6] != '\\' || ptr[7] != 'u') { ctx->error = ptr; return NULL; }
+                    uc2 = parse_hex4(ptr + 8);
+                    if (uc2 < 0xDC00 || uc2 > 0xDFFF) { ctx->error = ptr; return NULL; }
+                    uc = 0x10000 + (((uc & 0x3FF) << 10) | (uc2 & 0x3FF));
+                    skip_len = 12;
+                }
+                // C 字符串无法保存 \u0000，与 cJSON 一致将其丢弃
+                n = uc ? utf8_encode((unsigned)uc, out) : 0;
+                break;
+            default: ctx->error = ptr; return NULL;  // 非法转义
+        }
+        len += n;
+        ptr += skip_len;
+    }
+
+    if (ctx->insitu) out = base;    // 结束符最多覆盖到结尾的引号
+    else if (!(out = scratch_reserve(ctx, len, 1))) return NULL;
+    else out = ctx->scratch;
+    out[len] = 0;
+
+    *out_str = out;
+    *out_len = len;
+    return ptr + 1;
+}
+
+// 10 的整数次幂，1e22 以内 double 都可以精确表示
+static const double pow10_table[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// 尾数再乘 10 加一位数字不会溢出 unsigned long long 的上限
+#define NUMBER_MANTISSA_LIMIT   1844674407370955160ULL
+
+// 将 double 转换为 int/long long，超出范围时取边界值，避免未定义行为
+static int number_to_int(double d)
+{
+    if (d >= INT_MAX) return INT_MAX;
+    if (d <= INT_MIN) return INT_MIN;
+    return (int)d;
+}
+
+static long long number_to_int64(double d)
+{
+    if (d >= 9223372036854775807.0) return LLONG_MAX;
+    if (d <= -9223372036854775808.0) return LLONG_MIN;
+    if (d != d) return 0;   // NaN
+    return (long long)d;
+}
+
+// 用 strtod 转换 [start, end) 之间的数字，结果是正确舍入的
+// strtod 的小数点受 locale 影响，拷贝时替换为当前 locale 的小数点
+static int parse_strtod(const char *start, const char *end, parse_context *ctx, double *d)
+{
+    char buffer[64], *copy = buffer, *p;
+    char point = localeconv()->decimal_point[0];
+    size_t len = end - start;
+
+    if (len >= sizeof(buffer) && !(copy = (char*)ctx->hooks->malloc_fn(len + 1))) return 0;
+    memcpy(copy, start, len);
+    copy[len] = 0;
+    if (point != '.') for (p = copy; *p; p++) if (*p == '.') *p = point;
+
+    *d = strtod(copy, NULL);
+    if (copy != buffer) ctx->hooks->free_fn(copy);
+    return 1;
+}
 
-    item->valuedouble = n;
-    item->valueint = (int)n;
-    item->type = cJSON_Number;
+// 解析数据格式的 json 串，返回后续字符串的指针
+// 1. 不带小数和指数的整数直接按 64 位整数累加，精确保存在 valueint64 中
+// 2. 尾数不超过 2^53 且指数在 [-22, 22] 内时，查表做一次乘除即可得到正确舍入的结果
+// 3. 其余情况（有效数字过多、指数过大）交给 strtod
+static const char* parse_number(const char *num, parse_context *ctx, double *value, long long *value64)
+{
+    const char *start = num;
+    unsigned long long m = 0;               // 十进制尾数
+    int exp10 = 0, e = 0;                   // exp10 为尾数对应的 10 的指数
+    int neg = 0, isint = 1, truncated = 0;  // truncated 表示尾数超出 64 位，舍弃了部分有效数字
+    double d;
+    char c = parse_peek(ctx, num);
+
+    if (c == '-') neg = 1, c = parse_peek(ctx, ++num);  // 负数
+    if (c == '0') c = parse_peek(ctx, ++num);   // 0 开头，后面只能是小数点或指数
+    else if (c >= '1' && c <= '9') {
+        do {
+            if (m <= NUMBER_MANTISSA_LIMIT) m = m * 10 + (c - '0');
+            else exp10++, truncated = 1;
+            c = parse_peek(ctx, ++num);
+        } while (c >= '0' && c <= '9');
+    }
+    else { ctx->error = num; return NULL; }         // 没有整数部分
+
+    if (c == '.') {                         // 小数点
+        c = parse_peek(ctx, ++num);
+        if (c < '0' || c > '9') { ctx->error = num; return NULL; }
+        isint = 0;
+        do {
+            if (m <= NUMBER_MANTISSA_LIMIT) m = m * 10 + (c - '0'), exp10--;
+            else truncated = 1;
+            c = parse_peek(ctx, ++num);
+        } while (c >= '0' && c <= '9');
+    }
+
+    if (c == 'e' || c == 'E') {             // 科学计数法
+        int eneg = 0;
+        c = parse_peek(ctx, ++num);
+        isint = 0;
+        if (c == '+') c = parse_peek(ctx, ++num); else if (c == '-') eneg = 1, c = parse_peek(ctx, ++num);
+        if (c < '0' || c > '9') { ctx->error = num; return NULL; }
+        do {
+            if (e < 100000) e = e * 10 + (c - '0');  // 过大的指数必然溢出或下溢，不再累加
+            c = parse_peek(ctx, ++num);
+        } while (c >= '0' && c <= '9');
+        exp10 += eneg ? -e : e;
+    }
+
+    // 计算数据的值
+    if (isint && !truncated && m <= (neg ? 9223372036854775808ULL : 9223372036854775807ULL)) {
+        *value64 = neg ? -(long long)(m - 1) - 1 : (long long)m;
+        d = (double)*value64;
+    }
+    else {
+        if (!truncated && m <= (1ULL << 53) && exp10 >= -22 && exp10 <= 22) {
+            d = (double)m;
+            d = exp10 < 0 ? d / pow10_table[-exp10] : d * pow10_table[exp10];
+            if (neg) d = -d;
+        }
+        else if (!parse_strtod(start, num, ctx, &d)) return NULL;
+        *value64 = number_to_int64(d);
+    }
 
+    *value = d;
     return num;
 }
 
-// 解析数组 [] 格式的 json 串，返回后续字符串的指针
-static const char* parse_array(cJSON *item, const char *value)
+// 调用 handler 中的回调，未设置的回调视为成功
+#define EMIT(cb, args)  (!(cb) || (cb) args)
+
+// 解析对象成员的 key 和冒号，返回 value 的起始指针
+PARSE_INLINE const char* parse_key(const char *value, const cJSON_Handler *h, void *ud, parse_context *ctx)
 {
-    cJSON *child;
-    if (*value != '[') {ep = value; return NULL; }  // 非数组
+    const char *str, *end;
+    size_t len;
 
-    item->type = cJSON_Array;
-    value = skip(value + 1);
-    if (*value == ']') return value + 1;            // 空数组
+    if (!(end = parse_string(value, ctx, &str, &len))) return NULL;
+    if (!EMIT(h->key, (ud, str, len))) { ctx->error = value; return NULL; }
 
-    item->child = child = cJSON_New_Item();
-    if (!item->child) return NULL;
-    value = skip(parse_value(child, skip(value)));          // 跳过空格，解析数组中的字符串
-    if (!value) return NULL;
+    value = skip(end, ctx);
+    if (parse_peek(ctx, value) != ':') { ctx->error = value; return NULL; }     // 对象格式错误，必是 key:value
+    return skip(value + 1, ctx);
+}
 
-    while (*value == ',') {                                 // 作为子节点的 next 项处理数组
-        cJSON *new_item = cJSON_New_Item();
-        if (!new_item) return NULL;
-        child->next = new_item;                             // 连接双向链表
-        new_item->prev = child;
-        child = new_item;
-        value = skip(parse_value(child, skip(value + 1)));  // 跳过空格，解析数组中的字符串
+// 解析 json 字符串，每识别出一个元素调用一次 handler 中的回调，返回后续字符串的指针
+// 使用显式栈代替递归：遇到 [ 或 { 时将容器压栈，转而解析第一个成员；一个值解析完后
+// 根据栈顶容器处理逗号或结束符。嵌套深度超过 nesting_limit 时报错，回调返回 0 时终止解析
+PARSE_INLINE const char* parse_value(const char *value, const cJSON_Handler *h, void *ud, parse_context *ctx)
+{
+    const char *str, *end;
+    size_t len;
+    double d;
+    long long i64;
+    int depth = 0, level, is_object;
+    char c;
+
+    for (;;) {
+        // 解析一个值，数组和对象只处理开始符号
         if (!value) return NULL;
+        c = parse_peek(ctx, value);
+        if (c == '[' || c == '{') {
+            is_object = c == '{';
+            if (depth >= ctx->nesting_limit) { ctx->error = value; return NULL; }    // 嵌套过深
+            if (!EMIT(is_object ? h->start_object : h->start_array, (ud))) { ctx->error = value; return NULL; }
+            value = skip(value + 1, ctx);
+            if (parse_peek(ctx, value) != (is_object ? '}' : ']')) {
+                if (!levels_push(&ctx->levels, depth++, (1 << 1) | is_object)) return NULL;
+                if (is_object) value = parse_key(value, h, ud, ctx);
+                continue;
+            }
+            // 空数组或空对象
+            if (!EMIT(is_object ? h->end_object : h->end_array, (ud, 0))) { ctx->error = value; return NULL; }
+            value++;
+        }
+        else if (c == 'n' && parse_have(ctx, value, 4) && !strncmp(value, "null", 4)) {
+            if (!EMIT(h->null, (ud))) { ctx->error = value; return NULL; }
+            value += 4;
+        }
+        else if (c == 'f' && parse_have(ctx, value, 5) && !strncmp(value, "false", 5)) {
+            if (!EMIT(h->boolean, (ud, 0))) { ctx->error = value; return NULL; }
+            value += 5;
+        }
+        else if (c == 't' && parse_have(ctx, value, 4) && !strncmp(value, "true", 4)) {
+            if (!EMIT(h->boolean, (ud, 1))) { ctx->error = value; return NULL; }
+            value += 4;
+        }
+        else if (c == '\"') {
+            if (!(end = parse_string(value, ctx, &str, &len))) return NULL;
+            if (!EMIT(h->string, (ud, str, len))) { ctx->error = value; return NULL; }
+            value = end;
+        }
+        else if (c == '-' || (c >= '0' && c <= '9')) {
+            if (!(end = parse_number(value, ctx, &d, &i64))) return NULL;
+            if (!EMIT(h->number, (ud, d, i64))) { ctx->error = value; return NULL; }
+            value = end;
+        }
+        else { ctx->error = value; return NULL; }               // 错误格式
+
+        // 当前值解析完成，依次结束已经闭合的容器，直到遇到逗号
+        for (;;) {
+            if (!depth) return value;
+
+            level = ctx->levels.items[depth - 1];
+            is_object = level & 1;
+            value = skip(value, ctx);
+            if ((c = parse_peek(ctx, value)) == ',') break;
+            if (c != (is_object ? '}' : ']')) { ctx->error = value; return NULL; }   // 解析错误
+            if (!EMIT(is_object ? h->end_object : h->end_array, (ud, level >> 1))) { ctx->error = value; return NULL; }
+            value++;
+            depth--;
+        }
+
+        // 逗号之后是同一容器的下一个成员
+        ctx->levels.items[depth - 1] += 1 << 1;
+        value = skip(value + 1, ctx);
+        if (is_object) value = parse_key(value, h, ud, ctx);
     }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// 由解析事件生成 cJSON 树
 
-    if (*value == ']') return value + 1;                    // 数组解析结束
-    ep = value; return NULL;                                // 解析错误
+// 为容器节点 parent 新建一个子节点，连接到孩子链表末尾
+PARSE_INLINE cJSON* parse_new_child(cJSON *parent, parse_context *ctx)
+{
+    cJSON *child = parse_new_item(ctx);
+    if (!child) return NULL;
+
+    if (parent->tail) { parent->tail->next = child; child->prev = parent->tail; }
+    else parent->child = child;
+    parent->tail = child;
+    parent->size++;
+    return child;
 }
 
-// 解析对象 {} 格式的 json 串，返回后续字符串的指针
-static const char* parse_object(cJSON *item, const char *value)
+// 保存解析出的字符串：原地解析时直接借用，否则从 arena 或堆中复制一份
+PARSE_INLINE char* build_strdup(tree_builder *b, const char *str, size_t len)
 {
-    cJSON *child;
-    if (*value != '{') {ep = value; return NULL; }  // 非对象
+    char *out;
+    if (b->ctx->insitu) return (char*)str;
 
-    item->type = cJSON_Object;
-    value = skip(value + 1);
-    if (*value == '}') return value + 1;            // 空对象
+    out = (char*)parse_alloc(b->ctx, len + 1);
+    if (!out) return NULL;
+    memcpy(out, str, len);
+    out[len] = 0;
+    return out;
+}
 
-    item->child = child = cJSON_New_Item();
-    if (!item->child) return NULL;
-    value = skip(parse_string(child, skip(value)));     // 跳过空格，解析对象中的 key 值（字符串）
-    if (!value) return NULL;
-    child->string = child->valuestring; child->valuestring = NULL;
+// 取得下一个值对应的节点并设置类型：根节点已预先分配，对象成员在 key 回调中已经建立
+PARSE_INLINE cJSON* build_item(tree_builder *b, int type)
+{
+    cJSON *item = b->root, *parent;
 
-    if (*value != ':') {ep = value; return NULL; }      // 对象格式错误，必是 key:value
-    value = skip(parse_value(child, skip(value + 1)));  // 跳过空格，解析对象中的 value
-    if (!value) return NULL;
+    if (b->depth) {
+        parent = b->stack.items[b->depth - 1];
+        item = (parent->type & 255) == cJSON_Object ? parent->tail : parse_new_child(parent, b->ctx);
+        if (!item) return NULL;
+    }
+    item->type = type | b->flags;
+    return item;
+}
 
-    while (*value == ',') {                             // 作为子节点的 next 项处理数组
-        cJSON *new_item = cJSON_New_Item();
-        if (!new_item) return NULL;
-        child->next = new_item;                         // 连接双向链表
-        new_item->prev = child;
-        child = new_item;
+PARSE_INLINE int build_null(void *ud)
+{
+    return build_item((tree_builder*)ud, cJSON_NULL) != NULL;
+}
 
-        value = skip(parse_string(child, skip(value + 1))); // 跳过空格，解析对象中的 key 值（字符串）
-        if (!value) return NULL;
-        child->string = child->valuestring; child->valuestring = NULL;
+PARSE_INLINE int build_boolean(void *ud, int b)
+{
+    cJSON *item = build_item((tree_builder*)ud, b ? cJSON_True : cJSON_False);
+    if (!item) return 0;
+    item->valueint = b ? 1 : 0;
+    return 1;
+}
 
-        if (*value != ':') {ep = value; return NULL; }      // 对象格式错误，必是 key:value
-        value = skip(parse_value(child, skip(value + 1)));  // 跳过空格，解析对象中的 value
-        if (!value) return NULL;
-    }
+PARSE_INLINE int build_number(void *ud, double d, long long i)
+{
+    cJSON *item = build_item((tree_builder*)ud, cJSON_Number);
+    if (!item) return 0;
+    item->valuedouble = d;
+    item->valueint64 = i;
+    item->valueint = number_to_int(d);
+    return 1;
+}
 
-    if (*value == '}') return value + 1;            // 数组解析结束
-    ep = value; return NULL;                        // 解析错误
+PARSE_INLINE int build_string(void *ud, const char *str, size_t len)
+{
+    cJSON *item = build_item((tree_builder*)ud, cJSON_String);
+    if (!item) return 0;
+    item->valuestring = build_strdup((tree_builder*)ud, str, len);
+    return item->valuestring != NULL;
 }
 
-// 解析 json 字符串，并赋值给 item 节点，返回后续字符串的指针
-static const char* parse_value(cJSON *item, const char *value)
+// 开始一个容器，压栈后其后的值都作为它的成员
+PARSE_INLINE int build_start(tree_builder *b, int type)
 {
-    if (!value)                      return NULL;
-    if (!strncmp(value, "null", 4))  { item->type = cJSON_NULL; return value + 4; }
-    if (!strncmp(value, "false", 5)) { item->type = cJSON_False; return value + 5; }
-    if (!strncmp(value, "true", 4))  { item->type = cJSON_True; item->valueint = 1; return value + 4; }
-    if (*value == '\"')              { return parse_string(item, value); }
-    if (*value == '-' || (*value >= '0' && *value <= '9')) { return parse_number(item, value); }
-    if (*value == '[')               { return parse_array(item, value); }
-    if (*value == '{')               { return parse_object(item, value); }
+    cJSON *item = build_item(b, type);
+    if (!item) return 0;
+    return stack_push(&b->stack, b->depth++, item);
+}
 
-    // 错误格式
-    ep = value;
-    return NULL;
+PARSE_INLINE int build_start_object(void *ud)
+{
+    return build_start((tree_builder*)ud, cJSON_Object);
 }
 
-// 输出 json 数字
-static char* print_number(cJSON *item, printbuffer *p)
+PARSE_INLINE int build_start_array(void *ud)
 {
-    char *str = NULL;
-    double d  = item->valuedouble;
+    return build_start((tree_builder*)ud, cJSON_Array);
+}
+
+// 对象的 key：新建成员节点，紧接着的值回调会写入该节点
+PARSE_INLINE int build_key(void *ud, const char *str, size_t len)
+{
+    tree_builder *b = (tree_builder*)ud;
+    cJSON *child = parse_new_child(b->stack.items[b->depth - 1], b->ctx);
+    if (!child) return 0;
+    child->type = b->flags;
+    child->string = build_strdup(b, str, len);
+    return child->string != NULL;
+}
 
-    if (d == 0) {
-        str = ensure(p, 2);
-        if (str) strcpy(str, "0");
+// 结束一个容器，arena 中的容器在解析时直接建立索引，之后访问时不再分配
+PARSE_INLINE int build_end(void *ud, int count)
+{
+    tree_builder *b = (tree_builder*)ud;
+    cJSON *item = b->stack.items[--b->depth];
+
+    (void)count;
+    if (b->ctx->arena && index_threshold && item->size >= index_threshold)
+        item->index = index_build(item, b->ctx);
+    return 1;
+}
+
+static const cJSON_Handler tree_handler = {
+    build_null, build_boolean, build_number, build_string,
+    build_start_object, build_key, build_end,
+    build_start_array, build_end
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// 增量解析：json 分多次送入，每送入一段就解析其中完整的部分，节点由 tree_handler 的回调生成。
+// 结构符号（括号、逗号、冒号）逐个驱动状态机；字符串、数字和字面量在段内完整时直接从送入的数据中
+// 解析，跨段时先拷贝到 pending 中，补齐后再解析，因此不需要保存整个 json
+
+// 解析器期待的下一个记号
+enum {
+    PUSH_VALUE,             // 值：根节点、冒号之后、数组的逗号之后
+    PUSH_VALUE_OR_END,      // [ 之后：值或 ]
+    PUSH_KEY,               // 对象的逗号之后：key
+    PUSH_KEY_OR_END,        // { 之后：key 或 }
+    PUSH_COLON,             // key 之后：冒号
+    PUSH_NEXT,              // 成员之后：逗号或容器的结束符
+    PUSH_DONE               // 根节点已结束，之后只能有空白字符
+};
+
+struct cJSON_Parser {
+    parse_context ctx;
+    cJSON_Context *context;     // 创建时传入的 context，结束时写回解码缓冲区
+    tree_builder b;
+    int     state;
+    int     failed;
+    size_t  offset;             // 已送入的字节数，即当前段在整个输入中的偏移
+    size_t  error_offset;
+    char    *pending;           // 跨段的记号，以 '\0' 结尾
+    size_t  pending_len, pending_size;
+    size_t  token_offset;       // pending 中的记号在整个输入中的偏移
+    int     escaped;            // pending 中的字符串是否停在转义符之后
+};
+
+// 数字记号中可能出现的字符，记号的结尾由第一个其他字符确定，格式由 parse_number 检查
+static int push_number_char(char c)
+{
+    return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+}
+
+// 在 [p, end) 中找字符串记号结尾的引号（不含开头的引号），返回引号之后的位置，没有时返回 NULL。
+// 引号前连续的反斜线为奇数个时是转义的引号；*escaped 为上一段是否停在转义符之后，返回 NULL 时更新
+static const char* push_string_end(const char *p, const char *end, int *escaped)
+{
+    const char *q, *s, *t;
+    int carry = *escaped, odd;
+
+    while (p < end) {
+        q = (const char*)memchr(p, '\"', end - p);
+        s = q ? q : end;
+        for (t = s; t > p && t[-1] == '\\'; t--) ;
+        odd = ((int)(s - t) + (t == p ? carry : 0)) & 1;
+        if (!q) { *escaped = odd; return NULL; }
+        if (!odd) return q + 1;
+        carry = 0;
+        p = q + 1;
     }
-    else if (fabs((double)item->valueint - d) <= DBL_EPSILON && d <= INT_MAX && d >= INT_MIN) {
-        // 输出为整数
-        str = ensure(p, 21);                // /* 2^64+1 can be represented in 21 chars. */
-        if (str) sprintf(str, "%d", item->valueint);
+    *escaped = carry;   // 没有数据（空的分段）时保留上一段末尾的反斜杠
+    return NULL;
+}
+
+// 在 [p, end) 中找以 first 开头的记号的结尾，已有 have 个字节在 pending 中，数据不够时返回 NULL
+static const char* push_token_end(cJSON_Parser *ps, char first, size_t have, const char *p, const char *end)
+{
+    size_t need;
+
+    switch (first) {
+        case '\"': return push_string_end(p, end, &ps->escaped);
+        case 't': case 'n': need = 4; break;
+        case 'f': need = 5; break;
+        default:
+            while (p < end && push_number_char(*p)) p++;
+            return p < end ? p : NULL;
     }
-    else {
-        str = ensure(p, 64);
-        if (str) sprintf(str, "%f", d);     // 源码中处理更复杂一些，这里直接输出
+    return have + (size_t)(end - p) >= need ? p + (need - have) : NULL;
+}
+
+// 记下出错位置在整个输入中的偏移，只保留第一个错误，返回 0
+static int push_fail(cJSON_Parser *ps, size_t offset)
+{
+    if (!ps->failed) ps->error_offset = offset;
+    ps->failed = 1;
+    return 0;
+}
+
+// 解析一个完整的记号 [str, end)，生成节点或对象成员的 key，base 为 str 在整个输入中的偏移
+static int push_token(cJSON_Parser *ps, const char *str, const char *end, size_t base)
+{
+    parse_context *ctx = &ps->ctx;
+    const char *out, *e = NULL;
+    size_t len;
+    double d;
+    long long i64;
+    int ok = 0;
+
+    ctx->error = NULL;
+    switch (*str) {
+        case '\"':
+            if (!(e = parse_string(str, ctx, &out, &len))) break;
+            if (ps->state == PUSH_KEY || ps->state == PUSH_KEY_OR_END) {
+                if (!build_key(&ps->b, out, len)) return push_fail(ps, base);
+                ps->state = PUSH_COLON;
+                return 1;
+            }
+            ok = build_string(&ps->b, out, len);
+            break;
+        case 'n': if (!strncmp(str, "null", 4))  e = str + 4, ok = build_null(&ps->b); break;
+        case 'f': if (!strncmp(str, "false", 5)) e = str + 5, ok = build_boolean(&ps->b, 0); break;
+        case 't': if (!strncmp(str, "true", 4))  e = str + 4, ok = build_boolean(&ps->b, 1); break;
+        default:
+            if (*str == '-' || (*str >= '0' && *str <= '9')) e = parse_number(str, ctx, &d, &i64);
+            if (e == end) ok = build_number(&ps->b, d, i64);
+            break;
     }
+    if (e != end) return push_fail(ps, base + (ctx->error ? (size_t)(ctx->error - str) : e ? (size_t)(e - str) : 0));
+    if (!ok) return push_fail(ps, base);
+    ps->state = ps->b.depth ? PUSH_NEXT : PUSH_DONE;
+    return 1;
+}
 
-    return str;
+// 将 [p, end) 追加到 pending 中，空间不足时扩容为两倍
+static int push_pending(cJSON_Parser *ps, const char *p, const char *end)
+{
+    size_t len = (size_t)(end - p), size;
+    char *buf;
+
+    if (ps->pending_len + len + 1 > ps->pending_size) {
+        size = ps->pending_size ? ps->pending_size : 64;
+        while (size < ps->pending_len + len + 1) size *= 2;
+        if (!(buf = (char*)ps->ctx.hooks->malloc_fn(size))) return push_fail(ps, ps->token_offset);
+        if (ps->pending_len) memcpy(buf, ps->pending, ps->pending_len);
+        if (ps->pending) ps->ctx.hooks->free_fn(ps->pending);
+        ps->pending = buf;
+        ps->pending_size = size;
+    }
+    memcpy(ps->pending + ps->pending_len, p, len);
+    ps->pending_len += len;
+    ps->pending[ps->pending_len] = 0;
+    return 1;
 }
 
-// 输出 json 字符串
-static char *print_string_ptr(const char *str, printbuffer *p)
+// 创建增量解析器，根节点预先分配，与 parse_root 相同
+cJSON_Parser* cJSON_ParserCreate(cJSON_Context *context)
 {
-    const char *ptr;
-    char *ptr2, *out;
-    int len;
+    const cJSON_Hooks *hooks = context ? &context->hooks : &global_hooks;
+    cJSON_Parser *ps = (cJSON_Parser*)hooks->malloc_fn(sizeof(cJSON_Parser));
+    if (!ps) return NULL;
+
+    memset(ps, 0, sizeof(*ps));
+    parse_begin(&ps->ctx, context);
+    ps->context = context;
+    ps->state = PUSH_VALUE;
+    ps->b.ctx = &ps->ctx;
+    ps->b.flags = ps->ctx.arena ? CJSON_ARENA_FLAGS : 0;
+    stack_init(&ps->b.stack, ps->ctx.hooks);
+    if (!(ps->b.root = parse_new_item(&ps->ctx))) {
+        parse_end(&ps->ctx, context);
+        hooks->free_fn(ps);
+        return NULL;
+    }
+    return ps;
+}
 
-    // 源码中会处理转义字符，这里不做处理，可以参考源码
-    if (!str) {
-        out = ensure(p, 3);
-        if (!out) return NULL;
-        strcpy(out, "\"\"");
+// 送入一段 json，解析其中完整的部分，出错返回 0
+int cJSON_ParserFeed(cJSON_Parser *ps, const char *bytes, size_t len)
+{
+    const char *p = bytes, *end = bytes + len, *e;
+    cJSON *parent;
+    size_t n;
+    int is_object;
+
+    if (ps->failed) return 0;
+
+    // 先补齐上一段留下的记号
+    if (ps->pending_len) {
+        e = push_token_end(ps, ps->pending[0], ps->pending_len, p, end);
+        if (!push_pending(ps, p, e ? e : end)) return 0;
+        if (!e) { ps->offset += len; return 1; }
+        n = ps->pending_len;
+        ps->pending_len = 0;
+        if (!push_token(ps, ps->pending, ps->pending + n, ps->token_offset)) return 0;
+        p = e;
     }
-    else {
-        for (ptr = str; *ptr; ptr++) ;
-        len = ptr - str;
 
-        out = ensure(p, len + 3);   // 双引号 + 结束符
-        if (!out) return NULL;
+    for (; p < end; p++) {
+        if ((unsigned char)*p <= 32 && *p) continue;     // 空白字符，与 skip 一致
+        switch (ps->state) {
+            case PUSH_DONE:
+                return push_fail(ps, ps->offset + (p - bytes));
+            case PUSH_COLON:
+                if (*p != ':') return push_fail(ps, ps->offset + (p - bytes));
+                ps->state = PUSH_VALUE;
+                continue;
+            case PUSH_NEXT:
+            case PUSH_VALUE_OR_END:
+            case PUSH_KEY_OR_END:
+                parent = ps->b.stack.items[ps->b.depth - 1];
+                is_object = (parent->type & 255) == cJSON_Object;
+                if (*p == (is_object ? '}' : ']')) {
+                    build_end(&ps->b, parent->size);
+                    ps->state = ps->b.depth ? PUSH_NEXT : PUSH_DONE;
+                    continue;
+                }
+                if (ps->state == PUSH_NEXT) {
+                    if (*p != ',') return push_fail(ps, ps->offset + (p - bytes));
+                    ps->state = is_object ? PUSH_KEY : PUSH_VALUE;
+                    continue;
+                }
+                break;
+            default:
+                break;
+        }
+
+        // 期待值或 key
+        if (ps->state == PUSH_KEY || ps->state == PUSH_KEY_OR_END) {
+            if (*p != '\"') return push_fail(ps, ps->offset + (p - bytes));
+        }
+        else if (*p == '[' || *p == '{') {
+            is_object = *p == '{';
+            if (ps->b.depth >= ps->ctx.nesting_limit ||     // 嵌套过深
+                !(is_object ? build_start_object(&ps->b) : build_start_array(&ps->b)))
+                return push_fail(ps, ps->offset + (p - bytes));
+            ps->state = is_object ? PUSH_KEY_OR_END : PUSH_VALUE_OR_END;
+            continue;
+        }
 
-        ptr2 = out; *ptr2++ = '\"';
-        strcpy(ptr2, str);
-        ptr2[len] = '\"';
-        ptr2[len + 1] = 0;
+        ps->escaped = 0;
+        e = push_token_end(ps, *p, 0, *p == '\"' ? p + 1 : p, end);
+        if (!e) {   // 记号延续到下一段
+            ps->token_offset = ps->offset + (p - bytes);
+            if (!push_pending(ps, p, end)) return 0;
+            break;
+        }
+        if (!push_token(ps, p, e, ps->offset + (p - bytes))) return 0;
+        p = e - 1;
     }
+    ps->offset += len;
+    return 1;
+}
 
-    return out;
+// 结束输入：补齐结尾的数字，检查 json 是否完整，释放解析器
+cJSON* cJSON_ParserFinish(cJSON_Parser *ps, size_t *error_offset)
+{
+    cJSON *root = ps->b.root;
+    size_t n = ps->pending_len;
+
+    if (!ps->failed && n) {     // 只有数字可以由输入结束来结束，字符串和字面量不完整
+        ps->pending_len = 0;
+        if (push_number_char(ps->pending[0])) push_token(ps, ps->pending, ps->pending + n, ps->token_offset);
+        else push_fail(ps, ps->token_offset);
+    }
+    if (!ps->failed && ps->state != PUSH_DONE) push_fail(ps, ps->offset);   // json 不完整
+
+    if (ps->failed) {
+        if (!ps->ctx.arena) delete_tree(root, ps->ctx.hooks);
+        root = NULL;
+        if (error_offset) *error_offset = ps->error_offset;
+    }
+
+    stack_free(&ps->b.stack);
+    if (ps->pending) ps->ctx.hooks->free_fn(ps->pending);
+    ps->ctx.error = NULL;       // 错误位置以偏移返回，输入早已不在
+    parse_end(&ps->ctx, ps->context);
+    (ps->context ? ps->context->hooks.free_fn : global_hooks.free_fn)(ps);
+    return root;
 }
 
-// 输出 json 字符串
-static char* print_string(cJSON *item, printbuffer *p)
+///////////////////////////////////////////////////////////////////////////////
+// 数字输出：整数按两位查表输出，浮点数使用 Grisu2 算法输出可往返的最短表示
+// 移植自 rapidjson 的 internal/itoa.h、internal/diyfp.h 和 internal/dtoa.h
+
+// 两位十进制数字查找表 "00" ~ "99"
+static const char digits_lut[201] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// 无符号 64 位整数转十进制，每次从低位输出两位，返回结尾指针
+static char* u64toa(unsigned long long value, char *buffer)
 {
-    return print_string_ptr(item->valuestring, p);
+    char temp[20], *ptr = temp + sizeof(temp);
+    const char *d;
+
+    while (value >= 100) {
+        d = digits_lut + (value % 100) * 2;
+        value /= 100;
+        *--ptr = d[1]; *--ptr = d[0];
+    }
+    if (value >= 10) { d = digits_lut + value * 2; *--ptr = d[1]; *--ptr = d[0]; }
+    else *--ptr = (char)('0' + value);
+
+    memcpy(buffer, ptr, temp + sizeof(temp) - ptr);
+    return buffer + (temp + sizeof(temp) - ptr);
 }
 
-// 输出 json 数组
-static char* print_array(cJSON *item, int depth, int fmt, printbuffer *p)
+static char* i64toa(long long value, char *buffer)
 {
-    int numentries = 0, i = 0, len;
-    char *out, *ptr;
-    cJSON *child = item->child;
+    unsigned long long u = (unsigned long long)value;
+    if (value < 0) { *buffer++ = '-'; u = ~u + 1; }
+    return u64toa(u, buffer);
+}
 
-    // 计算数组中总共有多少数据
-    while (child) { numentries++; child = child->next; }
+// 自定义浮点数 f * 2^e，f 为 64 位尾数
+typedef struct { unsigned long long f; int e; } diyfp;
 
-    // 空数组
-    if (!numentries) {
-        out = ensure(p, 3);
-        if (out) strcpy(out, "[]");
-        return out;
-    }
+#define DP_SIGNIFICAND_SIZE 52
+#define DP_EXPONENT_BIAS    (0x3FF + DP_SIGNIFICAND_SIZE)
+#define DP_MIN_EXPONENT     (-DP_EXPONENT_BIAS)
+#define DP_EXPONENT_MASK    0x7FF0000000000000ULL
+#define DP_SIGNIFICAND_MASK 0x000FFFFFFFFFFFFFULL
+#define DP_HIDDEN_BIT       0x0010000000000000ULL
 
-    i = p->offset;                  // 记录输出位置
-    ptr = ensure(p, 1);
-    if (!ptr) return NULL;
-    *ptr = '['; p->offset++;
+static diyfp diyfp_make(unsigned long long f, int e)
+{
+    diyfp r;
+    r.f = f; r.e = e;
+    return r;
+}
 
-    child = item->child;
-    while (child) {
-        out = print_value(child, depth + 1, fmt, p);
-        p->offset = update(p);      // 此处统一计算偏移
+static diyfp diyfp_from_double(double d)
+{
+    unsigned long long u;
+    int biased_e;
 
-        if (child->next) {          // 若有 next 计算逗号和分隔符
-            len = fmt ? 2 : 1;
-            ptr = ensure(p, len + 1);
-            if (!ptr) return 0;
-            *ptr++ = ',';
-            if (fmt) *ptr++ = ' ';
-            *ptr = 0;
-            p->offset += len;
-        }
-        child = child->next;
-    }
+    memcpy(&u, &d, sizeof(u));
+    biased_e = (int)((u & DP_EXPONENT_MASK) >> DP_SIGNIFICAND_SIZE);
+    if (biased_e != 0) return diyfp_make((u & DP_SIGNIFICAND_MASK) + DP_HIDDEN_BIT, biased_e - DP_EXPONENT_BIAS);
+    return diyfp_make(u & DP_SIGNIFICAND_MASK, DP_MIN_EXPONENT + 1);    // 非规格化数
+}
 
-    ptr = ensure(p, 2);
-    if (!ptr) return NULL;
-    *ptr++ = ']'; *ptr = 0;
-    out = p->buffer + i;
+// 两个 diyfp 相乘，只保留高 64 位（四舍五入）
+static diyfp diyfp_mul(diyfp a, diyfp b)
+{
+#if defined(__GNUC__) && defined(__x86_64__)
+    unsigned __int128 p = (unsigned __int128)a.f * b.f;
+    unsigned long long h = (unsigned long long)(p >> 64);
+    if ((unsigned long long)p & (1ULL << 63)) h++;
+    return diyfp_make(h, a.e + b.e + 64);
+#else
+    const unsigned long long M32 = 0xFFFFFFFFULL;
+    unsigned long long ah = a.f >> 32, al = a.f & M32, bh = b.f >> 32, bl = b.f & M32;
+    unsigned long long ac = ah * bh, bc = al * bh, ad = ah * bl, bd = al * bl;
+    unsigned long long tmp = (bd >> 32) + (ad & M32) + (bc & M32);
+    tmp += 1U << 31;
+    return diyfp_make(ac + (ad >> 32) + (bc >> 32) + (tmp >> 32), a.e + b.e + 64);
+#endif
+}
 
-    return out;
+// 规格化，使尾数最高位为 1
+static diyfp diyfp_normalize(diyfp a)
+{
+#if defined(__GNUC__)
+    int s = __builtin_clzll(a.f);
+    return diyfp_make(a.f << s, a.e - s);
+#else
+    while (!(a.f & (1ULL << 63))) a.f <<= 1, a.e--;
+    return a;
+#endif
 }
 
-// 输出 json 对象
-static char* print_object(cJSON *item, int depth, int fmt, printbuffer *p)
+// 计算 v 的上下边界 m+ 和 m-，两者使用相同的指数
+static void diyfp_boundaries(diyfp v, diyfp *minus, diyfp *plus)
 {
-    int numentries = 0, i = 0, j, len;
-    char *out, *ptr;
-    cJSON *child = item->child;
+    diyfp pl = diyfp_make((v.f << 1) + 1, v.e - 1), mi;
 
-    // 计算对象中总共有多少数据
-    while (child) { numentries++; child = child->next; }
+    while (!(pl.f & (DP_HIDDEN_BIT << 1))) pl.f <<= 1, pl.e--;
+    pl.f <<= 64 - DP_SIGNIFICAND_SIZE - 2;
+    pl.e -= 64 - DP_SIGNIFICAND_SIZE - 2;
 
-    // 空对象
-    if (!numentries) {
-        out = ensure(p, 3);
-        if (out) strcpy(out, "{}");
-        return out;
-    }
+    mi = (v.f == DP_HIDDEN_BIT) ? diyfp_make((v.f << 2) - 1, v.e - 2) : diyfp_make((v.f << 1) - 1, v.e - 1);
+    mi.f <<= mi.e - pl.e;
+    mi.e = pl.e;
+    *plus = pl;
+    *minus = mi;
+}
 
-    i = p->offset;                  // 记录输出位置
+// 缓存的 10 的幂 10^-348, 10^-340, ..., 10^340
+static const unsigned long long cached_powers_f[] = {
+    0xfa8fd5a0081c0288ULL, 0xbaaee17fa23ebf76ULL, 0x8b16fb203055ac76ULL,
+    0xcf42894a5dce35eaULL, 0x9a6bb0aa55653b2dULL, 0xe61acf033d1a45dfULL,
+    0xab70fe17c79ac6caULL, 0xff77b1fcbebcdc4fULL, 0xbe5691ef416bd60cULL,
+    0x8dd01fad907ffc3cULL, 0xd3515c2831559a83ULL, 0x9d71ac8fada6c9b5ULL,
+    0xea9c227723ee8bcbULL, 0xaecc49914078536dULL, 0x823c12795db6ce57ULL,
+    0xc21094364dfb5637ULL, 0x9096ea6f3848984fULL, 0xd77485cb25823ac7ULL,
+    0xa086cfcd97bf97f4ULL, 0xef340a98172aace5ULL, 0xb23867fb2a35b28eULL,
+    0x84c8d4dfd2c63f3bULL, 0xc5dd44271ad3cdbaULL, 0x936b9fcebb25c996ULL,
+    0xdbac6c247d62a584ULL, 0xa3ab66580d5fdaf6ULL, 0xf3e2f893dec3f126ULL,
+    0xb5b5ada8aaff80b8ULL, 0x87625f056c7c4a8bULL, 0xc9bcff6034c13053ULL,
+    0x964e858c91ba2655ULL, 0xdff9772470297ebdULL, 0xa6dfbd9fb8e5b88fULL,
+    0xf8a95fcf88747d94ULL, 0xb94470938fa89bcfULL, 0x8a08f0f8bf0f156bULL,
+    0xcdb02555653131b6ULL, 0x993fe2c6d07b7facULL, 0xe45c10c42a2b3b06ULL,
+    0xaa242499697392d3ULL, 0xfd87b5f28300ca0eULL, 0xbce5086492111aebULL,
+    0x8cbccc096f5088ccULL, 0xd1b71758e219652cULL, 0x9c40000000000000ULL,
+    0xe8d4a51000000000ULL, 0xad78ebc5ac620000ULL, 0x813f3978f8940984ULL,
+    0xc097ce7bc90715b3ULL, 0x8f7e32ce7bea5c70ULL, 0xd5d238a4abe98068ULL,
+    0x9f4f2726179a2245ULL, 0xed63a231d4c4fb27ULL, 0xb0de65388cc8ada8ULL,
+    0x83c7088e1aab65dbULL, 0xc45d1df942711d9aULL, 0x924d692ca61be758ULL,
+    0xda01ee641a708deaULL, 0xa26da3999aef774aULL, 0xf209787bb47d6b85ULL,
+    0xb454e4a179dd1877ULL, 0x865b86925b9bc5c2ULL, 0xc83553c5c8965d3dULL,
+    0x952ab45cfa97a0b3ULL, 0xde469fbd99a05fe3ULL, 0xa59bc234db398c25ULL,
+    0xf6c69a72a3989f5cULL, 0xb7dcbf5354e9beceULL, 0x88fcf317f22241e2ULL,
+    0xcc20ce9bd35c78a5ULL, 0x98165af37b2153dfULL, 0xe2a0b5dc971f303aULL,
+    0xa8d9d1535ce3b396ULL, 0xfb9b7cd9a4a7443cULL, 0xbb764c4ca7a44410ULL,
+    0x8bab8eefb6409c1aULL, 0xd01fef10a657842cULL, 0x9b10a4e5e9913129ULL,
+    0xe7109bfba19c0c9dULL, 0xac2820d9623bf429ULL, 0x80444b5e7aa7cf85ULL,
+    0xbf21e44003acdd2dULL, 0x8e679c2f5e44ff8fULL, 0xd433179d9c8cb841ULL,
+    0x9e19db92b4e31ba9ULL, 0xeb96bf6ebadf77d9ULL, 0xaf87023b9bf0ee6bULL
+};
+
+static const short cached_powers_e[] = {
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007,  -980,
+     -954,  -927,  -901,  -874,  -847,  -821,  -794,  -768,  -741,  -715,
+     -688,  -661,  -635,  -608,  -582,  -555,  -529,  -502,  -475,  -449,
+     -422,  -396,  -369,  -343,  -316,  -289,  -263,  -236,  -210,  -183,
+     -157,  -130,  -103,   -77,   -50,   -24,     3,    30,    56,    83,
+      109,   136,   162,   189,   216,   242,   269,   295,   322,   348,
+      375,   402,   428,   455,   481,   508,   534,   561,   588,   614,
+      641,   667,   694,   720,   747,   774,   800,   827,   853,   880,
+      907,   933,   960,   986,  1013,  1039,  1066
+};
+
+// 取得 c_k = 10^-K，使 w * c_k 的二进制指数落在 [-60, -32] 之间
+static diyfp cached_power(int e, int *K)
+{
+    double dk = (-61 - e) * 0.30102999566398114 + 347;  // dk 必为正数，向上取整
+    int k = (int)dk;
+    unsigned index;
+
+    if (dk - k > 0.0) k++;
+    index = (unsigned)((k >> 3) + 1);
+    *K = -(-348 + (int)(index << 3));
+    return diyfp_make(cached_powers_f[index], cached_powers_e[index]);
+}
 
-    len = fmt ? 2 : 1;
-    ptr = ensure(p, len + 1);
-    if (!ptr) return NULL;
-    *ptr++ = '{';
-    if (fmt) *ptr++ = '\n'; *ptr = 0;     // 格式化输出，要换行
-    p->offset += len;
+static void grisu_round(char *buffer, int len, unsigned long long delta, unsigned long long rest,
+                        unsigned long long ten_kappa, unsigned long long wp_w)
+{
+    while (rest < wp_w && delta - rest >= ten_kappa &&
+           (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w)) {
+        buffer[len - 1]--;
+        rest += ten_kappa;
+    }
+}
 
-    child = item->child; depth++;
-    while (child) {
-        if (fmt) {
-            ptr = ensure(p, depth);
-            if (!ptr) return NULL;
-            for (j = 0; j < depth; j++) *ptr++ = '\t';
-            p->offset += depth;
+static int count_decimal_digit32(unsigned n)
+{
+    if (n < 10) return 1;
+    if (n < 100) return 2;
+    if (n < 1000) return 3;
+    if (n < 10000) return 4;
+    if (n < 100000) return 5;
+    if (n < 1000000) return 6;
+    if (n < 10000000) return 7;
+    if (n < 100000000) return 8;
+    return 9;   // digit_gen 中不会出现 10 位数
+}
+
+// 生成 [W-, W+] 区间内最短的十进制数字串
+static void digit_gen(diyfp W, diyfp Mp, unsigned long long delta, char *buffer, int *len, int *K)
+{
+    static const unsigned pow10_32[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+    const diyfp one = diyfp_make(1ULL << -Mp.e, Mp.e);
+    const unsigned long long wp_w = Mp.f - W.f;
+    unsigned p1 = (unsigned)(Mp.f >> -one.e);
+    unsigned long long p2 = Mp.f & (one.f - 1);
+    int kappa = count_decimal_digit32(p1);
+    *len = 0;
+
+    while (kappa > 0) {
+        unsigned long long tmp;
+        unsigned d = p1 / pow10_32[kappa - 1];
+        p1 %= pow10_32[kappa - 1];
+        if (d || *len) buffer[(*len)++] = (char)('0' + d);
+        kappa--;
+        tmp = ((unsigned long long)p1 << -one.e) + p2;
+        if (tmp <= delta) {
+            *K += kappa;
+            grisu_round(buffer, *len, delta, tmp, (unsigned long long)pow10_32[kappa] << -one.e, wp_w);
+            return;
         }
+    }
 
-        print_string_ptr(child->string, p);
-        p->offset = update(p);
+    for (;;) {  // kappa = 0
+        char d;
+        p2 *= 10;
+        delta *= 10;
+        d = (char)(p2 >> -one.e);
+        if (d || *len) buffer[(*len)++] = (char)('0' + d);
+        p2 &= one.f - 1;
+        kappa--;
+        if (p2 < delta) {
+            *K += kappa;
+            grisu_round(buffer, *len, delta, p2, one.f, wp_w * (-kappa < 9 ? pow10_32[-kappa] : 0));
+            return;
+        }
+    }
+}
 
-        ptr=ensure(p, 1);
-        if (!ptr) return NULL;
-        *ptr++ = ':';
-        p->offset++;
+// value 为正数，输出数字串 buffer[0, len)，value ≈ buffer * 10^K
+static void grisu2(double value, char *buffer, int *len, int *K)
+{
+    diyfp v = diyfp_from_double(value), w_m, w_p, c_mk, W, Wp, Wm;
+
+    diyfp_boundaries(v, &w_m, &w_p);
+    c_mk = cached_power(w_p.e, K);
+    W  = diyfp_mul(diyfp_normalize(v), c_mk);
+    Wp = diyfp_mul(w_p, c_mk);
+    Wm = diyfp_mul(w_m, c_mk);
+    Wm.f++;
+    Wp.f--;
+    digit_gen(W, Wp, Wp.f - Wm.f, buffer, len, K);
+}
 
-        out = print_value(child, depth, fmt, p);
-        p->offset = update(p);
+static char* write_exponent(int K, char *buffer)
+{
+    if (K < 0) { *buffer++ = '-'; K = -K; }
+    if (K >= 100) {
+        *buffer++ = (char)('0' + K / 100);
+        K %= 100;
+        *buffer++ = digits_lut[K * 2];
+        *buffer++ = digits_lut[K * 2 + 1];
+    }
+    else if (K >= 10) {
+        *buffer++ = digits_lut[K * 2];
+        *buffer++ = digits_lut[K * 2 + 1];
+    }
+    else *buffer++ = (char)('0' + K);
+    return buffer;
+}
 
-        // 判断是否有下一项
-        len = (fmt ? 1 : 0) + (child->next ? 1 : 0);
-        ptr=ensure(p, len + 1);
-        if (!ptr) return NULL;
-        if (child->next) *ptr++ =',';
-        if (fmt) *ptr++ ='\n';
-        *ptr = 0; p->offset += len;
+// 将数字串 buffer[0, length) * 10^k 整理为 json 数字格式，返回结尾指针
+static char* prettify(char *buffer, int length, int k)
+{
+    const int kk = length + k;  // 10^(kk-1) <= v < 10^kk
+    int i;
 
-        child = child->next;
+    if (0 <= k && kk <= 21) {
+        // 1234e7 -> 12340000000.0
+        for (i = length; i < kk; i++) buffer[i] = '0';
+        buffer[kk] = '.';
+        buffer[kk + 1] = '0';
+        return &buffer[kk + 2];
+    }
+    else if (0 < kk && kk <= 21) {
+        // 1234e-2 -> 12.34
+        memmove(&buffer[kk + 1], &buffer[kk], length - kk);
+        buffer[kk] = '.';
+        return &buffer[length + 1];
+    }
+    else if (-6 < kk && kk <= 0) {
+        // 1234e-6 -> 0.001234
+        const int offset = 2 - kk;
+        memmove(&buffer[offset], &buffer[0], length);
+        buffer[0] = '0';
+        buffer[1] = '.';
+        for (i = 2; i < offset; i++) buffer[i] = '0';
+        return &buffer[length + offset];
+    }
+    else if (length == 1) {
+        // 1e30
+        buffer[1] = 'e';
+        return write_exponent(kk - 1, &buffer[2]);
     }
+    else {
+        // 1234e30 -> 1.234e33
+        memmove(&buffer[2], &buffer[1], length - 1);
+        buffer[1] = '.';
+        buffer[length + 1] = 'e';
+        return write_exponent(kk - 1, &buffer[length + 2]);
+    }
+}
 
-    ptr = ensure(p, fmt ? (depth + 1) : 2);
-    if (!ptr) return NULL;
-    if (fmt) for(j = 0; j < depth - 1; j++) *ptr++ = '\t';
-    *ptr++ = '}'; *ptr = 0;
-    out = p->buffer + i;
+// 浮点数转最短的可往返十进制表示，value 必须是非零的有限值，buffer 至少 26 字节
+static char* dtoa(double value, char *buffer)
+{
+    int length, K;
+    if (value < 0) { *buffer++ = '-'; value = -value; }
+    grisu2(value, buffer, &length, &K);
+    return prettify(buffer, length, K);
+}
 
-    return out;
+// 输出 json 数字，out 为 NULL 时只计算长度
+// [-2^63, 2^63) 内的整数按 valueint64 精确输出，其余使用 Grisu2 输出最短的可往返表示，json 不支持的 NaN 和 Inf 输出为 null
+static size_t print_number(cJSON *item, char *out)
+{
+    char buffer[32], *end;
+    double d = item->valuedouble;
+
+    if (d != d || d - d != 0) end = buffer + 4, memcpy(buffer, "null", 4);
+    else if (d == 0) *buffer = '0', end = buffer + 1;
+    // 范围外的 valueint64 取边界值，而 (double)LLONG_MAX 等于 2^63，只比较相等会把 2^63 输出为 LLONG_MAX
+    else if (d >= -9223372036854775808.0 && d < 9223372036854775808.0 && (double)item->valueint64 == d) end = i64toa(item->valueint64, buffer);
+    else end = dtoa(d, buffer);
+
+    if (out) memcpy(out, buffer, end - buffer);
+    return end - buffer;
+}
+
+// 输出字符串时的转义表：0 表示不转义，'u' 表示输出为 \u00XX，其余为 '\\' 之后的字符
+static const char escape_table[128] = {
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'b', 't', 'n', 'u', 'f', 'r', 'u', 'u',
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+      0,   0, '"',   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,'\\',   0,   0,   0,
+};
+
+// 输出带引号的 json 字符串，转义引号、斜线和控制字符，out 为 NULL 时只计算长度
+// 需要转义的字符正好是 scan_unescaped 的停止字符，中间的普通字符成段拷贝
+static size_t print_string_ptr(const char *str, char *out)
+{
+    static const char hex[] = "0123456789abcdef";
+    const char *run;
+    size_t len = 1;
+    char c;
+
+    if (!str) str = "";
+    if (out) out[0] = '\"';
+
+    for (;;) {
+        run = scan_unescaped(str, NULL);
+        if (out) memcpy(out + len, str, run - str);
+        len += run - str;
+        if (!*run) break;
+
+        c = escape_table[(unsigned char)*run];
+        if (out) {
+            out[len] = '\\';
+            out[len + 1] = c;
+            if (c == 'u') {
+                out[len + 2] = '0';
+                out[len + 3] = '0';
+                out[len + 4] = hex[(unsigned char)*run >> 4];
+                out[len + 5] = hex[*run & 15];
+            }
+        }
+        len += c == 'u' ? 6 : 2;
+        str = run + 1;
+    }
+
+    if (out) out[len] = '\"';
+    return len + 1;
 }
 
-// 将 json 节点输出为 json 字符串
+// 写入 n 个字节，out 为 NULL 时只累加长度
+#define PRINT_BYTES(s, n)   do { if (out) memcpy(out + len, s, n); len += n; } while (0)
+#define PRINT_CHAR(c)       do { if (out) out[len] = (c); len++; } while (0)
+
+// 将 json 节点输出为 json 字符串，返回输出的长度，第一遍 out 为 NULL 只计算长度，第二遍写入
+// 使用显式栈代替递归：遇到非空的数组或对象时压栈，转而输出第一个成员；一个值输出完后
+// 根据栈顶容器输出逗号或结束符
 // @param item:  json 树结构的根节点
-// @param depth: 节点的深度
-// @param fmt:   是否带格式输出（缩进换行）
-// @param p:     是否输出到指定的 buffer
-// 这里为简便，只处理 p != NULL 的情况，避免频繁申请空间
-static char* print_value(cJSON *item, int depth, int fmt, printbuffer *p)
+// @param fmt:   是否带格式输出（缩进换行），对象成员按所在的深度缩进
+// @param out:   输出的 buffer，不写结束符
+static size_t print_value(cJSON *item, int fmt, char *out, const cJSON_Hooks *hooks)
 {
-    char *out = NULL;
-    if (!item) return NULL;
+    node_stack stack;
+    cJSON *parent = NULL;
+    size_t len = 0;
+    int depth = 0, is_object;
+
+    stack_init(&stack, hooks);
+    for (;;) {
+        // 对象成员先输出缩进和 key
+        if (depth && (parent->type & 255) == cJSON_Object) {
+            if (fmt) {
+                if (out) memset(out + len, '\t', depth);
+                len += depth;
+            }
+            len += print_string_ptr(item->string, out ? out + len : NULL);
+            PRINT_CHAR(':');
+        }
+
+        switch (item->type & 255) {
+            case cJSON_NULL:   PRINT_BYTES("null", 4); break;
+            case cJSON_False:  PRINT_BYTES("false", 5); break;
+            case cJSON_True:   PRINT_BYTES("true", 4); break;
+            case cJSON_Number: len += print_number(item, out ? out + len : NULL); break;
+            case cJSON_String: len += print_string_ptr(item->valuestring, out ? out + len : NULL); break;
+            case cJSON_Array:
+            case cJSON_Object:
+                is_object = (item->type & 255) == cJSON_Object;
+                if (!item->child) {     // 空数组或空对象
+                    PRINT_BYTES(is_object ? "{}" : "[]", 2);
+                    break;
+                }
+                PRINT_CHAR(is_object ? '{' : '[');
+                if (fmt && is_object) PRINT_CHAR('\n');  // 格式化输出，对象要换行
+                if (!stack_push(&stack, depth++, item)) { stack_free(&stack); return PRINT_FAILED; }
+                parent = item;
+                item = item->child;
+                continue;
+        }
 
-    switch (item->type & 255) {
-        case cJSON_NULL:   out = ensure(p, 5); if (out) strcpy(out, "null"); break;
-        case cJSON_False:  out = ensure(p, 6); if (out) strcpy(out, "false"); break;
-        case cJSON_True:   out = ensure(p, 5); if (out) strcpy(out, "true"); break;
-        case cJSON_Number: out = print_number(item, p); break;
-        case cJSON_String: out = print_string(item, p); break;
-        case cJSON_Array:  out = print_array(item, depth, fmt, p); break;
-        case cJSON_Object: out = print_object(item, depth, fmt, p); break;
+        // 当前值输出完成，依次结束最后一个成员已输出的容器，直到有下一个成员
+        for (;;) {
+            if (!depth) { stack_free(&stack); return len; }
+
+            parent = stack.items[depth - 1];
+            is_object = (parent->type & 255) == cJSON_Object;
+            if (item->next) {       // 逗号和分隔符
+                PRINT_CHAR(',');
+                if (fmt) PRINT_CHAR(is_object ? '\n' : ' ');
+                item = item->next;
+                break;
+            }
+            if (fmt && is_object) {
+                PRINT_CHAR('\n');
+                if (out) memset(out + len, '\t', depth - 1);
+                len += depth - 1;
+            }
+            PRINT_CHAR(is_object ? '}' : ']');
+            item = parent;
+            depth--;
+        }
     }
-    return out;
 }
 
-
 // 返回 cJSON 数组或对象的大小，即有多个个 next 指针
 int    cJSON_GetArraySize(cJSON *array)
 {
-    int i = 0;
-    cJSON *c = array->child;
-    while (c) i++, c = c->next;
-    return i;
+    return array->size;
 }
 
 // 返回指定下标的 cJSON 对象
 cJSON* cJSON_GetArrayItem(cJSON *array, int idx)
 {
     cJSON *c = array->child;
+    cJSON_Index *index = idx > 0 ? container_index(array) : NULL;
+
+    if (index) return idx < index->count ? index->items[idx] : NULL;
     while (c && idx > 0) idx--, c = c->next;
     return c;
 }
@@ -549,10 +1994,64 @@ cJSON* cJSON_GetArrayItem(cJSON *array, int idx)
 cJSON* cJSON_GetObjectItem(cJSON *object, const char *string)
 {
     cJSON *c = object->child;
+    cJSON_Index *index = string ? container_index(object) : NULL;
+
+    if (index && index->slots) return index_find(index, string, 0);
+
     while (c && cJSON_strcasecmp(c->string, string)) c = c->next;
     return c;
 }
 
+// 返回指定 key 值的 cJSON 对象，区分大小写，不需要逐字符 tolower
+cJSON* cJSON_GetObjectItemCaseSensitive(cJSON *object, const char *string)
+{
+    cJSON *c = object->child;
+    cJSON_Index *index;
+
+    if (!string) return NULL;
+    index = container_index(object);
+    if (index && index->slots) return index_find(index, string, 1);
+
+    while (c && (!c->string || strcmp(c->string, string))) c = c->next;
+    return c;
+}
+
+// 设置全局分配函数，为 NULL 时恢复 malloc/free
+void cJSON_InitHooks(cJSON_Hooks *hooks)
+{
+    global_hooks.malloc_fn = hooks && hooks->malloc_fn ? hooks->malloc_fn : malloc;
+    global_hooks.free_fn = hooks && hooks->free_fn ? hooks->free_fn : free;
+}
+
+// 初始化 context，各线程的 context 互相独立
+void cJSON_InitContext(cJSON_Context *context, const cJSON_Hooks *hooks)
+{
+    memset(context, 0, sizeof(*context));
+    context->hooks.malloc_fn = hooks && hooks->malloc_fn ? hooks->malloc_fn : malloc;
+    context->hooks.free_fn = hooks && hooks->free_fn ? hooks->free_fn : free;
+    context->nesting_limit = nesting_limit;
+}
+
+// 释放 context 的解码缓冲区
+void cJSON_FreeContext(cJSON_Context *context)
+{
+    if (context->scratch) context->hooks.free_fn(context->scratch);
+    context->scratch = NULL;
+    context->scratch_size = 0;
+}
+
+// 设置解析时允许的最大嵌套深度，不大于 0 时恢复默认值
+void cJSON_SetNestingLimit(int limit)
+{
+    nesting_limit = limit > 0 ? limit : CJSON_NESTING_LIMIT;
+}
+
+// 设置建立哈希索引的对象成员个数阈值，0 表示不建立
+void cJSON_SetIndexThreshold(int threshold)
+{
+    index_threshold = threshold > 0 ? threshold : 0;
+}
+
 // 若解析错误，获取错误处的指针
 const char* cJSON_GetErrorPtr(void)
 {
@@ -594,7 +2093,20 @@ cJSON* cJSON_CreateNumber(double num)
     if(item) {
         item->type = cJSON_Number;
         item->valuedouble = num;
-        item->valueint = (int)num;
+        item->valueint = number_to_int(num);
+        item->valueint64 = number_to_int64(num);
+    }
+    return item;
+}
+
+cJSON* cJSON_CreateInt64(long long num)
+{
+    cJSON *item=cJSON_New_Item();
+    if(item) {
+        item->type = cJSON_Number;
+        item->valuedouble = (double)num;
+        item->valueint = number_to_int((double)num);
+        item->valueint64 = num;
     }
     return item;
 }
@@ -640,6 +2152,7 @@ cJSON* cJSON_CreateIntArray(const int *numbers, int count)
         }
         p = n;
     }
+    if (item) { item->tail = p; item->size = i; }
     return item;
 }
 
@@ -659,6 +2172,7 @@ cJSON* cJSON_CreateFloatArray(const float *numbers, int count)
         }
         p = n;
     }
+    if (item) { item->tail = p; item->size = i; }
     return item;
 }
 
@@ -678,6 +2192,7 @@ cJSON* cJSON_CreateDoubleArray(const double *numbers, int count)
         }
         p = n;
     }
+    if (item) { item->tail = p; item->size = i; }
     return item;
 }
 
@@ -697,26 +2212,29 @@ cJSON* cJSON_CreateStringArray(const char **strings, int count)
         }
         p = n;
     }
+    if (item) { item->tail = p; item->size = i; }
     return item;
 }
 
 // 将 cJSON 节点添加到数组或对象中，对象要附上 key(string) 值
 void cJSON_AddItemToArray(cJSON *array, cJSON *item)
 {
-    cJSON *c = array->child;
     if (!item) return;
-    if (!c) array->child = item;    // 直接作为孩子节点
-    else {                          // 作为右子树节点
-        while (c && c->next) c = c->next;
-        c->next = item;
-        item->prev = c;
+    if (!array->child) array->child = item;     // 直接作为孩子节点
+    else {                                      // 接在最后一个孩子节点之后
+        array->tail->next = item;
+        item->prev = array->tail;
     }
+    array->tail = item;
+    array->size++;
+    index_append(array, item);
 }
 
 void cJSON_AddItemToObject(cJSON *object, const char *string, cJSON *item)
 {
     if (!item) return;
-    if (item->string) cJSON_free(item->string);     // 释放节点空间
+    if (!(item->type & cJSON_StringIsConst) && item->string) cJSON_free(item->string);  // 释放节点空间
     item->string = cJSON_strdup(string);
+    item->type &= ~cJSON_StringIsConst;             // 新的 key 归节点所有
     cJSON_AddItemToArray(object, item);
 }
@@ -25,37 +25,169 @@ extern "C" {
 #define cJSON_Array     5
 #define cJSON_Object    6
 
+// cJSON 标志位，与类型按位或保存在 type 中，判断类型时需使用 type & 255
+#define cJSON_IsArena       256     // 节点内存来自 arena，cJSON_Delete 不释放节点本身
+#define cJSON_StringIsConst 512     // string 不归节点所有，cJSON_Delete 不释放
+#define cJSON_ValueIsConst  1024    // valuestring 不归节点所有，cJSON_Delete 不释放
+#define cJSON_IsMapped      2048    // cJSON_ParseFile 原地解析的根节点，持有文件映射，cJSON_Delete 时解除
+
+// cJSON_ParseFile 的选项
+#define cJSON_FileInsitu    1       // 在文件的私有映射中原地解析，字符串直接指向映射，映射保留到 cJSON_Delete
+
+// 解析时允许的最大嵌套深度，超过时解析失败，可在编译时定义覆盖
+#ifndef CJSON_NESTING_LIMIT
+#define CJSON_NESTING_LIMIT 1000
+#endif
+
 // cJSON 结构体
 typedef struct cJSON {
     struct cJSON *next, *prev;      // 前向、后向指针，前一项、后一项 cJSON 对象
     struct cJSON *child;            // 若是 Array/Object，则为孩子节点指针
+    struct cJSON *tail;             // 若是 Array/Object，则为最后一个孩子节点，追加时不必遍历
+    int     size;                   // 若是 Array/Object，则为孩子节点个数。直接修改 child 链表后这两项不再可靠
 
     int     type;                   // 当前 cJSON 项的节点类型
     char*   valuestring;            // 当前 cJSON 项的字符串值, if type==cJSON_String
-    int     valueint;               // 当前 cJSON 项的整型数值, if type==cJSON_Number
+    int     valueint;               // 当前 cJSON 项的整型数值, if type==cJSON_Number，超出 int 范围时取边界值
     double  valuedouble;            // 当前 cJSON 项的浮点型数值, if type==cJSON_Number
+    long long valueint64;           // 当前 cJSON 项的 64 位整型数值, if type==cJSON_Number，整数可精确保存
 
     char*   string;                 // 当前 cJSON 项的名称
+    struct cJSON_Index *index;      // 若是 Array/Object，则为按下标/key 查找的索引，访问时按需建立
 
 } cJSON;
 
+// arena 内存块，块头之后即为可分配的数据区
+typedef struct cJSON_ArenaChunk {
+    struct cJSON_ArenaChunk *next;  // 下一块，链表头为当前正在分配的块
+    void    (*free_fn)(void *ptr);  // 释放本块的函数，与申请本块的分配函数对应
+    size_t  capacity;               // 数据区容量
+    size_t  size;                   // 数据区已使用的字节数
+} cJSON_ArenaChunk;
+
+// arena 分配器，参考 rapidjson 的 MemoryPoolAllocator：
+// 节点和字符串从大块内存中顺序切分，只能整体释放
+typedef struct cJSON_Arena {
+    cJSON_ArenaChunk *head;         // 当前块
+    size_t  chunk_capacity;         // 新块的默认容量
+} cJSON_Arena;
+
+// 内存分配函数，为 NULL 的成员使用标准库的 malloc/free
+typedef struct cJSON_Hooks {
+    void* (*malloc_fn)(size_t sz);
+    void  (*free_fn)(void *ptr);
+} cJSON_Hooks;
+
+// 解析和输出的上下文，保存分配函数、错误位置和字符串解码缓冲区，使用它的接口不读写全局状态。
+// 每个线程各用一个 context（可再各配一个 arena），即可无锁地并发解析；同一个 context 不能被多个线程同时使用
+typedef struct cJSON_Context {
+    cJSON_Hooks hooks;              // 节点、字符串、输出和临时空间的分配函数
+    cJSON_Arena *arena;             // 非空时节点和字符串从该 arena 中分配，arena 的块也由 hooks 申请
+    const char  *error;             // 最近一次解析失败的位置，成功时为 NULL
+    char    *scratch;               // 字符串解码缓冲区，在多次解析之间复用
+    size_t  scratch_size;
+    int     nesting_limit;          // 允许的最大嵌套深度，不大于 0 时为 CJSON_NESTING_LIMIT
+} cJSON_Context;
+
+// 事件驱动解析的回调，解析器每识别出一个 json 元素调用一次，返回 0 时终止解析。
+// 回调为 NULL 时忽略该事件。str 以 '\0' 结尾，只在回调期间有效；number 的 i 为整数的精确值，
+// 非整数时为 d 取整并限制在 long long 范围内；end 回调的 count 为成员个数
+typedef struct cJSON_Handler {
+    int (*null)(void *user_data);
+    int (*boolean)(void *user_data, int b);
+    int (*number)(void *user_data, double d, long long i);
+    int (*string)(void *user_data, const char *str, size_t len);
+    int (*start_object)(void *user_data);
+    int (*key)(void *user_data, const char *str, size_t len);
+    int (*end_object)(void *user_data, int count);
+    int (*start_array)(void *user_data);
+    int (*end_array)(void *user_data, int count);
+} cJSON_Handler;
+
 ///////////////////////////////////////////////////////////////////////////////
 // 解析一段 json 串，返回 cJSON 。完成后需要调用 cJSON_Delete 释放空间
 extern cJSON* cJSON_Parse(const char* value);
+// 解析一段 json 串，可返回解析结尾的指针，并可要求 json 串之后只能有空白字符
+extern cJSON* cJSON_ParseWithOpts(const char *value, const char **return_parse_end, int require_null_terminated);
 // 释放 cJSON 的空间
 extern void   cJSON_Delete(cJSON* c);
+// 事件驱动解析，不生成 cJSON 树，依次调用 handler 中的回调。与 cJSON_Parse 共用同一个解析器，
+// 可以在不分配节点的情况下过滤或统计数据。返回解析结尾的指针，语法错误或回调终止时返回 NULL
+extern const char* cJSON_ParseWithHandler(const char *value, const cJSON_Handler *handler, void *user_data);
+
+// 原地解析一段可写的 json 串，字符串在 json 中解码，valuestring 和 string 直接指向 json，不再分配。
+// 解析会改写 json 的内容，json 必须比返回的 cJSON 活得更久，仍需调用 cJSON_Delete 释放节点
+extern cJSON* cJSON_ParseInsitu(char *json);
+
+// 用 mmap 映射文件 path 并解析，不把文件读入内存再拷贝，文件中 json 值之后只能有空白字符（仅支持 POSIX 系统）。
+// flags 为 0 时字符串和不带文件时一样分配，返回前解除映射；为 cJSON_FileInsitu 时在写时复制的私有映射中原地解析，
+// 不改动文件，字符串不再分配，映射由根节点持有，直到 cJSON_Delete 释放根节点。
+// 失败时返回 NULL，错误位置已随映射解除，cJSON_GetErrorPtr 返回 NULL
+extern cJSON* cJSON_ParseFile(const char *path, int flags);
+
+// 初始化 arena，chunk_capacity 为每块的容量，为 0 时使用默认值 64KB
+extern void   cJSON_InitArena(cJSON_Arena *arena, size_t chunk_capacity);
+// 释放 arena 中的所有块，从该 arena 解析出的 cJSON 树随之失效
+extern void   cJSON_ClearArena(cJSON_Arena *arena);
+// 解析一段 json 串，节点和字符串都从 arena 中分配，返回的 cJSON 无需 cJSON_Delete，
+// 调用 cJSON_ClearArena 一次性释放。若向其中添加了 cJSON_Create* 创建的节点，仍需 cJSON_Delete
+extern cJSON* cJSON_ParseArena(const char *value, cJSON_Arena *arena);
+
+// 设置全局分配函数，hooks 为 NULL 时恢复 malloc/free。不带 context 的接口和 cJSON_Create* 使用
+extern void   cJSON_InitHooks(cJSON_Hooks *hooks);
+// 初始化 context，hooks 为 NULL 时使用 malloc/free，嵌套深度取当前的全局设置
+extern void   cJSON_InitContext(cJSON_Context *context, const cJSON_Hooks *hooks);
+// 释放 context 中的解码缓冲区，不影响已解析出的 cJSON 树和 arena
+extern void   cJSON_FreeContext(cJSON_Context *context);
+// 与 cJSON_ParseWithOpts 相同，但分配函数、嵌套深度和解码缓冲区取自 context，错误位置写入 context->error。
+// 结果需用 cJSON_DeleteWithContext 释放（arena 模式下随 cJSON_ClearArena 释放）
+extern cJSON* cJSON_ParseWithContext(cJSON_Context *context, const char *value, const char **return_parse_end,
+                                     int require_null_terminated);
+// 解析 value 开始的 length 字节，不要求以 '\0' 结尾，不读取范围之外的字节，可直接解析文件映射或网络缓冲区中的一段。
+// 其中的 '\0' 与 length 一样结束输入；require_null_terminated 要求值之后到结尾只有空白字符
+extern cJSON* cJSON_ParseWithLength(const char *value, size_t length);
+extern cJSON* cJSON_ParseWithLengthContext(cJSON_Context *context, const char *value, size_t length,
+                                           const char **return_parse_end, int require_null_terminated);
+// 用 context 的释放函数释放 cJSON 树。树中若有 cJSON_Create* 创建的节点，它们来自全局分配函数，不能混用
+extern void   cJSON_DeleteWithContext(cJSON_Context *context, cJSON *c);
+
+// 增量解析器：json 分多次送入（如 socket 每收到一段就送入一段），边接收边生成 cJSON 树，
+// 不需要先把完整的 json 串拼接出来
+typedef struct cJSON_Parser cJSON_Parser;
+// 创建增量解析器，context 为 NULL 时使用全局分配函数和嵌套深度，否则 context 的分配函数、arena、
+// 嵌套深度和解码缓冲区归解析器使用，直到 cJSON_ParserFinish
+extern cJSON_Parser* cJSON_ParserCreate(cJSON_Context *context);
+// 送入 len 字节，解析其中完整的部分。bytes 不需要以 '\0' 结尾，返回后即可复用，
+// 跨段的字符串、数字和字面量缓存在解析器中。出错时返回 0，之后的送入都被忽略
+extern int    cJSON_ParserFeed(cJSON_Parser *parser, const char *bytes, size_t len);
+// 结束输入并释放解析器，返回解析出的 cJSON，释放方式与 cJSON_ParseWithContext 的结果相同。
+// json 有错误或不完整时返回 NULL，error_offset 非空时写入出错处在整个输入中的字节偏移
+extern cJSON* cJSON_ParserFinish(cJSON_Parser *parser, size_t *error_offset);
 
 // 返回 cJSON 对象的输出字符串，带格式（缩进换行），使用完成后需要手动 free
 extern char*  cJSON_Print(cJSON* item);
 // 返回 cJSON 对象的输出字符串，不带格式（只有一行），使用完成后需要手动 free
 extern char*  cJSON_PrintUnformatted(cJSON* item);
+// 输出到调用者提供的 buffer 中，len 为 buffer 的大小（含结束符），fmt 是否带格式。
+// 不申请内存，空间不足时返回 0，成功返回 1
+extern int    cJSON_PrintPreallocated(cJSON *item, char *buf, int len, int fmt);
+// 输出 cJSON 对象，fmt 是否带格式，空间由 context 的分配函数申请，使用完成后用 context->hooks.free_fn 释放
+extern char*  cJSON_PrintWithContext(cJSON_Context *context, cJSON *item, int fmt);
 
 // 返回 cJSON 数组或对象的大小，即有多个个 next 指针
 extern int    cJSON_GetArraySize(cJSON *array);
-// 返回指定下标的 cJSON 对象
+// 返回指定下标的 cJSON 对象，建立索引后为 O(1)
 extern cJSON* cJSON_GetArrayItem(cJSON *array, int idx);
 // 返回指定 key 值的 cJSON 对象，忽略大小写
 extern cJSON* cJSON_GetObjectItem(cJSON *object, const char *string);
+// 返回指定 key 值的 cJSON 对象，区分大小写
+extern cJSON* cJSON_GetObjectItemCaseSensitive(cJSON *object, const char *string);
+// 数组或对象的成员个数达到 threshold 时，首次按下标或 key 查找会为其建立索引（连续的数组视图
+// 和 key 的哈希表），之后查找为 O(1)；0 表示不建立索引（默认）。arena 模式下索引在解析时从 arena 中分配
+extern void   cJSON_SetIndexThreshold(int threshold);
+// 设置解析时允许的最大嵌套深度，不大于 0 时恢复默认值 CJSON_NESTING_LIMIT。
+// 解析、输出和 cJSON_Delete 都使用显式栈，不会因嵌套过深导致栈溢出
+extern void   cJSON_SetNestingLimit(int limit);
 
 // 若解析错误，获取错误处的指针
 extern const char* cJSON_GetErrorPtr(void);
@@ -66,6 +198,7 @@ extern cJSON* cJSON_CreateTrue(void);
 extern cJSON* cJSON_CreateFalse(void);
 extern cJSON* cJSON_CreateBool(int b);
 extern cJSON* cJSON_CreateNumber(double num);
+extern cJSON* cJSON_CreateInt64(long long num);
 extern cJSON* cJSON_CreateString(const char *string);
 extern cJSON* cJSON_CreateArray(void);
 extern cJSON* cJSON_CreateObject(void);
@@ -11,6 +11,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "cjson.h"
 
 int parse_json_pirnt(char* json, int fmt)
@@ -35,6 +36,195 @@ int parse_json_pirnt(char* json, int fmt)
     return 0;
 }
 
+// 解析后不带格式输出，与期望的结果比较
+int print_json_expect(const char* json, const char* expect)
+{
+    char *out;
+    int ret;
+    cJSON* c = cJSON_Parse(json);
+    if (!c) {
+        printf("cJSON_Parse return null, error: %s\n", cJSON_GetErrorPtr());
+        return -1;
+    }
+
+    out = cJSON_PrintUnformatted(c);
+    ret = strcmp(out, expect) ? -1 : 0;
+    printf("%s: %s -> %s\n", ret ? "FAIL" : "ok", json, out);
+    free(out);
+    cJSON_Delete(c);
+
+    return ret;
+}
+
+// 使用 arena 解析，解析出的树无需 cJSON_Delete，由 cJSON_ClearArena 整体释放
+int parse_json_arena(char* json, cJSON_Arena* arena)
+{
+    char *out;
+    cJSON* c = cJSON_ParseArena(json, arena);
+    if (!c) {
+        printf("cJSON_ParseArena return null, error: %s\n", cJSON_GetErrorPtr());
+        return -1;
+    }
+
+    printf("cjson arena test: %d\n", c->type & 255);
+
+    out = cJSON_PrintUnformatted(c);
+    printf("cjson: \n%s\n", out);
+    free(out);
+
+    return 0;
+}
+
+// 原地解析，字符串直接解码在 json 中，json 的内容会被改写，这里在副本上解析
+int parse_json_insitu(const char* json)
+{
+    char *out, *buf = (char*)malloc(strlen(json) + 1);
+    cJSON* c;
+
+    strcpy(buf, json);
+    c = cJSON_ParseInsitu(buf);
+    if (!c) {
+        printf("cJSON_ParseInsitu return null, error: %s\n", cJSON_GetErrorPtr());
+        free(buf);
+        return -1;
+    }
+
+    out = cJSON_PrintUnformatted(c);
+    printf("cjson: \n%s\n", out);
+    free(out);
+
+    cJSON_Delete(c);    // 先释放节点，再释放 json buffer
+    free(buf);
+    return 0;
+}
+
+// 事件驱动解析的回调：统计数字个数并求和，不生成 cJSON 树
+typedef struct { int count; double sum; } number_stat;
+
+static int on_number(void *user_data, double d, long long i)
+{
+    number_stat *stat = (number_stat*)user_data;
+    (void)i;
+    stat->count++;
+    stat->sum += d;
+    return 1;
+}
+
+int parse_json_handler(const char* json)
+{
+    cJSON_Handler handler;
+    number_stat stat = { 0, 0 };
+
+    memset(&handler, 0, sizeof(handler));   // 未设置的回调忽略对应的事件
+    handler.number = on_number;
+    if (!cJSON_ParseWithHandler(json, &handler, &stat)) {
+        printf("cJSON_ParseWithHandler return null, error: %s\n", cJSON_GetErrorPtr());
+        return -1;
+    }
+
+    printf("numbers: %d, sum: %g\n", stat.count, stat.sum);
+    return 0;
+}
+
+// 使用 context 解析和输出，错误位置保存在 context 中，不依赖全局状态，可在多个线程中各用一个 context
+int parse_json_context(cJSON_Context* context, const char* json)
+{
+    char  *out;
+    cJSON *c = cJSON_ParseWithContext(context, json, NULL, 1);
+    if (!c) {
+        printf("cJSON_ParseWithContext return null, error: %s\n", context->error);
+        return -1;
+    }
+
+    out = cJSON_PrintWithContext(context, c, 0);
+    printf("%s\n", out);
+    context->hooks.free_fn(out);
+    cJSON_DeleteWithContext(context, c);
+    return 0;
+}
+
+// 增量解析：模拟从 socket 分段收到 json，每次送入 chunk 字节，边收边解析
+int parse_json_push(const char* json, size_t chunk)
+{
+    size_t len = strlen(json), i, error_offset;
+    char  *out;
+    cJSON *c;
+    cJSON_Parser *parser = cJSON_ParserCreate(NULL);
+
+    for (i = 0; i < len; i += chunk)
+        cJSON_ParserFeed(parser, json + i, len - i < chunk ? len - i : chunk);
+    c = cJSON_ParserFinish(parser, &error_offset);
+    if (!c) {
+        printf("cJSON_ParserFinish return null, error at offset %zu: %s\n", error_offset, json + error_offset);
+        return -1;
+    }
+
+    out = cJSON_PrintUnformatted(c);
+    printf("%s\n", out);
+    free(out);
+    cJSON_Delete(c);
+    return 0;
+}
+
+// 增量解析：按给定的分段送入（可以有空的分段），结果与期望的输出比较
+int parse_json_chunks(const char* chunks[], const char* expect)
+{
+    size_t error_offset;
+    char  *out;
+    cJSON *c;
+    cJSON_Parser *parser = cJSON_ParserCreate(NULL);
+    int ret;
+
+    for (; *chunks; chunks++) cJSON_ParserFeed(parser, *chunks, strlen(*chunks));
+    c = cJSON_ParserFinish(parser, &error_offset);
+    if (!c) {
+        printf("FAIL: cJSON_ParserFinish return null, error at offset %zu\n", error_offset);
+        return -1;
+    }
+
+    out = cJSON_PrintUnformatted(c);
+    ret = strcmp(out, expect) ? -1 : 0;
+    printf("%s: %s\n", ret ? "FAIL" : "ok", out);
+    free(out);
+    cJSON_Delete(c);
+    return ret;
+}
+
+int parse_json_length(const char* json, size_t length)
+{
+    char  *out;
+    cJSON *c = cJSON_ParseWithLength(json, length);
+
+    if (!c) {
+        printf("cJSON_ParseWithLength return null, error at offset %zu\n", (size_t)(cJSON_GetErrorPtr() - json));
+        return -1;
+    }
+
+    out = cJSON_PrintUnformatted(c);
+    printf("%s\n", out);
+    free(out);
+    cJSON_Delete(c);
+    return 0;
+}
+
+// 映射文件解析，flags 为 cJSON_FileInsitu 时字符串直接指向文件映射
+int parse_json_file(const char* path, int flags)
+{
+    char  *out;
+    cJSON *c = cJSON_ParseFile(path, flags);
+
+    if (!c) {
+        printf("cJSON_ParseFile return null: %s\n", path);
+        return -1;
+    }
+
+    out = cJSON_PrintUnformatted(c);
+    printf("%s\n", out);
+    free(out);
+    cJSON_Delete(c);
+    return 0;
+}
+
 int get_json_value(char* json)
 {
     int   i, sz = 0;
@@ -72,6 +262,12 @@ int get_json_value(char* json)
             printf("name: %s\n", out);
             free(out);
         }
+        item = cJSON_GetObjectItemCaseSensitive(c, "format");
+        if (item) {
+            out = cJSON_PrintUnformatted(item);
+            printf("format: %s\n", out);
+            free(out);
+        }
     }
 
     cJSON_Delete(c);
@@ -161,6 +357,8 @@ void create_json_objects()
 
 int main(int argc, char *argv[])
 {
+    cJSON_Arena arena;
+    cJSON_Context context;
     char text1[]="{\n\"name\": \"Jack (\\\"Bee\\\") Nimble\", \n\"format\": {\"type\":       \"rect\", \n\"width\":      1920, \n\"height\":     1080, \n\"interlace\":  false,\"frame rate\": 24\n}\n}";   
     char text2[]="[\"Sunday\", \"Monday\", \"Tuesday\", \"Wednesday\", \"Thursday\", \"Friday\", \"Saturday\"]";
     char text3[]="[\n    [0, -1, 0],\n    [1, 0, 0],\n    [0, 0, 1]\n   ]\n";
@@ -183,7 +381,56 @@ int main(int argc, char *argv[])
     parse_json_pirnt(text4, 0);
     parse_json_pirnt(text5, 0);
 
+    printf("\n****** print_json_expect ******\n");
+    print_json_expect("[9223372036854774784, -9223372036854775808]", "[9223372036854774784,-9223372036854775808]");
+    print_json_expect("[9223372036854775808, -9223372036854775809]", "[9223372036854776000.0,-9223372036854775808]");  // 2^63 超出 long long，-2^63-1 舍入为 -2^63
+
+    printf("\n****** parse_json_arena ******\n");
+    cJSON_InitArena(&arena, 0);
+    parse_json_arena(text1, &arena);
+    parse_json_arena(text4, &arena);
+    parse_json_arena(text5, &arena);
+    cJSON_ClearArena(&arena);
+
+    printf("\n****** parse_json_insitu ******\n");
+    parse_json_insitu(text1);
+    parse_json_insitu(text4);
+    parse_json_insitu("[\"\\u4e2d\\u6587\", \"tab\\tquote\\\"\"]");
+
+    printf("\n****** parse_json_handler ******\n");
+    parse_json_handler(text3);
+    parse_json_handler(text4);
+    parse_json_handler(text5);
+
+    printf("\n****** parse_json_context ******\n");
+    cJSON_InitContext(&context, NULL);
+    parse_json_context(&context, text2);
+    parse_json_context(&context, "[1, 2] 3");   // 要求 json 之后只有空白字符
+    cJSON_FreeContext(&context);
+
+    printf("\n****** parse_json_push ******\n");
+    parse_json_push(text1, 7);
+    parse_json_push(text5, 1);
+    parse_json_push("{\"name\": \"mayw\", \"age\": 2", 4);  // 输入结束时对象尚未闭合
+    {
+        const char *escape[] = { "[\"a\\", "", "\"b\"]", NULL };             // 转义的反斜杠之后是空的分段
+        const char *quote[] = { "[\"a\\\"", "", "\\", "", "\\\"]", NULL };  // 转义的引号和反斜杠各自跨越分段
+        parse_json_chunks(escape, "[\"a\\\"b\"]");
+        parse_json_chunks(quote, "[\"a\\\"\\\\\"]");
+    }
+
+    printf("\n****** parse_json_length ******\n");
+    parse_json_length("{\"a\": [1, 2], \"b\": 3.5}{\"next\": 1}", 23);    // 只解析前一个对象
+    parse_json_length("12345", 3);
+    parse_json_length("[1, 2, 3]", 5);      // 截断的数组
+
+    printf("\n****** parse_json_file ******\n");
+    parse_json_file("jsonfile/test2.json", 0);
+    parse_json_file("jsonfile/test2.json", cJSON_FileInsitu);
+    parse_json_file("jsonfile/none.json", 0);
+
     printf("\n****** get_json_value ******\n");
+    cJSON_SetIndexThreshold(4);     // 成员不少于 4 个的对象按 key 查找时使用哈希索引
     get_json_value("[\"age\", 2]");
     get_json_value("{\"name\" : \"mayw\", \"age\" : 21}");
     get_json_value(text1);
@@ -191,6 +438,7 @@ int main(int argc, char *argv[])
     get_json_value(text3);
     get_json_value(text4);
     get_json_value(text5);
+    get_json_value("{\"Format\" : 1, \"FORMAT\" : 2, \"format\" : 3, \"name\" : 4}");  // 区分大小写查找 format 得到 3
 
     printf("\n****** create_json_objects ******\n");
     create_json_objects();
@@ -0,0 +1,260 @@
+/**********************************************************
+ * desc: cjson_lite、cJSON 和 rapidjson 性能对比测试
+ * file: json_bench.cpp
+ *
+ * 三个引擎使用同一份源码，编译时用宏选择其一：
+ *   BENCH_CJSON_LITE / BENCH_CJSON / BENCH_RAPIDJSON，BENCH_CJSON 同时定义 CJSON_COMPACT 时测试 cJSON 的紧凑节点布局
+ * cjson_lite 和 cJSON 的导出符号同名，不能链接到同一个程序中，因此每个引擎单独生成一个程序，
+ * 由 makefile 的 bench 目标依次运行，输入文件相同。
+ * 定义 BENCH_WRAP_MALLOC 并以 -Wl,--wrap=malloc,... 链接时统计每次解析的分配次数和堆峰值。
+ *
+ * 用法: bench_xxx [-t 秒] file1.json file2.json ...
+ *********************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <sys/resource.h>
+
+#if defined(BENCH_CJSON_LITE)
+#include "cjson.h"
+#define BENCH_ENGINE "cjson_lite"
+#elif defined(BENCH_CJSON)
+#include "cJSON.h"
+#if defined(CJSON_COMPACT)
+#define BENCH_ENGINE "cJSON/cmp"    // cJSON 紧凑节点布局
+#else
+#define BENCH_ENGINE "cJSON"
+#endif
+#elif defined(BENCH_RAPIDJSON)
+#include "rapidjson/document.h"
+#include "rapidjson/writer.h"
+#include "rapidjson/prettywriter.h"
+#include "rapidjson/stringbuffer.h"
+#define BENCH_ENGINE "rapidjson"
+#else
+#error "define one of BENCH_CJSON_LITE, BENCH_CJSON, BENCH_RAPIDJSON"
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+// 分配统计：链接时用 --wrap 将 malloc/calloc/realloc/free 转到这里
+
+static size_t alloc_count = 0;     // 分配次数
+static size_t live_bytes  = 0;     // 当前占用的堆空间
+static size_t peak_bytes  = 0;     // 堆空间峰值
+
+#if defined(BENCH_WRAP_MALLOC)
+#include <malloc.h>     // malloc_usable_size
+
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t n, size_t size);
+void* __real_realloc(void *ptr, size_t size);
+void  __real_free(void *ptr);
+
+static void note_alloc(void *ptr)
+{
+    alloc_count++;
+    live_bytes += malloc_usable_size(ptr);
+    if (live_bytes > peak_bytes) peak_bytes = live_bytes;
+}
+
+void* __wrap_malloc(size_t size)
+{
+    void *ptr = __real_malloc(size);
+    if (ptr) note_alloc(ptr);
+    return ptr;
+}
+
+void* __wrap_calloc(size_t n, size_t size)
+{
+    void *ptr = __real_calloc(n, size);
+    if (ptr) note_alloc(ptr);
+    return ptr;
+}
+
+void* __wrap_realloc(void *ptr, size_t size)
+{
+    if (ptr) live_bytes -= malloc_usable_size(ptr);
+    ptr = __real_realloc(ptr, size);
+    if (ptr) note_alloc(ptr);
+    return ptr;
+}
+
+void __wrap_free(void *ptr)
+{
+    if (ptr) live_bytes -= malloc_usable_size(ptr);
+    __real_free(ptr);
+}
+}
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+// 各引擎的解析、输出、遍历和释放
+
+#if defined(BENCH_RAPIDJSON)
+typedef rapidjson::Document bench_doc;
+
+static bench_doc* bench_parse(const char *json)
+{
+    bench_doc *d = new bench_doc;
+    if (d->Parse(json).HasParseError()) { delete d; return NULL; }
+    return d;
+}
+
+static void bench_free(bench_doc *d) { delete d; }
+
+static size_t bench_stringify(bench_doc *d, int pretty)
+{
+    rapidjson::StringBuffer buffer;
+    if (pretty) {
+        rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+        d->Accept(writer);
+    }
+    else {
+        rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+        d->Accept(writer);
+    }
+    return buffer.GetSize();
+}
+
+// 遍历所有节点，返回节点数，数字和字符串长度累加到 sum 中，避免被优化掉
+static size_t traverse(const rapidjson::Value &v, double &sum)
+{
+    size_t n = 1;
+    if (v.IsObject()) {
+        for (rapidjson::Value::ConstMemberIterator m = v.MemberBegin(); m != v.MemberEnd(); ++m) {
+            sum += m->name.GetStringLength();
+            n += traverse(m->value, sum);
+        }
+    }
+    else if (v.IsArray()) {
+        for (rapidjson::Value::ConstValueIterator e = v.Begin(); e != v.End(); ++e) n += traverse(*e, sum);
+    }
+    else if (v.IsNumber()) sum += v.GetDouble();
+    else if (v.IsString()) sum += v.GetStringLength();
+    return n;
+}
+
+static size_t bench_traverse(bench_doc *d, double &sum) { return traverse(*d, sum); }
+#else
+typedef cJSON bench_doc;
+
+static bench_doc* bench_parse(const char *json) { return cJSON_Parse(json); }
+
+static void bench_free(bench_doc *d) { cJSON_Delete(d); }
+
+static size_t bench_stringify(bench_doc *d, int pretty)
+{
+    char *out = pretty ? cJSON_Print(d) : cJSON_PrintUnformatted(d);
+    size_t len = out ? strlen(out) : 0;
+    free(out);
+    return len;
+}
+
+static size_t traverse(const cJSON *item, double &sum)
+{
+    size_t n = 1;
+    const cJSON *child;
+    for (child = item->child; child; child = child->next) {
+        if (child->string) sum += strlen(child->string);
+        n += traverse(child, sum);
+    }
+    if ((item->type & 255) == cJSON_Number) sum += item->valuedouble;
+    else if ((item->type & 255) == cJSON_String) sum += strlen(item->valuestring);
+    return n;
+}
+
+static size_t bench_traverse(bench_doc *d, double &sum) { return traverse(d, sum); }
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+
+static double min_seconds = 0.3;    // 每项测试至少运行的时间
+static volatile double traverse_sink;   // 保存遍历结果，避免遍历被优化掉
+
+static double now()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 重复执行 f 至少 min_seconds 秒，返回按 bytes 计算的吞吐量 MB/s
+template <typename F>
+static double measure(F f, size_t bytes)
+{
+    size_t iterations = 0;
+    double start = now(), elapsed;
+    do {
+        f();
+        iterations++;
+    } while ((elapsed = now() - start) < min_seconds);
+    return bytes * iterations / elapsed / (1024.0 * 1024.0);
+}
+
+static bool read_file(const char *path, std::string &out)
+{
+    FILE *fp = fopen(path, "rb");
+    char buffer[4096];
+    size_t n;
+
+    if (!fp) return false;
+    out.clear();
+    while ((n = fread(buffer, 1, sizeof(buffer), fp)) > 0) out.append(buffer, n);
+    fclose(fp);
+    return true;
+}
+
+static void bench_file(const char *path)
+{
+    std::string json;
+    bench_doc *d;
+    const char *name = strrchr(path, '/') ? strrchr(path, '/') + 1 : path;
+    double parse, stringify, pretty, walk, sum = 0;
+    size_t allocs, peak, base;
+
+    if (!read_file(path, json)) { printf("%-10s %-18s cannot read file\n", BENCH_ENGINE, name); return; }
+
+    // 单次解析的分配次数和堆峰值（相对解析前的占用）
+    alloc_count = 0;
+    base = peak_bytes = live_bytes;
+    d = bench_parse(json.c_str());
+    allocs = alloc_count;
+    peak = peak_bytes - base;
+    if (!d) { printf("%-10s %-18s parse error\n", BENCH_ENGINE, name); return; }
+    bench_free(d);
+
+    parse = measure([&]() { bench_free(bench_parse(json.c_str())); }, json.size());
+
+    d = bench_parse(json.c_str());
+    stringify = measure([&]() { bench_stringify(d, 0); }, json.size());
+    pretty    = measure([&]() { bench_stringify(d, 1); }, json.size());
+    walk      = measure([&]() { bench_traverse(d, sum); }, json.size());
+    bench_free(d);
+
+    printf("%-10s %-18s %9.1f %9.1f %9.1f %9.1f %9.1f %10zu %10.1f\n", BENCH_ENGINE, name,
+           json.size() / 1024.0, parse, stringify, pretty, walk, allocs, peak / 1024.0);
+    traverse_sink = sum;
+}
+
+int main(int argc, char *argv[])
+{
+    struct rusage usage;
+    int i = 1;
+
+    if (argc > 2 && !strcmp(argv[1], "-t")) { min_seconds = atof(argv[2]); i = 3; }
+    if (i >= argc) {
+        printf("usage: %s [-t seconds] file1.json file2.json ...\n", argv[0]);
+        return 1;
+    }
+
+    printf("%-10s %-18s %9s %9s %9s %9s %9s %10s %10s\n", "engine", "file", "size(KB)",
+           "parse", "stringify", "pretty", "traverse", "allocs", "heap(KB)");
+    for (; i < argc; i++) bench_file(argv[i]);
+
+    getrusage(RUSAGE_SELF, &usage);
+    printf("%-10s peak RSS %ld KB (throughput in MB/s of input json; allocs and heap per parse)\n",
+           BENCH_ENGINE, usage.ru_maxrss);
+    return 0;
+}
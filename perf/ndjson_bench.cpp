@@ -0,0 +1,177 @@
+/**********************************************************
+ * desc: cJSON_ParseBatch 多线程解析 NDJSON 的性能测试
+ * file: ndjson_bench.cpp
+ *
+ * 用 -g 生成指定大小（MB）的 NDJSON 文件，之后按 64MB 一段（在换行处切分）依次读入并交给
+ * cJSON_ParseBatch，线程数从 1 开始每次翻倍直到 CPU 核数（或 -t 指定的上限），
+ * 输出每种线程数的吞吐量和相对单线程的加速比，第一行是逐行调用 cJSON_Parse 的基准。
+ * 每项测试运行 3 遍取最快的一遍，排除首次向系统申请堆页面等一次性开销，计时不含读文件。
+ * 同一时刻只有一段文本和它解析出的 DOM 在内存中，内存占用与文件大小无关，可以测试数 GB 的文件。
+ * 加速比取决于 CPU 核数，单核机器上只能看到多线程的额外开销，不能当作扩展性的结果。
+ *
+ * 用法: ndjson_bench [-g MB] [-t 最大线程数] file.ndjson
+ *********************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "cJSON.h"
+
+static const size_t window_size = 64 << 20;    // 每次交给 cJSON_ParseBatch 的数据量
+static const int repeat = 3;                    // 每项测试的运行次数，取最短的耗时
+
+static double now()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 生成 mb 兆字节的 NDJSON，每行一个结构相同、内容不同的对象
+static bool generate(const char *path, size_t mb)
+{
+    static const char *cities[] = { "SAN FRANCISCO", "SUNNYVALE", "Beijing", "M\\u00fcnchen", "Paris" };
+    FILE *fp = fopen(path, "wb");
+    size_t bytes = 0, limit = mb << 20;
+    long i;
+
+    if (!fp) return false;
+    for (i = 0; bytes < limit; i++) {
+        int n = fprintf(fp, "{\"id\":%ld,\"name\":\"user_%ld\",\"score\":%.3f,\"active\":%s,"
+                        "\"tags\":[\"t%ld\",\"t%ld\",null],\"address\":{\"city\":\"%s\",\"zip\":\"%05ld\","
+                        "\"geo\":[%.6f,%.6f]},\"note\":\"line \\\"%ld\\\"\\n\"}\n",
+                        i, i, i * 0.37, i % 3 ? "true" : "false", i % 17, i % 101, cities[i % 5],
+                        i % 100000, 37.0 + i % 1000 / 1000.0, -122.0 - i % 997 / 997.0, i);
+        if (n < 0) { fclose(fp); return false; }
+        bytes += n;
+    }
+    fclose(fp);
+    printf("generated %s: %.1f MB, %ld records\n", path, bytes / 1048576.0, i);
+    return true;
+}
+
+// 文件大小（字节），打不开时返回 -1
+static long file_size(const char *path)
+{
+    FILE *fp = fopen(path, "rb");
+    long size;
+
+    if (!fp) return -1;
+    fseek(fp, 0, SEEK_END);
+    size = ftell(fp);
+    fclose(fp);
+    return size;
+}
+
+// 每次读入 window_size 字节，在最后一个换行处切分，对每段调用 f(段首, 段尾)，段尾是结束符。
+// 段尾之后不完整的一行留到下一段开头，一行比一段还长时继续读到它的换行为止。读文件出错时退出。
+template <typename F>
+static void for_each_window(const char *path, F f)
+{
+    FILE *fp = fopen(path, "rb");
+    std::vector<char> buffer;
+    size_t carry = 0, size, end;
+    bool eof = false;
+    char saved;
+
+    if (!fp) { printf("cannot read %s\n", path); exit(1); }
+    while (!eof) {
+        buffer.resize(carry + window_size + 1);
+        size = carry + fread(&buffer[carry], 1, window_size, fp);
+        if (ferror(fp)) { printf("cannot read %s\n", path); exit(1); }
+        eof = size < carry + window_size;
+        for (end = size; !eof && end > 0 && buffer[end - 1] != '\n'; end--) ;
+        if (end == 0 && !eof) { carry = size; continue; }
+        saved = buffer[end];
+        buffer[end] = 0;
+        if (end > 0) f(&buffer[0], &buffer[end]);
+        buffer[end] = saved;
+        carry = size - end;
+        memmove(&buffer[0], &buffer[end], carry);
+    }
+    fclose(fp);
+}
+
+// 单线程逐行 cJSON_Parse 的基准，返回解析耗时（秒），不计释放时间
+static double parse_lines(const char *path, long &records, long &failed)
+{
+    double elapsed = 0;
+    records = failed = 0;
+    for_each_window(path, [&](char *begin, char *end) {
+        std::vector<cJSON*> roots;
+        double start = now();
+        for (char *line = begin, *eol; line < end; line = eol + 1) {
+            eol = (char*)memchr(line, '\n', end - line);
+            if (!eol) eol = end;
+            char saved = *eol;
+            *eol = 0;
+            if (eol > line) {
+                cJSON *root = cJSON_Parse(line);
+                if (root) roots.push_back(root); else failed++;
+                records++;
+            }
+            *eol = saved;
+        }
+        elapsed += now() - start;
+        for (size_t i = 0; i < roots.size(); i++) cJSON_Delete(roots[i]);
+    });
+    return elapsed;
+}
+
+// 用 threads 个线程分段调用 cJSON_ParseBatch，返回解析耗时（秒），不计释放时间
+static double parse_batches(const char *path, int threads, long &records, long &failed)
+{
+    double elapsed = 0;
+    records = failed = 0;
+    for_each_window(path, [&](char *begin, char *) {
+        cJSON **roots;
+        double start = now();
+        int n = cJSON_ParseBatch(begin, threads, &roots);
+        elapsed += now() - start;
+        if (n < 0) { failed = -1; return; }
+        for (int i = 0; i < n; i++) if (!roots[i]) failed++;
+        records += n;
+        cJSON_DeleteBatch(roots, n);
+    });
+    return elapsed;
+}
+
+int main(int argc, char *argv[])
+{
+    long records, failed, size;
+    int max_threads = (int)sysconf(_SC_NPROCESSORS_ONLN), i = 1, threads;
+    size_t generate_mb = 0;
+    double base, elapsed, mb;
+
+    for (; i + 1 < argc && argv[i][0] == '-'; i += 2) {
+        if (!strcmp(argv[i], "-g")) generate_mb = strtoul(argv[i + 1], NULL, 10);
+        else if (!strcmp(argv[i], "-t")) max_threads = atoi(argv[i + 1]);
+    }
+    if (i >= argc || max_threads < 1) {
+        printf("usage: %s [-g MB] [-t max_threads] file.ndjson\n", argv[0]);
+        return 1;
+    }
+    if (generate_mb && !generate(argv[i], generate_mb)) { printf("cannot write %s\n", argv[i]); return 1; }
+    if ((size = file_size(argv[i])) < 0) { printf("cannot read %s\n", argv[i]); return 1; }
+    mb = size / 1048576.0;
+
+    printf("%-22s %10s %10s %10s %10s %8s\n", "mode", "records", "failed", "seconds", "MB/s", "speedup");
+    base = parse_lines(argv[i], records, failed);
+    for (int r = 1; r < repeat; r++) base = std::min(base, parse_lines(argv[i], records, failed));
+    printf("%-22s %10ld %10ld %10.2f %10.1f %8.2f\n", "cJSON_Parse per line", records, failed, base, mb / base, 1.0);
+
+    for (threads = 1; ; threads = threads * 2 < max_threads ? threads * 2 : max_threads) {
+        char mode[32];
+        elapsed = parse_batches(argv[i], threads, records, failed);
+        for (int r = 1; r < repeat; r++) elapsed = std::min(elapsed, parse_batches(argv[i], threads, records, failed));
+        snprintf(mode, sizeof(mode), "ParseBatch %d thread%s", threads, threads > 1 ? "s" : "");
+        printf("%-22s %10ld %10ld %10.2f %10.1f %8.2f\n", mode, records, failed, elapsed, mb / elapsed, base / elapsed);
+        if (threads >= max_threads) break;
+    }
+    printf("%.1f MB, %d online CPUs (speedup relative to cJSON_Parse per line)\n", mb,
+           (int)sysconf(_SC_NPROCESSORS_ONLN));
+    return 0;
+}
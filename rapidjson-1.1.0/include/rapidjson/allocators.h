@@ -224,6 +224,26 @@ public:
     //! Frees a memory block (concept Allocator)
     static void Free(void *ptr) { (void)ptr; } // Do nothing
 
+    //! Takes over the memory chunks of another allocator.
+    /*! Memory blocks allocated by \c rhs stay valid, and are deallocated with this allocator.
+        The user-supplied buffer of \c rhs, if any, is not taken.
+        \param rhs Allocator to take the chunks from. It is empty afterwards.
+        \note The base allocators must be able to free each other's chunks, as CrtAllocator can.
+    */
+    void Splice(MemoryPoolAllocator& rhs) {
+        ChunkHeader* tail = 0;
+        for (ChunkHeader* c = rhs.chunkHead_; c != 0 && c != rhs.userBuffer_; c = c->next)
+            tail = c;
+        if (!tail)
+            return;
+        if (!baseAllocator_)
+            ownBaseAllocator_ = baseAllocator_ = RAPIDJSON_NEW(BaseAllocator());
+        ChunkHeader* head = rhs.chunkHead_;
+        rhs.chunkHead_ = tail->next;
+        tail->next = chunkHead_;
+        chunkHead_ = head;
+    }
+
 private:
     //! Copy constructor is not permitted.
     MemoryPoolAllocator(const MemoryPoolAllocator& rhs) /* = delete */;
@@ -61,6 +61,9 @@ class GenericValue;
 template <typename Encoding, typename Allocator, typename StackAllocator>
 class GenericDocument;
 
+template <typename Encoding, typename Allocator, typename StackAllocator>
+class GenericParallelParser;
+
 //! Name-value pair in a JSON object value.
 /*!
     This class was internal to GenericValue. It used to be a inner struct.
@@ -2327,6 +2330,7 @@ private:
     // callers of the following private Handler functions
     // template <typename,typename,typename> friend class GenericReader; // for parsing
     template <typename, typename> friend class GenericValue; // for deep copying
+    template <typename, typename, typename> friend class GenericParallelParser; // for reporting parse errors
 
 public:
     // Implementation of Handler
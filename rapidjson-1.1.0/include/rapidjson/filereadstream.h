@@ -17,6 +17,7 @@
 
 #include "stream.h"
 #include <cstdio>
+#include <cstring>
 
 #ifdef __clang__
 RAPIDJSON_DIAG_PUSH
@@ -62,6 +63,21 @@ public:
         return (current_ + 4 <= bufferLast_) ? current_ : 0;
     }
 
+    // For parsers which copy the input in large blocks.
+    size_t TakeBlock(Ch* buffer, size_t count) {
+        size_t n = 0;
+        while (n < count && !(eof_ && current_ == bufferLast_)) {
+            size_t available = static_cast<size_t>(bufferLast_ - current_) + (eof_ ? 0 : 1);
+            if (available > count - n)
+                available = count - n;
+            std::memcpy(buffer + n, current_, available);
+            n += available;
+            current_ += available - 1;
+            Read();
+        }
+        return n;
+    }
+
 private:
     void Read() {
         if (current_ < bufferLast_)
@@ -127,6 +127,13 @@ class GenericPointer;
 
 typedef GenericPointer<Value, CrtAllocator> Pointer;
 
+// parallelparser.h
+
+template <typename Encoding, typename Allocator, typename StackAllocator>
+class GenericParallelParser;
+
+typedef GenericParallelParser<UTF8<char>, MemoryPoolAllocator<CrtAllocator>, CrtAllocator> ParallelParser;
+
 // schema.h
 
 template <typename SchemaDocumentType>
@@ -0,0 +1,133 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef RAPIDJSON_INTERNAL_SIMD_H_
+#define RAPIDJSON_INTERNAL_SIMD_H_
+
+#include "../rapidjson.h"
+
+// Which of the wide code paths are compiled. Under RAPIDJSON_SIMD_DISPATCH all of them are.
+#if defined(RAPIDJSON_AVX512) || defined(RAPIDJSON_SIMD_DISPATCH)
+#define RAPIDJSON_SIMD_HAS_AVX512
+#endif
+#if defined(RAPIDJSON_AVX2) || defined(RAPIDJSON_SIMD_HAS_AVX512)
+#define RAPIDJSON_SIMD_HAS_AVX2
+#endif
+
+#ifdef RAPIDJSON_SIMD_HAS_AVX2
+#include <immintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// The translation unit targets baseline x86-64 under RAPIDJSON_SIMD_DISPATCH,
+// so gcc and clang have to be told which functions may use AVX instructions.
+#if defined(RAPIDJSON_SIMD_DISPATCH) && (defined(__GNUC__) || defined(__clang__))
+#define RAPIDJSON_TARGET_AVX2 __attribute__((target("avx2")))
+#define RAPIDJSON_TARGET_AVX512 __attribute__((target("avx2,avx512f,avx512bw")))
+#else
+#define RAPIDJSON_TARGET_AVX2
+#define RAPIDJSON_TARGET_AVX512
+#endif
+
+RAPIDJSON_NAMESPACE_BEGIN
+namespace internal {
+
+//! Widest SIMD instruction set the parser uses.
+enum SimdLevel {
+    kSimdSSE = 0,       //!< 16-byte SSE2/SSE4.2 code, if any.
+    kSimdAVX2 = 1,      //!< 32-byte AVX2 code.
+    kSimdAVX512 = 2     //!< 64-byte AVX-512BW code.
+};
+
+//! Query the processor for AVX2 and AVX-512BW, including OS support for the wider registers.
+inline SimdLevel DetectSimdLevel() {
+#if !defined(RAPIDJSON_SIMD_DISPATCH)
+#if defined(RAPIDJSON_SIMD_HAS_AVX512)
+    return kSimdAVX512;
+#elif defined(RAPIDJSON_SIMD_HAS_AVX2)
+    return kSimdAVX2;
+#else
+    return kSimdSSE;
+#endif
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return kSimdSSE;
+    __cpuid(info, 1);
+    if ((info[2] & (1 << 27)) == 0) // OSXSAVE
+        return kSimdSSE;
+    const unsigned long long xcr0 = _xgetbv(0);
+    if ((xcr0 & 0x6) != 0x6)        // XMM and YMM state
+        return kSimdSSE;
+    __cpuidex(info, 7, 0);
+    if ((info[1] & (1 << 16)) && (info[1] & (1 << 30)) && (xcr0 & 0xE0) == 0xE0) // AVX512F, AVX512BW, opmask and ZMM state
+        return kSimdAVX512;
+    if (info[1] & (1 << 5))
+        return kSimdAVX2;
+    return kSimdSSE;
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512bw"))
+        return kSimdAVX512;
+    if (__builtin_cpu_supports("avx2"))
+        return kSimdAVX2;
+    return kSimdSSE;
+#endif
+}
+
+//! Instruction set selected for this process.
+/*! Under \c RAPIDJSON_SIMD_DISPATCH the processor is queried once, otherwise
+    this is a compile-time constant and the unused code paths are dropped.
+*/
+inline SimdLevel GetSimdLevel() {
+#ifdef RAPIDJSON_SIMD_DISPATCH
+    static const SimdLevel level = DetectSimdLevel();
+    return level;
+#else
+    return DetectSimdLevel();
+#endif
+}
+
+//! Index of the lowest set bit of a non-zero mask.
+inline unsigned LowestBit(uint32_t mask) {
+    RAPIDJSON_ASSERT(mask != 0);
+#ifdef _MSC_VER
+    unsigned long offset;
+    _BitScanForward(&offset, mask);
+    return offset;
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+inline unsigned LowestBit(uint64_t mask) {
+    RAPIDJSON_ASSERT(mask != 0);
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long offset;
+    _BitScanForward64(&offset, mask);
+    return offset;
+#elif defined(_MSC_VER)
+    return static_cast<uint32_t>(mask) ? LowestBit(static_cast<uint32_t>(mask)) : 32 + LowestBit(static_cast<uint32_t>(mask >> 32));
+#else
+    return static_cast<unsigned>(__builtin_ctzll(mask));
+#endif
+}
+
+} // namespace internal
+RAPIDJSON_NAMESPACE_END
+
+#endif // RAPIDJSON_INTERNAL_SIMD_H_
@@ -19,6 +19,13 @@
 #include "biginteger.h"
 #include "diyfp.h"
 #include "pow10.h"
+#include "pow5.h"
+#include <limits>
+
+#if defined(_MSC_VER) && defined(_M_AMD64)
+#include <intrin.h>
+#pragma intrinsic(_umul128)
+#endif
 
 RAPIDJSON_NAMESPACE_BEGIN
 namespace internal {
@@ -125,6 +132,139 @@ inline bool StrtodFast(double d, int p, double* result) {
         return false;
 }
 
+//! Whether all eight bytes of a chunk loaded in little-endian order are ASCII digits.
+inline bool IsEightDigits(uint64_t chunk) {
+    return ((chunk & RAPIDJSON_UINT64_C2(0xF0F0F0F0, 0xF0F0F0F0)) |
+            (((chunk + RAPIDJSON_UINT64_C2(0x06060606, 0x06060606)) & RAPIDJSON_UINT64_C2(0xF0F0F0F0, 0xF0F0F0F0)) >> 4)) ==
+           RAPIDJSON_UINT64_C2(0x33333333, 0x33333333);
+}
+
+//! Value of eight ASCII digits loaded in little-endian order, so the first digit is the lowest byte.
+inline uint32_t ParseEightDigits(uint64_t chunk) {
+    // Combine pairs of digits, then pairs of pairs, with one multiplication each
+    chunk = ((chunk & RAPIDJSON_UINT64_C2(0x0F0F0F0F, 0x0F0F0F0F)) * 2561) >> 8;
+    chunk = ((chunk & RAPIDJSON_UINT64_C2(0x00FF00FF, 0x00FF00FF)) * 6553601) >> 16;
+    return static_cast<uint32_t>(((chunk & RAPIDJSON_UINT64_C2(0x0000FFFF, 0x0000FFFF)) * RAPIDJSON_UINT64_C2(0x00002710, 0x00000001)) >> 32);
+}
+
+//! Significand of up to 19 decimal digits.
+inline uint64_t ParseSignificand(const char* decimals, size_t length) {
+    RAPIDJSON_ASSERT(length <= 19);
+    uint64_t significand = 0;
+    size_t i = 0;
+#if RAPIDJSON_ENDIAN == RAPIDJSON_LITTLEENDIAN
+    for (; i + 8 <= length; i += 8) {
+        uint64_t chunk;
+        std::memcpy(&chunk, decimals + i, 8);
+        significand = significand * 100000000u + ParseEightDigits(chunk);
+    }
+#endif
+    for (; i < length; i++)
+        significand = significand * 10u + static_cast<unsigned>(decimals[i] - '0');
+    return significand;
+}
+
+//! 128-bit product of two 64-bit integers.
+inline uint64_t Multiply128(uint64_t a, uint64_t b, uint64_t* low) {
+#if defined(_MSC_VER) && defined(_M_AMD64)
+    uint64_t high;
+    *low = _umul128(a, b, &high);
+    return high;
+#elif (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 6)) && defined(__x86_64__)
+    __extension__ typedef unsigned __int128 uint128;
+    const uint128 p = static_cast<uint128>(a) * static_cast<uint128>(b);
+    *low = static_cast<uint64_t>(p);
+    return static_cast<uint64_t>(p >> 64);
+#else
+    const uint64_t M32 = 0xFFFFFFFF;
+    const uint64_t ac = (a >> 32) * (b >> 32);
+    const uint64_t bc = (a & M32) * (b >> 32);
+    const uint64_t ad = (a >> 32) * (b & M32);
+    const uint64_t bd = (a & M32) * (b & M32);
+    const uint64_t middle = (bd >> 32) + (ad & M32) + (bc & M32);
+    *low = (middle << 32) | (bd & M32);
+    return ac + (ad >> 32) + (bc >> 32) + (middle >> 32);
+#endif
+}
+
+// Eisel-Lemire algorithm: round significand * 10^exp10 from the 128-bit truncated power of five.
+// see Lemire, Daniel. "Number parsing at a gigabyte per second." Software: Practice and Experience 51.8 (2021): 1700-1727.
+// Returns false when the truncation leaves the rounding undecided.
+inline bool StrtodEiselLemire(uint64_t significand, int exp10, double* result) {
+    RAPIDJSON_ASSERT(significand != 0);
+    if (exp10 < kPow5MinExponent) {
+        *result = 0.0;
+        return true;
+    }
+    if (exp10 > kPow5MaxExponent) {
+        *result = std::numeric_limits<double>::infinity();
+        return true;
+    }
+
+    // 10^q = 5^q * 2^q, so the product of the normalized significand and 5^q has the bits of the result
+    const DiyFp v = DiyFp(significand, 0).Normalize();
+    const uint64_t* pow5 = GetPow5Significand128(exp10);
+    uint64_t low;
+    uint64_t high = Multiply128(v.f, pow5[0], &low);
+    if ((high & 0x1FF) == 0x1FF) {
+        // The 55 bits needed for rounding may carry from the lower product
+        uint64_t secondLow;
+        const uint64_t secondHigh = Multiply128(v.f, pow5[1], &secondLow);
+        low += secondHigh;
+        if (secondHigh > low)
+            high++;
+    }
+    if (low == ~uint64_t(0) && (exp10 < -27 || exp10 > 55))
+        return false;
+
+    const int upperBit = static_cast<int>(high >> 63);
+    const int shift = upperBit + 64 - DiyFp::kDpSignificandSize - 3;
+    uint64_t mantissa = high >> shift;
+    // floor(exp10 * log2(10)) + 63 is the binary exponent of 10^exp10 * 2^63
+    int biasedExp = (((152170 + 65536) * exp10) >> 16) + 63 + upperBit + v.e + 0x3FF;
+
+    if (biasedExp <= 0) {
+        // Subnormal, cannot be a tie as the power of five is inexact
+        if (-biasedExp + 1 >= 64) {
+            *result = 0.0;
+            return true;
+        }
+        mantissa >>= -biasedExp + 1;
+        mantissa += mantissa & 1;
+        mantissa >>= 1;
+        *result = Double(mantissa).Value(); // Rounding up to the smallest normal sets its exponent bit
+        return true;
+    }
+
+    // Round half to even: only small powers of five are exact, so ties are possible only for them
+    if (low <= 1 && exp10 >= -4 && exp10 <= 23 && (mantissa & 3) == 1 && (mantissa << shift) == high)
+        mantissa &= ~uint64_t(1);
+    mantissa += mantissa & 1;
+    mantissa >>= 1;
+    if (mantissa >= (uint64_t(2) << DiyFp::kDpSignificandSize)) {
+        mantissa = DiyFp::kDpHiddenBit;
+        biasedExp++;
+    }
+    if (biasedExp >= 0x7FF) {
+        *result = std::numeric_limits<double>::infinity();
+        return true;
+    }
+
+    *result = Double((static_cast<uint64_t>(biasedExp) << DiyFp::kDpSignificandSize) | (mantissa & DiyFp::kDpSignificandMask)).Value();
+    return true;
+}
+
+//! Correctly rounded significand * 10^exp10, unless the rounding is undecided.
+inline bool StrtodSignificand(uint64_t significand, int exp10, double* result) {
+    if (significand <= RAPIDJSON_UINT64_C2(0x1FFFFF, 0xFFFFFFFF) && StrtodFast(static_cast<double>(significand), exp10, result))
+        return true;
+    if (significand == 0) {
+        *result = 0.0;
+        return true;
+    }
+    return StrtodEiselLemire(significand, exp10, result);
+}
+
 // Compute an approximation and see if it is within 1/2 ULP
 inline bool StrtodDiyFp(const char* decimals, size_t length, size_t decimalPosition, int exp, double* result) {
     uint64_t significand = 0;
@@ -256,6 +396,21 @@ inline double StrtodFullPrecision(double d, int p, const char* decimals, size_t
     if (int(length) + exp < -324)
         return 0.0;
 
+    // Round the leading 19 digits. If there are more, they are between them and the next
+    // larger significand, and the result is decided when both of these round the same.
+    const size_t leading = length < 19 ? length : 19;
+    const uint64_t significand = ParseSignificand(decimals, leading);
+    if (significand == 0)
+        return 0.0;
+    const int leadingExp = static_cast<int>(decimalPosition) - static_cast<int>(leading) + exp;
+    if (StrtodEiselLemire(significand, leadingExp, &result)) {
+        double upper;
+        if (leading == length || (StrtodEiselLemire(significand + 1, leadingExp, &upper) && Double(upper).Uint64Value() == Double(result).Uint64Value()))
+            return result;
+        // Rounded from below, so at most one ULP short
+        return StrtodBigInteger(result, decimals, length, decimalPosition, exp);
+    }
+
     if (StrtodDiyFp(decimals, length, decimalPosition, exp, &result))
         return result;
 
@@ -0,0 +1,372 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef RAPIDJSON_INTERNAL_STRUCTURALINDEX_H_
+#define RAPIDJSON_INTERNAL_STRUCTURALINDEX_H_
+
+#include "stack.h"
+#include "simd.h"
+#include <cstring>
+
+#ifdef RAPIDJSON_SSE42
+#include <nmmintrin.h>
+#elif defined(RAPIDJSON_SSE2)
+#include <emmintrin.h>
+#endif
+
+RAPIDJSON_NAMESPACE_BEGIN
+namespace internal {
+
+///////////////////////////////////////////////////////////////////////////////
+// StructuralIndexer
+
+//! Turns the character classes of 64-byte blocks into the token positions of a JSON text.
+/*! A position is indexed if it is outside of strings and
+    - one of the punctuation characters <tt>{ } [ ] : ,</tt>,
+    - an opening quotation mark, or
+    - the first character of any other token, i.e. a non-whitespace character
+      following whitespace or punctuation.
+
+    The first null character is indexed too and ends the text. Backslash runs
+    are resolved with carries between blocks, and the string regions come from
+    the prefix XOR of the unescaped quotation marks. Characters directly
+    following a number or literal are not indexed, the reader sees them when
+    the value ends.
+
+    Indexing starts outside of strings, in front of a token or whitespace.
+*/
+class StructuralIndexer {
+public:
+    StructuralIndexer() : prevEscaped_(0), prevInString_(0), prevBoundary_(1), done_(false) {}
+
+    //! Whether the null character has been indexed.
+    bool Done() const { return done_; }
+
+    //! Index one block.
+    /*! \param quote Bit i is set if character i is a quotation mark, likewise for the other masks.
+        \param punctuation Bit i is set for the punctuation characters. Control characters
+            may be set too, they are invalid outside of strings anyway.
+        \param offset Position of the first character of the block.
+        \param out Where to write the positions.
+        \return End of the written positions.
+    */
+    RAPIDJSON_FORCEINLINE uint32_t* Next(uint64_t quote, uint64_t backslash, uint64_t whitespace, uint64_t punctuation, uint64_t null, uint32_t offset, uint32_t* out) {
+        const uint64_t escaped = FindEscaped(backslash);
+        const uint64_t unescapedQuote = quote & ~escaped;
+        const uint64_t inString = PrefixXor(unescapedQuote) ^ prevInString_; // Opening quotation mark included, closing excluded
+        prevInString_ = static_cast<uint64_t>(static_cast<int64_t>(inString) >> 63);
+
+        const uint64_t boundary = whitespace | punctuation;
+        const uint64_t tokenStart = ~(boundary | quote) & (boundary << 1 | prevBoundary_);
+        prevBoundary_ = boundary >> 63;
+
+        uint64_t bits = ((punctuation | tokenStart) & ~inString) | (unescapedQuote & inString);
+        if (RAPIDJSON_UNLIKELY(null != 0)) {
+            const uint64_t first = null & (~null + 1);
+            bits = (bits & (first - 1)) | first;
+            done_ = true;
+        }
+        for (; bits != 0; bits &= bits - 1)
+            *out++ = offset + LowestBit(bits);
+        return out;
+    }
+
+private:
+    //! Characters escaped by a backslash, with runs of backslashes continuing into the next block.
+    RAPIDJSON_FORCEINLINE uint64_t FindEscaped(uint64_t backslash) {
+        const uint64_t kEvenBits = RAPIDJSON_UINT64_C2(0x55555555, 0x55555555);
+        backslash &= ~prevEscaped_;
+        const uint64_t followsEscape = backslash << 1 | prevEscaped_;
+        const uint64_t oddSequenceStarts = backslash & ~kEvenBits & ~followsEscape;
+        const uint64_t sequencesStartingOnEvenBits = oddSequenceStarts + backslash;
+        prevEscaped_ = sequencesStartingOnEvenBits < oddSequenceStarts ? 1u : 0u;   // Carry out of the addition
+        const uint64_t invertMask = sequencesStartingOnEvenBits << 1;
+        return (kEvenBits ^ invertMask) & followsEscape;
+    }
+
+    //! Bit i of the result is the XOR of bits 0 to i.
+    static RAPIDJSON_FORCEINLINE uint64_t PrefixXor(uint64_t x) {
+        x ^= x << 1;
+        x ^= x << 2;
+        x ^= x << 4;
+        x ^= x << 8;
+        x ^= x << 16;
+        x ^= x << 32;
+        return x;
+    }
+
+    uint64_t prevEscaped_;      //!< 1 if the first character of the next block is escaped.
+    uint64_t prevInString_;     //!< All ones if the next block starts inside a string.
+    uint64_t prevBoundary_;     //!< 1 if the last character of the previous block is whitespace or punctuation.
+    bool done_;                 //!< The null character has been indexed.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Block classification
+
+//! The block of 64 bytes from p if it ends on the same page, or the text continues on the next one.
+/*! Otherwise the text up to the null character is copied into buffer, padded with null characters.
+    Reading past the null character is safe as long as no page boundary is crossed.
+*/
+inline const char* PageEndBlock(const char* p, char* buffer) {
+    const char* nextPage = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) | 4095) + 1);
+    const char* q = p;
+    while (q != nextPage && *q != '\0')
+        ++q;
+    if (q == nextPage)
+        return p;
+    std::memset(buffer, 0, 64);
+    std::memcpy(buffer, p, static_cast<size_t>(q - p));
+    return buffer;
+}
+
+//! The 64 bytes from p, or a copy if the text ends before a page boundary within them.
+static RAPIDJSON_FORCEINLINE const char* LoadableBlock(const char* p, char* buffer) {
+    return RAPIDJSON_LIKELY((reinterpret_cast<size_t>(p) & 4095) <= 4096 - 64) ? p : PageEndBlock(p, buffer);
+}
+
+// Each function indexes up to count blocks read from p, numbered from offset, and stops after the null character.
+
+inline uint32_t* IndexBlocks(StructuralIndexer& indexer, const char* p, size_t count, uint32_t offset, uint32_t* out) {
+    for (; count != 0 && !indexer.Done(); count--, p += 64, offset += 64) {
+        uint64_t quote = 0, backslash = 0, whitespace = 0, punctuation = 0, null = 0;
+        for (unsigned i = 0; i < 64; i++) {
+            const char c = p[i];
+            const uint64_t bit = static_cast<uint64_t>(1) << i;
+            if (c == '\"') quote |= bit;
+            if (c == '\\') backslash |= bit;
+            if (c == ' ' || c == '\n' || c == '\r' || c == '\t') whitespace |= bit;
+            if (c == '{' || c == '}' || c == '[' || c == ']' || c == ':' || c == ',') punctuation |= bit;
+            if (c == '\0') {
+                null = bit;
+                break;
+            }
+        }
+        out = indexer.Next(quote, backslash, whitespace, punctuation, null, offset, out);
+    }
+    return out;
+}
+
+#ifdef RAPIDJSON_SIMD
+inline uint32_t* IndexBlocks_SIMD(StructuralIndexer& indexer, const char* p, size_t count, uint32_t offset, uint32_t* out) {
+    const __m128i dq = _mm_set1_epi8('\"');
+    const __m128i bs = _mm_set1_epi8('\\');
+    const __m128i sp = _mm_set1_epi8(' ');
+    const __m128i nl = _mm_set1_epi8('\n');
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i tb = _mm_set1_epi8('\t');
+    const __m128i cl = _mm_set1_epi8(':');
+    const __m128i cm = _mm_set1_epi8(',');
+    const __m128i ob = _mm_set1_epi8('{');  // '[' | 0x20
+    const __m128i cb = _mm_set1_epi8('}');  // ']' | 0x20
+    const __m128i lower = _mm_set1_epi8(0x20);
+    const __m128i zero = _mm_setzero_si128();
+
+    char buffer[64];
+    for (; count != 0 && !indexer.Done(); count--, p += 64, offset += 64) {
+        const char* block = LoadableBlock(p, buffer);
+        uint64_t quote = 0, backslash = 0, whitespace = 0, punctuation = 0, null = 0;
+        for (unsigned i = 0; i < 64; i += 16) {
+            const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + i));
+            const __m128i l = _mm_or_si128(s, lower);
+            const __m128i w = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(s, sp), _mm_cmpeq_epi8(s, nl)), _mm_or_si128(_mm_cmpeq_epi8(s, cr), _mm_cmpeq_epi8(s, tb)));
+            const __m128i o = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(s, cl), _mm_cmpeq_epi8(s, cm)), _mm_or_si128(_mm_cmpeq_epi8(l, ob), _mm_cmpeq_epi8(l, cb)));
+            quote |= static_cast<uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(s, dq)))) << i;
+            backslash |= static_cast<uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(s, bs)))) << i;
+            whitespace |= static_cast<uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(w))) << i;
+            punctuation |= static_cast<uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(o))) << i;
+            null |= static_cast<uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(s, zero)))) << i;
+        }
+        out = indexer.Next(quote, backslash, whitespace, punctuation, null, offset, out);
+    }
+    return out;
+}
+#endif
+
+// Whitespace and punctuation are classified by looking up the low nibble of each character:
+// whitespace maps to itself, punctuation to itself with bit 5 set, so '[' and ']' match '{' and '}'.
+#define RAPIDJSON_STRUCTURAL_WHITESPACE_TABLE ' ', 100, 100, 100, 17, 100, 113, 2, 100, '\t', '\n', 112, 100, '\r', 100, 100
+#define RAPIDJSON_STRUCTURAL_PUNCTUATION_TABLE 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, ':', '{', ',', '}', 0, 0
+
+#ifdef RAPIDJSON_SIMD_HAS_AVX2
+RAPIDJSON_TARGET_AVX2 inline uint32_t* IndexBlocks_AVX2(StructuralIndexer& indexer, const char* p, size_t count, uint32_t offset, uint32_t* out) {
+    const __m256i wt = _mm256_setr_epi8(RAPIDJSON_STRUCTURAL_WHITESPACE_TABLE, RAPIDJSON_STRUCTURAL_WHITESPACE_TABLE);
+    const __m256i pt = _mm256_setr_epi8(RAPIDJSON_STRUCTURAL_PUNCTUATION_TABLE, RAPIDJSON_STRUCTURAL_PUNCTUATION_TABLE);
+    const __m256i dq = _mm256_set1_epi8('\"');
+    const __m256i bs = _mm256_set1_epi8('\\');
+    const __m256i lower = _mm256_set1_epi8(0x20);
+    const __m256i zero = _mm256_setzero_si256();
+
+    char buffer[64];
+    for (; count != 0 && !indexer.Done(); count--, p += 64, offset += 64) {
+        const char* block = LoadableBlock(p, buffer);
+        uint64_t quote = 0, backslash = 0, whitespace = 0, punctuation = 0, null = 0;
+        for (unsigned i = 0; i < 64; i += 32) {
+            const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block + i));
+            const __m256i w = _mm256_cmpeq_epi8(s, _mm256_shuffle_epi8(wt, s));
+            const __m256i o = _mm256_cmpeq_epi8(_mm256_or_si256(s, lower), _mm256_shuffle_epi8(pt, s));
+            quote |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(s, dq)))) << i;
+            backslash |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(s, bs)))) << i;
+            whitespace |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(w))) << i;
+            punctuation |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(o))) << i;
+            null |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(s, zero)))) << i;
+        }
+        out = indexer.Next(quote, backslash, whitespace, punctuation, null, offset, out);
+    }
+    return out;
+}
+#endif
+
+#ifdef RAPIDJSON_SIMD_HAS_AVX512
+RAPIDJSON_TARGET_AVX512 inline uint32_t* IndexBlocks_AVX512(StructuralIndexer& indexer, const char* p, size_t count, uint32_t offset, uint32_t* out) {
+    const __m512i wt = _mm512_broadcast_i32x4(_mm_setr_epi8(RAPIDJSON_STRUCTURAL_WHITESPACE_TABLE));
+    const __m512i pt = _mm512_broadcast_i32x4(_mm_setr_epi8(RAPIDJSON_STRUCTURAL_PUNCTUATION_TABLE));
+    const __m512i dq = _mm512_set1_epi8('\"');
+    const __m512i bs = _mm512_set1_epi8('\\');
+    const __m512i lower = _mm512_set1_epi8(0x20);
+
+    char buffer[64];
+    for (; count != 0 && !indexer.Done(); count--, p += 64, offset += 64) {
+        const __m512i s = _mm512_loadu_si512(reinterpret_cast<const void *>(LoadableBlock(p, buffer)));
+        out = indexer.Next(
+            _mm512_cmpeq_epi8_mask(s, dq),
+            _mm512_cmpeq_epi8_mask(s, bs),
+            _mm512_cmpeq_epi8_mask(s, _mm512_shuffle_epi8(wt, s)),
+            _mm512_cmpeq_epi8_mask(_mm512_or_si512(s, lower), _mm512_shuffle_epi8(pt, s)),
+            _mm512_testn_epi8_mask(s, s),
+            offset, out);
+    }
+    return out;
+}
+#endif
+
+#undef RAPIDJSON_STRUCTURAL_WHITESPACE_TABLE
+#undef RAPIDJSON_STRUCTURAL_PUNCTUATION_TABLE
+
+///////////////////////////////////////////////////////////////////////////////
+// StructuralIndex
+
+//! Token positions of a null-terminated JSON text, the first stage of \ref kParseStructuralIndexFlag.
+/*! The text is indexed lazily in batches from the position the reader asks
+    about, so a parse only indexes about as far as it reads. Batches start
+    small, for short texts parsed with \ref kParseStopWhenDoneFlag, and grow
+    up to 64 KB, which bounds the memory taken by the positions.
+    \see StructuralIndexer
+*/
+template <typename Allocator>
+class StructuralIndex {
+public:
+    StructuralIndex(Allocator* allocator, size_t capacity) : positions_(allocator, capacity), base_(), end_(), cursor_(), blocks_() {}
+
+    //! Start indexing at p, which must be outside of strings.
+    void Reset(const char* p) {
+        blocks_ = kMinBlocks;
+        Index(p);
+    }
+
+    //! Where the token at or after p starts.
+    /*! \param p Position following a token, or where indexing started, outside of strings.
+        \return The indexed position if only whitespace is in front of it, otherwise p.
+    */
+    RAPIDJSON_FORCEINLINE const char* Peek(const char* p) {
+        const char* q = base_ + *cursor_;
+        if (RAPIDJSON_LIKELY(q != end_)) {
+            if (RAPIDJSON_LIKELY(q == p))
+                return q;
+            if (RAPIDJSON_LIKELY(q > p))
+                return *p == ' ' || *p == '\n' || *p == '\r' || *p == '\t' ? q : p;
+        }
+        return Seek(p);
+    }
+
+    //! Where the token after the one last peeked at starts, which has been read up to p.
+    RAPIDJSON_FORCEINLINE const char* Next(const char* p) {
+        ++cursor_;
+        return Peek(p);
+    }
+
+    void Clear() { positions_.Clear(); }
+
+private:
+    static const size_t kMinBlocks = 4;         //!< First batch, in 64-byte blocks.
+    static const size_t kMaxBlocks = 1024;      //!< Largest batch.
+    static const size_t kBlocksPerReserve = 64; //!< Room is made for the worst case of this many blocks at once.
+
+    // Skip the positions before p, and index the next batch at the end of this one
+    const char* Seek(const char* p) {
+        for (;;) {
+            const char* q = base_ + *cursor_;
+            if (q == end_)
+                Index(q > p ? q : p);   // Nothing indexed between p and the end of the batch, which is whitespace then
+            else if (q >= p)
+                return q == p || *p == ' ' || *p == '\n' || *p == '\r' || *p == '\t' ? q : p;
+            else
+                ++cursor_;
+        }
+    }
+
+    // Index the next batch from p, forgetting the positions before it
+    void Index(const char* p) {
+        StructuralIndexer indexer;
+        const SimdLevel level = GetSimdLevel();
+        (void)level;
+
+        positions_.Clear();
+        uint32_t offset = 0;
+        for (size_t remaining = blocks_; remaining != 0 && !indexer.Done(); ) {
+            const size_t count = remaining < kBlocksPerReserve ? remaining : kBlocksPerReserve;
+            positions_.template Reserve<uint32_t>(count * 64 + 1);
+            uint32_t* begin = positions_.template End<uint32_t>();
+            uint32_t* end;
+#ifdef RAPIDJSON_SIMD_HAS_AVX512
+            if (level == kSimdAVX512)
+                end = IndexBlocks_AVX512(indexer, p + offset, count, offset, begin);
+            else
+#endif
+#ifdef RAPIDJSON_SIMD_HAS_AVX2
+            if (level == kSimdAVX2)
+                end = IndexBlocks_AVX2(indexer, p + offset, count, offset, begin);
+            else
+#endif
+#ifdef RAPIDJSON_SIMD
+                end = IndexBlocks_SIMD(indexer, p + offset, count, offset, begin);
+#else
+                end = IndexBlocks(indexer, p + offset, count, offset, begin);
+#endif
+            positions_.template PushUnsafe<uint32_t>(static_cast<size_t>(end - begin));
+            offset += static_cast<uint32_t>(count * 64);
+            remaining -= count;
+        }
+
+        // The end of the batch, right after the null character if it was found
+        const uint32_t last = indexer.Done() ? *(positions_.template Top<uint32_t>()) + 1 : offset;
+        *positions_.template Push<uint32_t>() = last;
+        base_ = p;
+        end_ = p + last;
+        cursor_ = positions_.template Bottom<uint32_t>();
+        if (blocks_ < kMaxBlocks)
+            blocks_ *= 2;
+    }
+
+    Stack<Allocator> positions_;    //!< Positions relative to base_, followed by the end of the batch.
+    const char* base_;              //!< Position 0 of the batch.
+    const char* end_;               //!< End of the batch, the reader indexes again from there.
+    const uint32_t* cursor_;        //!< No position before it is needed again.
+    size_t blocks_;                 //!< Size of the next batch in blocks.
+};
+
+} // namespace internal
+RAPIDJSON_NAMESPACE_END
+
+#endif // RAPIDJSON_INTERNAL_STRUCTURALINDEX_H_
@@ -0,0 +1,688 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef RAPIDJSON_PARALLELPARSER_H_
+#define RAPIDJSON_PARALLELPARSER_H_
+
+#include "document.h"
+#include "pointer.h"
+#include "filereadstream.h"
+#include <cstring>
+#include <new>      // placement new
+#include <thread>
+#include <vector>
+
+#ifdef __clang__
+RAPIDJSON_DIAG_PUSH
+RAPIDJSON_DIAG_OFF(padded)
+RAPIDJSON_DIAG_OFF(switch-enum)
+#endif
+
+RAPIDJSON_NAMESPACE_BEGIN
+
+namespace internal {
+
+//! Copy up to \c size bytes of a stream into \c buffer, and return how many were copied.
+template <typename InputStream>
+inline size_t TakeBlock(InputStream& is, char* buffer, size_t size) {
+    size_t n = 0;
+    for (; n < size && is.Peek() != '\0'; n++)
+        buffer[n] = static_cast<char>(is.Take());
+    return n;
+}
+
+inline size_t TakeBlock(MemoryStream& is, char* buffer, size_t size) {
+    size_t n = static_cast<size_t>(is.end_ - is.src_);
+    if (n > size)
+        n = size;
+    std::memcpy(buffer, is.src_, n);
+    is.src_ += n;
+    return n;
+}
+
+inline size_t TakeBlock(FileReadStream& is, char* buffer, size_t size) {
+    return is.TakeBlock(buffer, size);
+}
+
+//! Keep the memory of a parsed slice alive in the allocator of the document.
+template <typename Allocator>
+inline void SpliceAllocator(Allocator&, Allocator&) {} // Blocks are freed one by one, e.g. CrtAllocator
+
+template <typename BaseAllocator>
+inline void SpliceAllocator(MemoryPoolAllocator<BaseAllocator>& allocator, MemoryPoolAllocator<BaseAllocator>& slice) {
+    allocator.Splice(slice);
+}
+
+} // namespace internal
+
+///////////////////////////////////////////////////////////////////////////////
+// GenericParallelParser
+
+//! Parser of a document whose root, or a value at a JSON pointer, is a large array, on several threads.
+/*!
+    The text of the array is cut into slices, which are parsed at the same time, each into
+    its own allocator. The first slice starts at the opening bracket. Each other slice starts
+    at the first comma in it which is followed by the same kind of value as the first element,
+    and is kept only if the slice before it ended at that comma. Otherwise it is parsed again
+    from where the slice before it ended, so the document and the parse errors are the same
+    as from GenericDocument::ParseStream().
+
+    The allocators of the kept slices are spliced into the allocator of the document, and
+    their elements are moved into the array without copying strings or members.
+
+    The input is read in windows of \c threadCount slices, and the next window is read while
+    one is parsed, so a file is not held in memory as a whole. The text around the array is
+    parsed on the calling thread, after the array.
+
+    \tparam Encoding Encoding of the document. The input is UTF-8.
+    \tparam Allocator Allocator of the document. It is either a MemoryPoolAllocator, or frees
+        its blocks one by one, like CrtAllocator.
+    \tparam StackAllocator Allocator for the parse stacks and the input windows.
+    \note Requires C++11 threads. \ref kParseInsituFlag is not supported, and text with
+        comments (\ref kParseCommentsFlag) is parsed on the calling thread.
+*/
+template <typename Encoding, typename Allocator = MemoryPoolAllocator<>, typename StackAllocator = CrtAllocator>
+class GenericParallelParser {
+public:
+    typedef typename Encoding::Ch Ch;                                           //!< Character type derived from Encoding.
+    typedef GenericDocument<Encoding, Allocator, StackAllocator> DocumentType;  //!< Type of the document parsed into.
+    typedef GenericValue<Encoding, Allocator> ValueType;                        //!< Value type of the document.
+
+    //! Constructor.
+    /*! \param threadCount Number of slices parsed at the same time, or 0 for the number of hardware threads.
+        \param sliceSize Size of a slice of text in bytes.
+    */
+    explicit GenericParallelParser(unsigned threadCount = 0, size_t sliceSize = kDefaultSliceSize) :
+        threadCount_(threadCount ? threadCount : std::thread::hardware_concurrency()), sliceSize_(sliceSize),
+        text_(0, kDefaultBufferCapacity), next_(0, kDefaultBufferCapacity), skeleton_(0, kDefaultBufferCapacity), kept_(),
+        bounds_(), slices_(), base_(), firstKind_()
+    {
+        if (threadCount_ == 0) // Unknown number of hardware threads
+            threadCount_ = 1;
+        RAPIDJSON_ASSERT(sliceSize_ > 0);
+    }
+
+    ~GenericParallelParser() {
+        ClearElements();
+    }
+
+    //! Parse JSON text whose root is an array.
+    /*! Other roots are parsed on the calling thread.
+        \tparam parseFlags Combination of \ref ParseFlag (must not contain \ref kParseInsituFlag).
+        \tparam InputStream Byte stream of UTF-8 text, e.g. MemoryStream or FileReadStream.
+        \param is Input stream to be parsed. It is read to the end.
+        \param document Document which receives the value and the parse result.
+        \return The parse result, also available from the document.
+    */
+    template <unsigned parseFlags, typename InputStream>
+    ParseResult Parse(InputStream& is, DocumentType& document) {
+        return Parse<parseFlags>(is, document, GenericPointer<ValueType>());
+    }
+
+    //! Parse JSON text whose root is an array (with \ref kParseDefaultFlags).
+    template <typename InputStream>
+    ParseResult Parse(InputStream& is, DocumentType& document) {
+        return Parse<kParseDefaultFlags>(is, document);
+    }
+
+    //! Parse JSON text with a large array at a JSON pointer.
+    /*! The array is found by scanning the text before it. If the pointer does not resolve
+        to an array, the text is parsed on the calling thread.
+        \tparam parseFlags Combination of \ref ParseFlag (must not contain \ref kParseInsituFlag).
+        \tparam InputStream Byte stream of UTF-8 text, e.g. MemoryStream or FileReadStream.
+        \param is Input stream to be parsed. It is read to the end.
+        \param document Document which receives the value and the parse result.
+        \param arrayPath Location of the array, e.g. Pointer("/items").
+        \return The parse result, also available from the document.
+    */
+    template <unsigned parseFlags, typename InputStream, typename PointerAllocator>
+    ParseResult Parse(InputStream& is, DocumentType& document, const GenericPointer<ValueType, PointerAllocator>& arrayPath) {
+        RAPIDJSON_ASSERT(!(parseFlags & kParseInsituFlag));
+        RAPIDJSON_ASSERT(arrayPath.IsValid());
+
+        if (parseFlags & kParseCommentsFlag) {
+            EncodedInputStream<UTF8<>, InputStream> eis(is);
+            return document.template ParseStream<parseFlags, UTF8<> >(eis);
+        }
+
+        text_.Clear();
+        next_.Clear();
+        skeleton_.Clear();
+        ClearElements();
+        base_ = is.Tell();
+        bool eof = Read(is, text_, WindowSize());
+
+        size_t arrayBegin = 0;
+        int located;
+        while ((located = Locate(arrayPath, &arrayBegin)) == kLocateMore && !eof)
+            eof = Read(is, text_, WindowSize());
+        if (located != kLocateFound) {
+            while (!eof)
+                eof = Read(is, text_, WindowSize());
+            return ParseSerial<parseFlags>(document);
+        }
+
+        // The text around the array is parsed later, with the array left empty
+        const size_t prefixLength = arrayBegin;
+        const size_t prefixBase = base_;
+        Append(skeleton_, text_.template Bottom<char>(), prefixLength);
+        firstKind_ = Kind(*SkipSpace(text_.template Bottom<char>() + arrayBegin + 1));
+
+        size_t pos = arrayBegin;
+        ParseResult error;
+        int state;
+        while ((state = ParseWindow<parseFlags>(is, eof, document.GetAllocator(), &pos, &error)) == kWindowMore) {
+            Consume(pos);
+            Append(text_, next_.template Bottom<char>(), next_.GetSize() - 1);
+            next_.Clear();
+            pos = 0;
+        }
+
+        if (state == kWindowError) {
+            if (arrayPath.GetTokenCount() > 0)
+                CheckPrefix<parseFlags>(prefixLength, prefixBase, &error);
+            ClearElements();
+            document.parseResult_ = error;
+            return error;
+        }
+
+        const size_t arrayEnd = base_ + pos;
+        Append(skeleton_, "[]", 2);
+        Append(skeleton_, text_.template Bottom<char>() + pos + 1, text_.GetSize() - pos - 2);
+        if (!next_.Empty())
+            Append(skeleton_, next_.template Bottom<char>(), next_.GetSize() - 1);
+        while (!eof)
+            eof = Read(is, skeleton_, WindowSize());
+
+        GenericStringStream<UTF8<> > s(skeleton_.template Bottom<char>());
+        document.template ParseStream<parseFlags, UTF8<> >(s);
+        ParseResult& result = document.parseResult_;
+        if (result.IsError()) {
+            result.Set(result.Code(), result.Offset() <= prefixLength ?
+                prefixBase + result.Offset() : arrayEnd + result.Offset() - prefixLength - 1);
+            ClearElements();
+            return result;
+        }
+
+        ValueType* array = arrayPath.Get(document);
+        RAPIDJSON_ASSERT(array != 0 && array->IsArray() && array->Empty());
+        // Each element is moved once, from the array of its slice
+        SizeType count = 0;
+        for (size_t i = 0; i < kept_.size(); i++)
+            count += kept_[i]->document.Size();
+        array->Reserve(count, document.GetAllocator());
+        for (size_t i = 0; i < kept_.size(); i++)
+            for (typename ValueType::ValueIterator v = kept_[i]->document.Begin(); v != kept_[i]->document.End(); ++v)
+                array->PushBack(*v, document.GetAllocator());
+        ClearElements();
+        return result;
+    }
+
+private:
+    typedef internal::Stack<StackAllocator> Buffer;
+
+    enum { kLocateFound, kLocateMore, kLocateNone };
+    enum { kWindowMore, kWindowClosed, kWindowError };
+    enum { kKindUnknown, kKindObject, kKindArray, kKindString, kKindNumber };
+
+    //! Elements parsed from one slice of text.
+    struct Slice {
+        Slice() : allocator(), document(&allocator), begin(), end(), closed(), result() {}
+
+        Allocator allocator;    //!< Allocator of the elements, spliced into the document's when kept.
+        DocumentType document;  //!< Array of the elements.
+        size_t begin;           //!< Offset of the bracket or comma before the first element.
+        size_t end;             //!< Offset of the comma after the last element, or of the closing bracket.
+        bool closed;            //!< Whether the array ended in this slice.
+        ParseResult result;     //!< Error in an element, if any.
+
+    private:
+        Slice(const Slice&);
+        Slice& operator=(const Slice&);
+    };
+
+    //! Handler which stops at a depth a speculative slice would not reach in most real text.
+    class DepthLimitedHandler {
+    public:
+        DepthLimitedHandler(DocumentType& document, unsigned maxDepth) : document_(document), depth_(), maxDepth_(maxDepth) {}
+
+        bool Null() { return document_.Null(); }
+        bool Bool(bool b) { return document_.Bool(b); }
+        bool Int(int i) { return document_.Int(i); }
+        bool Uint(unsigned i) { return document_.Uint(i); }
+        bool Int64(int64_t i) { return document_.Int64(i); }
+        bool Uint64(uint64_t i) { return document_.Uint64(i); }
+        bool Double(double d) { return document_.Double(d); }
+        bool RawNumber(const Ch* str, SizeType length, bool copy) { return document_.RawNumber(str, length, copy); }
+        bool String(const Ch* str, SizeType length, bool copy) { return document_.String(str, length, copy); }
+        bool StartObject() { return ++depth_ <= maxDepth_ && document_.StartObject(); }
+        bool Key(const Ch* str, SizeType length, bool copy) { return document_.Key(str, length, copy); }
+        bool EndObject(SizeType memberCount) { --depth_; return document_.EndObject(memberCount); }
+        bool StartArray() { return ++depth_ <= maxDepth_ && document_.StartArray(); }
+        bool EndArray(SizeType elementCount) { --depth_; return document_.EndArray(elementCount); }
+
+    private:
+        DepthLimitedHandler(const DepthLimitedHandler&);
+        DepthLimitedHandler& operator=(const DepthLimitedHandler&);
+
+        DocumentType& document_;
+        unsigned depth_;
+        unsigned maxDepth_;
+    };
+
+    //! Generator for GenericDocument::Populate() which parses the elements of a slice.
+    template <unsigned parseFlags>
+    class SliceParser {
+    public:
+        SliceParser(const char* text, size_t limit, bool speculative, Slice& slice) : text_(text), limit_(limit), speculative_(speculative), slice_(slice) {}
+
+        bool operator()(DocumentType& document) {
+            GenericReader<UTF8<>, Encoding, StackAllocator> reader;
+            DepthLimitedHandler handler(document, speculative_ ? kMaxSpeculativeDepth : ~0u);
+            GenericStringStream<UTF8<> > is(text_);
+            is.src_ = text_ + slice_.begin + 1;
+            SizeType count = 0;
+
+            document.StartArray();
+            for (;;) {
+                SkipWhitespace(is);
+                bool afterComma = count > 0 || text_[slice_.begin] == ',';
+                if (is.Peek() == ']' && (!afterComma || (parseFlags & kParseTrailingCommasFlag))) {
+                    slice_.end = is.Tell();
+                    slice_.closed = true;
+                    break;
+                }
+
+                ParseResult result = reader.template Parse<parseFlags | kParseStopWhenDoneFlag>(is, handler);
+                if (result.IsError()) {
+                    // An element cut off by the end of the text is a missing value, as within an array
+                    slice_.result.Set(result.Code() == kParseErrorDocumentEmpty ? kParseErrorValueInvalid : result.Code(), result.Offset());
+                    return false;
+                }
+                count++;
+
+                SkipWhitespace(is);
+                if (is.Peek() == ',') {
+                    slice_.end = is.Tell();
+                    is.Take();
+                    if (slice_.end >= limit_)
+                        break;
+                }
+                else if (is.Peek() == ']') {
+                    slice_.end = is.Tell();
+                    slice_.closed = true;
+                    break;
+                }
+                else {
+                    slice_.result.Set(kParseErrorArrayMissCommaOrSquareBracket, is.Tell());
+                    return false;
+                }
+            }
+            return document.EndArray(count);
+        }
+
+    private:
+        SliceParser(const SliceParser&);
+        SliceParser& operator=(const SliceParser&);
+
+        const char* text_;
+        size_t limit_;
+        bool speculative_;
+        Slice& slice_;
+    };
+
+    //! Handler which compares a string with the name of a pointer token.
+    class KeyHandler : public BaseReaderHandler<Encoding, KeyHandler> {
+    public:
+        KeyHandler(const Ch* name, SizeType length) : name_(name), length_(length), equal_() {}
+
+        bool String(const Ch* str, SizeType length, bool) {
+            equal_ = length == length_ && std::memcmp(str, name_, length * sizeof(Ch)) == 0;
+            return true;
+        }
+
+        bool Equal() const { return equal_; }
+
+    private:
+        KeyHandler(const KeyHandler&);
+        KeyHandler& operator=(const KeyHandler&);
+
+        const Ch* name_;
+        SizeType length_;
+        bool equal_;
+    };
+
+    GenericParallelParser(const GenericParallelParser&);
+    GenericParallelParser& operator=(const GenericParallelParser&);
+
+    size_t WindowSize() const { return sliceSize_ * threadCount_; }
+
+    //! Append up to \c size bytes of a stream to a null-terminated buffer, and return whether the stream ended.
+    template <typename InputStream>
+    static bool Read(InputStream& is, Buffer& buffer, size_t size) {
+        if (!buffer.Empty())
+            buffer.template Pop<char>(1);
+        char* p = buffer.template Push<char>(size);
+        size_t n = internal::TakeBlock(is, p, size);
+        buffer.template Pop<char>(size - n);
+        *buffer.template Push<char>() = '\0';
+        return n < size;
+    }
+
+    //! Append bytes to a null-terminated buffer.
+    static void Append(Buffer& buffer, const char* s, size_t size) {
+        if (!buffer.Empty())
+            buffer.template Pop<char>(1);
+        if (size)
+            std::memcpy(buffer.template Push<char>(size), s, size);
+        *buffer.template Push<char>() = '\0';
+    }
+
+    //! Drop the text of the window before \c offset.
+    void Consume(size_t offset) {
+        char* text = text_.template Bottom<char>();
+        std::memmove(text, text + offset, text_.GetSize() - offset);
+        text_.template Pop<char>(offset);
+        base_ += offset;
+    }
+
+    void ClearElements() {
+        for (size_t i = 0; i < kept_.size(); i++)
+            RAPIDJSON_DELETE(kept_[i]);
+        kept_.clear();
+    }
+
+    //! Parse the whole text on the calling thread.
+    template <unsigned parseFlags>
+    ParseResult ParseSerial(DocumentType& document) {
+        GenericStringStream<UTF8<> > s(text_.template Bottom<char>());
+        document.template ParseStream<parseFlags, UTF8<> >(s);
+        ParseResult& result = document.parseResult_;
+        if (result.IsError())
+            result.Set(result.Code(), base_ + result.Offset());
+        return result;
+    }
+
+    //! Find an error in the text before the array, which comes before an error in the array.
+    template <unsigned parseFlags>
+    void CheckPrefix(size_t prefixLength, size_t prefixBase, ParseResult* error) {
+        Append(skeleton_, "[]", 2);
+        GenericReader<UTF8<>, Encoding, StackAllocator> reader;
+        BaseReaderHandler<Encoding> handler;
+        GenericStringStream<UTF8<> > s(skeleton_.template Bottom<char>());
+        ParseResult result = reader.template Parse<parseFlags>(s, handler);
+        if (result.IsError() && result.Offset() <= prefixLength)
+            error->Set(result.Code(), prefixBase + result.Offset());
+    }
+
+    //! Parse the slices of the window on worker threads, and keep the elements up to where the array ends, or the window is cut off.
+    /*! \param pos In: offset of the opening bracket or the comma to start at. Out: offset of the closing bracket,
+            or of the comma to continue at in the next window.
+        \return kWindowMore, kWindowClosed or kWindowError.
+    */
+    template <unsigned parseFlags, typename InputStream>
+    int ParseWindow(InputStream& is, bool& eof, Allocator& allocator, size_t* pos, ParseResult* error) {
+        const char* text = text_.template Bottom<char>();
+        const size_t length = text_.GetSize() - 1;
+        const size_t span = length - *pos;
+        size_t count = span / sliceSize_ + 1;
+        if (count > threadCount_)
+            count = threadCount_;
+
+        // A window which is not the last one leaves a quarter slice unparsed at its end
+        bounds_.resize(count + 1);
+        for (size_t j = 0; j < count; j++)
+            bounds_[j] = *pos + span / count * j;
+        bounds_[count] = eof ? length : length - span / count / 4;
+        slices_.assign(count, 0);
+
+        bool nextEof = eof;
+        if (count == 1 && eof)
+            slices_[0] = ParseSlice<parseFlags>(text, bounds_[0], bounds_[1], false);
+        else {
+            std::vector<std::thread> workers;
+            workers.reserve(count);
+            for (size_t j = 0; j < count; j++)
+                workers.push_back(std::thread([this, text, j]() { this->template ParseWorker<parseFlags>(text, j); }));
+            if (!eof)
+                nextEof = Read(is, next_, WindowSize());
+            for (size_t j = 0; j < count; j++)
+                workers[j].join();
+        }
+
+        int state = kWindowMore;
+        size_t begin = bounds_[0];
+        for (;;) {
+            if (!eof && begin >= bounds_[count])
+                break;
+
+            size_t j = count - 1;
+            while (bounds_[j] > begin)
+                j--;
+            Slice*& slice = slices_[j];
+            if (!slice || slice->begin != begin) {
+                RAPIDJSON_DELETE(slice);
+                slice = ParseSlice<parseFlags>(text, begin, bounds_[j + 1], false);
+            }
+
+            if (slice->result.IsError()) {
+                if (eof || slice->result.Offset() < bounds_[count]) {
+                    error->Set(slice->result.Code(), base_ + slice->result.Offset());
+                    state = kWindowError;
+                }
+                break; // Otherwise the element is cut off by the end of the window
+            }
+
+            internal::SpliceAllocator(allocator, slice->allocator);
+            kept_.push_back(slice);
+            slice = 0;
+
+            begin = kept_.back()->end;
+            if (kept_.back()->closed) {
+                state = kWindowClosed;
+                break;
+            }
+        }
+
+        for (size_t j = 0; j < count; j++)
+            RAPIDJSON_DELETE(slices_[j]);
+        *pos = begin;
+        eof = nextEof;
+        return state;
+    }
+
+    template <unsigned parseFlags>
+    void ParseWorker(const char* text, size_t j) {
+        if (j == 0)
+            slices_[0] = ParseSlice<parseFlags>(text, bounds_[0], bounds_[1], false);
+        else
+            slices_[j] = ParseSpeculative<parseFlags>(text, bounds_[j], bounds_[j + 1]);
+    }
+
+    //! Parse elements from the bracket or comma at \c begin, up to a comma at or past \c limit.
+    template <unsigned parseFlags>
+    Slice* ParseSlice(const char* text, size_t begin, size_t limit, bool speculative) const {
+        Slice* slice = RAPIDJSON_NEW(Slice());
+        slice->begin = begin;
+        SliceParser<parseFlags> parser(text, limit, speculative, *slice);
+        slice->document.Populate(parser);
+        return slice;
+    }
+
+    //! Parse a slice from the first comma in [begin, limit) which starts a chain of elements.
+    /*! A chain which ends at a closing bracket may have started in a nested array, so later
+        commas are tried too, and the chain which closes last is kept.
+    */
+    template <unsigned parseFlags>
+    Slice* ParseSpeculative(const char* text, size_t begin, size_t limit) const {
+        Slice* best = 0;
+        const char* p = text + begin;
+        const char* end = text + limit;
+        while (p < end && (p = static_cast<const char*>(std::memchr(p, ',', static_cast<size_t>(end - p)))) != 0) {
+            if (firstKind_ == kKindUnknown || Kind(*SkipSpace(p + 1)) == firstKind_) {
+                Slice* slice = ParseSlice<parseFlags>(text, static_cast<size_t>(p - text), limit, true);
+                if (!slice->result.IsError()) {
+                    RAPIDJSON_DELETE(best);
+                    best = slice;
+                    if (!slice->closed)
+                        break;
+                    p = text + slice->end;
+                }
+                else
+                    RAPIDJSON_DELETE(slice);
+            }
+            p++;
+        }
+        return best;
+    }
+
+    //! Find the opening bracket of the array at a pointer, by skipping the values before it.
+    /*! \return kLocateFound, kLocateMore if the window ends before it, or kLocateNone.
+    */
+    template <typename PointerType>
+    int Locate(const PointerType& path, size_t* offset) const {
+        const char* text = text_.template Bottom<char>();
+        const char* p = SkipSpace(text);
+        for (size_t i = 0; i < path.GetTokenCount(); i++) {
+            const typename PointerType::Token& token = path.GetTokens()[i];
+            if (*p == '{') {
+                for (p = SkipSpace(p + 1); ; p = SkipSpace(p + 1)) {
+                    if (*p != '"')
+                        return LocateFailed(p);
+                    bool found = KeyEquals(p, token.name, token.length);
+                    p = SkipSpace(SkipString(p));
+                    if (*p != ':')
+                        return LocateFailed(p);
+                    p = SkipSpace(p + 1);
+                    if (found)
+                        break;
+                    p = SkipSpace(SkipValue(p));
+                    if (*p != ',')
+                        return LocateFailed(p);
+                }
+            }
+            else if (*p == '[' && token.index != kPointerInvalidIndex) {
+                p = SkipSpace(p + 1);
+                for (SizeType k = 0; k < token.index; k++) {
+                    p = SkipSpace(SkipValue(p));
+                    if (*p != ',')
+                        return LocateFailed(p);
+                    p = SkipSpace(p + 1);
+                }
+            }
+            else
+                return LocateFailed(p);
+        }
+        if (*p != '[')
+            return LocateFailed(p);
+        *offset = static_cast<size_t>(p - text);
+        return kLocateFound;
+    }
+
+    static int LocateFailed(const char* p) {
+        return *p == '\0' ? kLocateMore : kLocateNone;
+    }
+
+    bool KeyEquals(const char* key, const Ch* name, SizeType length) const {
+        GenericReader<UTF8<>, Encoding, StackAllocator> reader;
+        KeyHandler handler(name, length);
+        GenericStringStream<UTF8<> > is(key);
+        reader.template Parse<kParseStopWhenDoneFlag>(is, handler);
+        return handler.Equal();
+    }
+
+    static const char* SkipSpace(const char* p) {
+        while (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')
+            ++p;
+        return p;
+    }
+
+    static const char* SkipString(const char* p) {
+        for (++p; *p != '"'; ++p) {
+            if (*p == '\0' || (*p == '\\' && *++p == '\0'))
+                return p;
+        }
+        return p + 1;
+    }
+
+    //! Skip a value without validating it, stopping at the end of the text.
+    static const char* SkipValue(const char* p) {
+        if (*p == '"')
+            return SkipString(p);
+        if (*p != '{' && *p != '[') {
+            while (*p != '\0' && *p != ',' && *p != '}' && *p != ']' && *p != ' ' && *p != '\n' && *p != '\r' && *p != '\t')
+                ++p;
+            return p;
+        }
+        size_t depth = 0;
+        do {
+            switch (*p) {
+            case '"':
+                p = SkipString(p);
+                continue;
+            case '{':
+            case '[':
+                depth++;
+                break;
+            case '}':
+            case ']':
+                depth--;
+                break;
+            case '\0':
+                return p;
+            default:
+                break;
+            }
+            ++p;
+        } while (depth > 0);
+        return p;
+    }
+
+    //! Kind of value a character starts, for finding slices which start like the first element.
+    static int Kind(char c) {
+        switch (c) {
+        case '{': return kKindObject;
+        case '[': return kKindArray;
+        case '"': return kKindString;
+        default:
+            return (c >= '0' && c <= '9') || c == '-' || c == 'N' || c == 'I' ? kKindNumber : kKindUnknown;
+        }
+    }
+
+    static const size_t kDefaultSliceSize = 4 * 1024 * 1024;
+    static const size_t kDefaultBufferCapacity = 1024;
+    static const unsigned kMaxSpeculativeDepth = 512;
+
+    unsigned threadCount_;
+    size_t sliceSize_;
+    Buffer text_;                   //!< Window of the input, null-terminated.
+    Buffer next_;                   //!< Input read while the window is parsed.
+    Buffer skeleton_;               //!< Input with the array left empty.
+    std::vector<Slice*> kept_;      //!< Slices whose elements are kept, moved into the array at the end.
+    std::vector<size_t> bounds_;    //!< Offsets at which the slices of the window start, and the window is cut off.
+    std::vector<Slice*> slices_;
+    size_t base_;                   //!< Offset of the window in the input.
+    int firstKind_;                 //!< Kind of the first element.
+};
+
+//! Parallel parser with UTF8 encoding and the default allocators.
+typedef GenericParallelParser<UTF8<> > ParallelParser;
+
+RAPIDJSON_NAMESPACE_END
+
+#ifdef __clang__
+RAPIDJSON_DIAG_POP
+#endif
+
+#endif // RAPIDJSON_PARALLELPARSER_H_
@@ -320,30 +320,57 @@
 #endif
 
 ///////////////////////////////////////////////////////////////////////////////
-// RAPIDJSON_SSE2/RAPIDJSON_SSE42/RAPIDJSON_SIMD
+// RAPIDJSON_SSE2/RAPIDJSON_SSE42/RAPIDJSON_AVX2/RAPIDJSON_AVX512/RAPIDJSON_SIMD
 
 /*! \def RAPIDJSON_SIMD
     \ingroup RAPIDJSON_CONFIG
-    \brief Enable SSE2/SSE4.2 optimization.
+    \brief Enable SSE2/SSE4.2/AVX2/AVX-512 optimization.
 
     RapidJSON supports optimized implementations for some parsing operations
-    based on the SSE2 or SSE4.2 SIMD extensions on modern Intel-compatible
-    processors.
+    based on the SSE2, SSE4.2, AVX2 or AVX-512BW SIMD extensions on modern
+    Intel-compatible processors.
 
-    To enable these optimizations, two different symbols can be defined;
+    To enable these optimizations, different symbols can be defined;
     \code
     // Enable SSE2 optimization.
     #define RAPIDJSON_SSE2
 
     // Enable SSE4.2 optimization.
     #define RAPIDJSON_SSE42
+
+    // Enable AVX2 optimization (32 characters at once).
+    #define RAPIDJSON_AVX2
+
+    // Enable AVX-512BW optimization (64 characters at once).
+    #define RAPIDJSON_AVX512
+
+    // Compile the SSE, AVX2 and AVX-512BW code and choose at run time.
+    #define RAPIDJSON_SIMD_DISPATCH
     \endcode
 
-    \c RAPIDJSON_SSE42 takes precedence, if both are defined.
+    \c RAPIDJSON_SSE42 takes precedence over \c RAPIDJSON_SSE2, and the AVX
+    symbols take precedence over both, the wider one first. \c RAPIDJSON_AVX2
+    and \c RAPIDJSON_AVX512 require the compiler to target that instruction
+    set (e.g. \c -mavx2 or \c -mavx512bw), so the binary only runs on such
+    processors.
+
+    \c RAPIDJSON_SIMD_DISPATCH does not: with gcc and clang the AVX code is
+    compiled with per-function target attributes, and the widest instruction
+    set supported by the processor is detected once with CPUID. One binary then
+    uses AVX-512BW, AVX2 or SSE, whichever is available.
+
+    The AVX code falls back to SSE on some paths, so if neither
+    \c RAPIDJSON_SSE2 nor \c RAPIDJSON_SSE42 is defined together with an AVX
+    symbol, \c RAPIDJSON_SSE2 is defined as well.
 
     If any of these symbols is defined, RapidJSON defines the macro
     \c RAPIDJSON_SIMD to indicate the availability of the optimized code.
 */
+#if (defined(RAPIDJSON_AVX2) || defined(RAPIDJSON_AVX512) || defined(RAPIDJSON_SIMD_DISPATCH)) \
+    && !defined(RAPIDJSON_SSE2) && !defined(RAPIDJSON_SSE42)
+#define RAPIDJSON_SSE2
+#endif
+
 #if defined(RAPIDJSON_SSE2) || defined(RAPIDJSON_SSE42) \
     || defined(RAPIDJSON_DOXYGEN_RUNNING)
 #define RAPIDJSON_SIMD
@@ -576,6 +603,17 @@ RAPIDJSON_NAMESPACE_END
 #endif
 #endif // RAPIDJSON_HAS_CXX11_RANGE_FOR
 
+#ifndef RAPIDJSON_HAS_CXX11_THREAD
+#if defined(__clang__)
+#define RAPIDJSON_HAS_CXX11_THREAD (__cplusplus >= 201103L)
+#elif (defined(RAPIDJSON_GNUC) && (RAPIDJSON_GNUC >= RAPIDJSON_VERSION_CODE(4,7,0)) && defined(__GXX_EXPERIMENTAL_CXX0X__)) || \
+      (defined(_MSC_VER) && _MSC_VER >= 1700)
+#define RAPIDJSON_HAS_CXX11_THREAD 1
+#else
+#define RAPIDJSON_HAS_CXX11_THREAD 0
+#endif
+#endif // RAPIDJSON_HAS_CXX11_THREAD
+
 //!@endcond
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -23,6 +23,8 @@
 #include "internal/meta.h"
 #include "internal/stack.h"
 #include "internal/strtod.h"
+#include "internal/simd.h"
+#include "internal/structuralindex.h"
 #include <limits>
 
 #if defined(RAPIDJSON_SIMD) && defined(_MSC_VER)
@@ -148,11 +150,12 @@ enum ParseFlag {
     kParseValidateEncodingFlag = 2, //!< Validate encoding of JSON strings.
     kParseIterativeFlag = 4,        //!< Iterative(constant complexity in terms of function call stack size) parsing.
     kParseStopWhenDoneFlag = 8,     //!< After parsing a complete JSON root from stream, stop further processing the rest of stream. When this flag is used, parser will not generate kParseErrorDocumentRootNotSingular error.
-    kParseFullPrecisionFlag = 16,   //!< Parse number in full precision (but slower).
+    kParseFullPrecisionFlag = 16,   //!< Parse number in full precision (slower on streams other than string streams).
     kParseCommentsFlag = 32,        //!< Allow one-line (//) and multi-line (/**/) comments.
     kParseNumbersAsStringsFlag = 64,    //!< Parse all numbers (ints/doubles) as strings.
     kParseTrailingCommasFlag = 128, //!< Allow trailing commas at the end of objects and arrays.
     kParseNanAndInfFlag = 256,      //!< Allow parsing NaN, Inf, Infinity, -Inf and -Infinity as doubles.
+    kParseStructuralIndexFlag = 512,    //!< Index the tokens of a null-terminated UTF-8 string with SIMD before parsing, and parse from these positions. Other streams, comments and iterative parsing are parsed as without this flag.
     kParseDefaultFlags = RAPIDJSON_PARSE_DEFAULT_FLAGS  //!< Default parse flags. Can be customized by defining RAPIDJSON_PARSE_DEFAULT_FLAGS
 };
 
@@ -258,7 +261,7 @@ private:
 
 //! Skip the JSON white spaces in a stream.
 /*! \param is A input stream for skipping white spaces.
-    \note This function has SSE2/SSE4.2 specialization.
+    \note This function has SSE2/SSE4.2/AVX2/AVX-512BW specialization.
 */
 template<typename InputStream>
 void SkipWhitespace(InputStream& is) {
@@ -427,22 +430,594 @@ inline const char *SkipWhitespace_SIMD(const char* p, const char* end) {
 
 #endif // RAPIDJSON_SSE2
 
+#ifdef RAPIDJSON_SIMD_HAS_AVX2
+//! Skip whitespace with AVX2 instructions, testing 32 8-byte characters at once.
+RAPIDJSON_TARGET_AVX2 inline const char *SkipWhitespace_AVX2(const char* p) {
+    // Fast return for single non-whitespace
+    if (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')
+        ++p;
+    else
+        return p;
+
+    // Short runs such as indentation usually end before 16-byte alignment, which is cheaper to scan one by one
+    const char* nextAligned = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) + 15) & static_cast<size_t>(~15));
+    while (p != nextAligned)
+        if (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')
+            ++p;
+        else
+            return p;
+
+    // A 32-byte load may cross page boundary only when it is close to the end of page, scan one by one until alignment then
+    if ((reinterpret_cast<size_t>(p) & 4095) > 4096 - 32) {
+        nextAligned = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) + 31) & static_cast<size_t>(~31));
+        while (p != nextAligned)
+            if (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')
+                ++p;
+            else
+                return p;
+    }
+
+    const __m256i w0 = _mm256_set1_epi8(' ');
+    const __m256i w1 = _mm256_set1_epi8('\n');
+    const __m256i w2 = _mm256_set1_epi8('\r');
+    const __m256i w3 = _mm256_set1_epi8('\t');
+
+    // The first load may be unaligned, the rest are aligned
+    for (;;) {
+        const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        __m256i x = _mm256_cmpeq_epi8(s, w0);
+        x = _mm256_or_si256(x, _mm256_cmpeq_epi8(s, w1));
+        x = _mm256_or_si256(x, _mm256_cmpeq_epi8(s, w2));
+        x = _mm256_or_si256(x, _mm256_cmpeq_epi8(s, w3));
+        const uint32_t r = ~static_cast<uint32_t>(_mm256_movemask_epi8(x));
+        if (r != 0)     // some of characters is non-whitespace
+            return p + internal::LowestBit(r);
+        p = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) + 32) & static_cast<size_t>(~31));
+    }
+}
+
+RAPIDJSON_TARGET_AVX2 inline const char *SkipWhitespace_AVX2(const char* p, const char* end) {
+    // Fast return for single non-whitespace
+    if (p != end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t'))
+        ++p;
+    else
+        return p;
+
+    const __m256i w0 = _mm256_set1_epi8(' ');
+    const __m256i w1 = _mm256_set1_epi8('\n');
+    const __m256i w2 = _mm256_set1_epi8('\r');
+    const __m256i w3 = _mm256_set1_epi8('\t');
+
+    for (; end - p >= 32; p += 32) {
+        const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        __m256i x = _mm256_cmpeq_epi8(s, w0);
+        x = _mm256_or_si256(x, _mm256_cmpeq_epi8(s, w1));
+        x = _mm256_or_si256(x, _mm256_cmpeq_epi8(s, w2));
+        x = _mm256_or_si256(x, _mm256_cmpeq_epi8(s, w3));
+        const uint32_t r = ~static_cast<uint32_t>(_mm256_movemask_epi8(x));
+        if (r != 0)     // some of characters is non-whitespace
+            return p + internal::LowestBit(r);
+    }
+
+    return SkipWhitespace(p, end);
+}
+
+//! Find the first quotation mark, backslash or control character with AVX2 instructions.
+/*! The string must be terminated by one of them, e.g. by '\\0'.
+*/
+RAPIDJSON_TARGET_AVX2 inline const char *ScanUnescapedString_AVX2(const char* p) {
+    // Scan one by one until alignment if the first 32-byte load would cross page boundary
+    if ((reinterpret_cast<size_t>(p) & 4095) > 4096 - 32) {
+        const char* nextAligned = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) + 31) & static_cast<size_t>(~31));
+        for (; p != nextAligned; p++)
+            if (RAPIDJSON_UNLIKELY(*p == '\"') || RAPIDJSON_UNLIKELY(*p == '\\') || RAPIDJSON_UNLIKELY(static_cast<unsigned>(*p) < 0x20))
+                return p;
+    }
+
+    const __m256i dq = _mm256_set1_epi8('\"');
+    const __m256i bs = _mm256_set1_epi8('\\');
+    const __m256i sp = _mm256_set1_epi8(0x1F);
+
+    for (;;) {
+        const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        const __m256i t1 = _mm256_cmpeq_epi8(s, dq);
+        const __m256i t2 = _mm256_cmpeq_epi8(s, bs);
+        const __m256i t3 = _mm256_cmpeq_epi8(_mm256_max_epu8(s, sp), sp); // s < 0x20 <=> max(s, 0x1F) == 0x1F
+        const __m256i x = _mm256_or_si256(_mm256_or_si256(t1, t2), t3);
+        const uint32_t r = static_cast<uint32_t>(_mm256_movemask_epi8(x));
+        if (RAPIDJSON_UNLIKELY(r != 0))   // some of characters is escaped
+            return p + internal::LowestBit(r);
+        p = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) + 32) & static_cast<size_t>(~31));
+    }
+}
+
+//! Copy characters to os until the first quotation mark, backslash or control character with AVX2 instructions.
+/*! \tparam OutputStream Provides \c Push(count) for reserving \c count characters.
+    For in-situ parsing the destination may overlap the source, as long as it is not ahead of it.
+*/
+template <typename OutputStream>
+RAPIDJSON_TARGET_AVX2 inline const char *ScanCopyUnescapedString_AVX2(const char* p, OutputStream& os) {
+    const __m256i dq = _mm256_set1_epi8('\"');
+    const __m256i bs = _mm256_set1_epi8('\\');
+    const __m256i sp = _mm256_set1_epi8(0x1F);
+
+    for (;; p += 32) {
+        // Blocks are copied as a whole so loads stay unaligned, scan one by one near the end of page
+        if (RAPIDJSON_UNLIKELY((reinterpret_cast<size_t>(p) & 4095) > 4096 - 32)) {
+            const char* nextPage = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) | 4095) + 1);
+            for (; p != nextPage; p++)
+                if (RAPIDJSON_UNLIKELY(*p == '\"') || RAPIDJSON_UNLIKELY(*p == '\\') || RAPIDJSON_UNLIKELY(static_cast<unsigned>(*p) < 0x20))
+                    return p;
+                else
+                    *static_cast<char*>(os.Push(1)) = *p;
+        }
+
+        const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        const __m256i t1 = _mm256_cmpeq_epi8(s, dq);
+        const __m256i t2 = _mm256_cmpeq_epi8(s, bs);
+        const __m256i t3 = _mm256_cmpeq_epi8(_mm256_max_epu8(s, sp), sp); // s < 0x20 <=> max(s, 0x1F) == 0x1F
+        const __m256i x = _mm256_or_si256(_mm256_or_si256(t1, t2), t3);
+        const uint32_t r = static_cast<uint32_t>(_mm256_movemask_epi8(x));
+        if (RAPIDJSON_UNLIKELY(r != 0)) {   // some of characters is escaped
+            const SizeType length = static_cast<SizeType>(internal::LowestBit(r));
+            char* q = static_cast<char*>(os.Push(length));
+            for (SizeType i = 0; i < length; i++)
+                q[i] = p[i];
+            return p + length;
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(os.Push(32)), s);
+    }
+}
+#endif // RAPIDJSON_SIMD_HAS_AVX2
+
+#ifdef RAPIDJSON_SIMD_HAS_AVX512
+//! Skip whitespace with AVX-512BW instructions, testing 64 8-byte characters at once.
+RAPIDJSON_TARGET_AVX512 inline const char *SkipWhitespace_AVX512(const char* p) {
+    // Fast return for single non-whitespace
+    if (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')
+        ++p;
+    else
+        return p;
+
+    // Short runs such as indentation usually end before 16-byte alignment, which is cheaper to scan one by one
+    const char* nextAligned = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) + 15) & static_cast<size_t>(~15));
+    while (p != nextAligned)
+        if (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')
+            ++p;
+        else
+            return p;
+
+    // A 64-byte load may cross page boundary only when it is close to the end of page, scan one by one until alignment then
+    if ((reinterpret_cast<size_t>(p) & 4095) > 4096 - 64) {
+        nextAligned = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) + 63) & static_cast<size_t>(~63));
+        while (p != nextAligned)
+            if (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')
+                ++p;
+            else
+                return p;
+    }
+
+    const __m512i w0 = _mm512_set1_epi8(' ');
+    const __m512i w1 = _mm512_set1_epi8('\n');
+    const __m512i w2 = _mm512_set1_epi8('\r');
+    const __m512i w3 = _mm512_set1_epi8('\t');
+
+    // The first load may be unaligned, the rest are aligned
+    for (;;) {
+        const __m512i s = _mm512_loadu_si512(p);
+        const uint64_t r = ~static_cast<uint64_t>(
+            _mm512_cmpeq_epi8_mask(s, w0) | _mm512_cmpeq_epi8_mask(s, w1) |
+            _mm512_cmpeq_epi8_mask(s, w2) | _mm512_cmpeq_epi8_mask(s, w3));
+        if (r != 0)     // some of characters is non-whitespace
+            return p + internal::LowestBit(r);
+        p = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) + 64) & static_cast<size_t>(~63));
+    }
+}
+
+RAPIDJSON_TARGET_AVX512 inline const char *SkipWhitespace_AVX512(const char* p, const char* end) {
+    // Fast return for single non-whitespace
+    if (p != end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t'))
+        ++p;
+    else
+        return p;
+
+    const __m512i w0 = _mm512_set1_epi8(' ');
+    const __m512i w1 = _mm512_set1_epi8('\n');
+    const __m512i w2 = _mm512_set1_epi8('\r');
+    const __m512i w3 = _mm512_set1_epi8('\t');
+
+    // Masked load for the tail, which does not fault on the bytes beyond end
+    while (p != end) {
+        const size_t n = static_cast<size_t>(end - p);
+        const uint64_t valid = n >= 64 ? ~static_cast<uint64_t>(0) : (static_cast<uint64_t>(1) << n) - 1;
+        const __m512i s = _mm512_maskz_loadu_epi8(valid, p);
+        const uint64_t r = ~static_cast<uint64_t>(
+            _mm512_cmpeq_epi8_mask(s, w0) | _mm512_cmpeq_epi8_mask(s, w1) |
+            _mm512_cmpeq_epi8_mask(s, w2) | _mm512_cmpeq_epi8_mask(s, w3)) & valid;
+        if (r != 0)     // some of characters is non-whitespace
+            return p + internal::LowestBit(r);
+        p += n >= 64 ? 64 : n;
+    }
+    return p;
+}
+
+//! Find the first quotation mark, backslash or control character with AVX-512BW instructions.
+/*! The string must be terminated by one of them, e.g. by '\\0'.
+*/
+RAPIDJSON_TARGET_AVX512 inline const char *ScanUnescapedString_AVX512(const char* p) {
+    // Scan one by one until alignment if the first 64-byte load would cross page boundary
+    if ((reinterpret_cast<size_t>(p) & 4095) > 4096 - 64) {
+        const char* nextAligned = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) + 63) & static_cast<size_t>(~63));
+        for (; p != nextAligned; p++)
+            if (RAPIDJSON_UNLIKELY(*p == '\"') || RAPIDJSON_UNLIKELY(*p == '\\') || RAPIDJSON_UNLIKELY(static_cast<unsigned>(*p) < 0x20))
+                return p;
+    }
+
+    const __m512i dq = _mm512_set1_epi8('\"');
+    const __m512i bs = _mm512_set1_epi8('\\');
+    const __m512i sp = _mm512_set1_epi8(0x20);
+
+    for (;;) {
+        const __m512i s = _mm512_loadu_si512(p);
+        const uint64_t r = static_cast<uint64_t>(
+            _mm512_cmpeq_epi8_mask(s, dq) | _mm512_cmpeq_epi8_mask(s, bs) | _mm512_cmplt_epu8_mask(s, sp));
+        if (RAPIDJSON_UNLIKELY(r != 0))   // some of characters is escaped
+            return p + internal::LowestBit(r);
+        p = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) + 64) & static_cast<size_t>(~63));
+    }
+}
+
+//! Copy characters to os until the first quotation mark, backslash or control character with AVX-512BW instructions.
+/*! \see ScanCopyUnescapedString_AVX2
+*/
+template <typename OutputStream>
+RAPIDJSON_TARGET_AVX512 inline const char *ScanCopyUnescapedString_AVX512(const char* p, OutputStream& os) {
+    const __m512i dq = _mm512_set1_epi8('\"');
+    const __m512i bs = _mm512_set1_epi8('\\');
+    const __m512i sp = _mm512_set1_epi8(0x20);
+
+    for (;; p += 64) {
+        // Blocks are copied as a whole so loads stay unaligned, scan one by one near the end of page
+        if (RAPIDJSON_UNLIKELY((reinterpret_cast<size_t>(p) & 4095) > 4096 - 64)) {
+            const char* nextPage = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) | 4095) + 1);
+            for (; p != nextPage; p++)
+                if (RAPIDJSON_UNLIKELY(*p == '\"') || RAPIDJSON_UNLIKELY(*p == '\\') || RAPIDJSON_UNLIKELY(static_cast<unsigned>(*p) < 0x20))
+                    return p;
+                else
+                    *static_cast<char*>(os.Push(1)) = *p;
+        }
+
+        const __m512i s = _mm512_loadu_si512(p);
+        const uint64_t r = static_cast<uint64_t>(
+            _mm512_cmpeq_epi8_mask(s, dq) | _mm512_cmpeq_epi8_mask(s, bs) | _mm512_cmplt_epu8_mask(s, sp));
+        if (RAPIDJSON_UNLIKELY(r != 0)) {   // some of characters is escaped
+            const SizeType length = static_cast<SizeType>(internal::LowestBit(r));
+            _mm512_mask_storeu_epi8(os.Push(length), (r - 1) & ~r, s); // the characters before the lowest set bit
+            return p + length;
+        }
+        _mm512_storeu_si512(os.Push(64), s);
+    }
+}
+#endif // RAPIDJSON_SIMD_HAS_AVX512
+
+#if defined(RAPIDJSON_SSE42) || defined(RAPIDJSON_SIMD_HAS_AVX2)
+//! Nibble tables of the UTF-8 validation by Keiser and Lemire, "Validating UTF-8 In Less Than One Instruction Per Byte" (2021).
+/*! Rows are indexed by the high and the low nibble of a byte, and by the high
+    nibble of the byte after it. Each bit stands for one kind of error, such as
+    an overlong form or a surrogate, and the pair is invalid if all three
+    entries have it. Missing continuation bytes of 3- and 4-byte sequences are
+    checked separately.
+*/
+inline const unsigned char* GetUTF8ValidationTables() {
+    static const unsigned char tables[48] = {
+        0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x80, 0x80, 0x80, 0x80, 0x21, 0x01, 0x15, 0x49,
+        0xE7, 0xA3, 0x83, 0x83, 0x8B, 0xCB, 0xCB, 0xCB, 0xCB, 0xCB, 0xCB, 0xCB, 0xCB, 0xDB, 0xCB, 0xCB,
+        0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0xE6, 0xAE, 0xBA, 0xBA, 0x01, 0x01, 0x01, 0x01
+    };
+    return tables;
+}
+
+//! Number of bytes at the end of a block which start a character that continues after it.
+inline unsigned UTF8IncompleteTail(const char* end) {
+    if (static_cast<unsigned char>(end[-1]) >= 0xC0)
+        return 1;
+    if (static_cast<unsigned char>(end[-2]) >= 0xE0)
+        return 2;
+    if (static_cast<unsigned char>(end[-3]) >= 0xF0)
+        return 3;
+    return 0;
+}
+
+//! Skip ASCII characters other than quotation mark, backslash and control characters until the end of page.
+/*! Used instead of a block load which would cross the page boundary.
+    \return The end of page, or the first character the caller has to look at.
+*/
+inline const char* ScanValidUnescapedStringToPage(const char* p) {
+    const char* nextPage = reinterpret_cast<const char*>((reinterpret_cast<size_t>(p) | 4095) + 1);
+    for (; p != nextPage; p++)
+        if (RAPIDJSON_UNLIKELY(*p == '\"') || RAPIDJSON_UNLIKELY(*p == '\\') || RAPIDJSON_UNLIKELY(static_cast<unsigned char>(*p) < 0x20) || RAPIDJSON_UNLIKELY(static_cast<unsigned char>(*p) >= 0x80))
+            break;
+    return p;
+}
+#endif
+
+#ifdef RAPIDJSON_SSE42
+//! Find the end of a run of valid UTF-8 without quotation mark, backslash or control character with SSE4.2 instructions.
+/*! Blocks of ASCII are only compared, others go through the table lookups.
+    The returned position is always a character boundary. If a block is
+    invalid, it stops at its start, for the reader to find and report the error
+    character by character. The string must be terminated, e.g. by '\\0'.
+*/
+inline const char *ScanValidUnescapedString_SIMD(const char* p) {
+    const unsigned char* tables = GetUTF8ValidationTables();
+    const __m128i byte1High = _mm_loadu_si128(reinterpret_cast<const __m128i *>(tables));
+    const __m128i byte1Low = _mm_loadu_si128(reinterpret_cast<const __m128i *>(tables + 16));
+    const __m128i byte2High = _mm_loadu_si128(reinterpret_cast<const __m128i *>(tables + 32));
+    const __m128i dq = _mm_set1_epi8('\"');
+    const __m128i bs = _mm_set1_epi8('\\');
+    const __m128i sp = _mm_set1_epi8(0x1F);
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const __m128i third = _mm_set1_epi8(0xE0 - 0x80);  // 111_____ - third >= 0x80
+    const __m128i fourth = _mm_set1_epi8(0xF0 - 0x80); // 1111____ - fourth >= 0x80
+    const __m128i msb = _mm_set1_epi8(static_cast<char>(0x80));
+
+    for (;;) {
+        if (RAPIDJSON_UNLIKELY((reinterpret_cast<size_t>(p) & 4095) > 4096 - 16)) {
+            const char* q = ScanValidUnescapedStringToPage(p);
+            if (reinterpret_cast<size_t>(q) & 4095)
+                return q;
+            p = q;
+        }
+
+        const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        const __m128i x = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(s, dq), _mm_cmpeq_epi8(s, bs)), _mm_cmpeq_epi8(_mm_max_epu8(s, sp), sp));
+        const unsigned stop = static_cast<unsigned>(_mm_movemask_epi8(x));
+        const unsigned high = static_cast<unsigned>(_mm_movemask_epi8(s));
+        if (RAPIDJSON_LIKELY((stop | high) == 0)) {
+            p += 16;
+            continue;
+        }
+
+        unsigned length = stop != 0 ? internal::LowestBit(static_cast<uint32_t>(stop)) : 16;
+        if ((high & ((1u << length) - 1)) == 0)
+            return p + length;
+
+        const __m128i prev1 = _mm_slli_si128(s, 1);
+        const __m128i prev2 = _mm_slli_si128(s, 2);
+        const __m128i prev3 = _mm_slli_si128(s, 3);
+        const __m128i special = _mm_and_si128(_mm_and_si128(
+            _mm_shuffle_epi8(byte1High, _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble)),
+            _mm_shuffle_epi8(byte1Low, _mm_and_si128(prev1, nibble))),
+            _mm_shuffle_epi8(byte2High, _mm_and_si128(_mm_srli_epi16(s, 4), nibble)));
+        const __m128i must23 = _mm_and_si128(_mm_or_si128(_mm_subs_epu8(prev2, third), _mm_subs_epu8(prev3, fourth)), msb);
+        const unsigned errors = ~static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_xor_si128(must23, special), _mm_setzero_si128()))) & 0xFFFF;
+
+        // Do not split a character at the end of the block. Errors of a sequence may show
+        // at the byte after it, so a truncated or invalid one is found up to that position.
+        if (stop == 0)
+            length -= UTF8IncompleteTail(p + 16);
+        if ((errors & ((2u << length) - 1)) != 0)
+            return p;
+        if (stop != 0)
+            return p + length;
+        p += length;
+    }
+}
+#endif // RAPIDJSON_SSE42
+
+#ifdef RAPIDJSON_SIMD_HAS_AVX2
+//! Find the end of a run of valid UTF-8 without quotation mark, backslash or control character with AVX2 instructions.
+/*! \see ScanValidUnescapedString_SIMD
+*/
+RAPIDJSON_TARGET_AVX2 inline const char *ScanValidUnescapedString_AVX2(const char* p) {
+    const unsigned char* tables = GetUTF8ValidationTables();
+    const __m256i byte1High = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(tables)));
+    const __m256i byte1Low = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(tables + 16)));
+    const __m256i byte2High = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(tables + 32)));
+    const __m256i dq = _mm256_set1_epi8('\"');
+    const __m256i bs = _mm256_set1_epi8('\\');
+    const __m256i sp = _mm256_set1_epi8(0x1F);
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    const __m256i third = _mm256_set1_epi8(0xE0 - 0x80);
+    const __m256i fourth = _mm256_set1_epi8(0xF0 - 0x80);
+    const __m256i msb = _mm256_set1_epi8(static_cast<char>(0x80));
+
+    for (;;) {
+        if (RAPIDJSON_UNLIKELY((reinterpret_cast<size_t>(p) & 4095) > 4096 - 32)) {
+            const char* q = ScanValidUnescapedStringToPage(p);
+            if (reinterpret_cast<size_t>(q) & 4095)
+                return q;
+            p = q;
+        }
+
+        const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        const __m256i x = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(s, dq), _mm256_cmpeq_epi8(s, bs)), _mm256_cmpeq_epi8(_mm256_max_epu8(s, sp), sp));
+        const uint64_t stop = static_cast<uint32_t>(_mm256_movemask_epi8(x));
+        const uint64_t high = static_cast<uint32_t>(_mm256_movemask_epi8(s));
+        if (RAPIDJSON_LIKELY((stop | high) == 0)) {
+            p += 32;
+            continue;
+        }
+
+        unsigned length = stop != 0 ? internal::LowestBit(stop) : 32;
+        if ((high & ((static_cast<uint64_t>(1) << length) - 1)) == 0)
+            return p + length;
+
+        const __m256i lanes = _mm256_permute2x128_si256(s, s, 0x08); // Lower lane moved up, zeros below
+        const __m256i prev1 = _mm256_alignr_epi8(s, lanes, 16 - 1);
+        const __m256i prev2 = _mm256_alignr_epi8(s, lanes, 16 - 2);
+        const __m256i prev3 = _mm256_alignr_epi8(s, lanes, 16 - 3);
+        const __m256i special = _mm256_and_si256(_mm256_and_si256(
+            _mm256_shuffle_epi8(byte1High, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble)),
+            _mm256_shuffle_epi8(byte1Low, _mm256_and_si256(prev1, nibble))),
+            _mm256_shuffle_epi8(byte2High, _mm256_and_si256(_mm256_srli_epi16(s, 4), nibble)));
+        const __m256i must23 = _mm256_and_si256(_mm256_or_si256(_mm256_subs_epu8(prev2, third), _mm256_subs_epu8(prev3, fourth)), msb);
+        const uint64_t errors = ~static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_xor_si256(must23, special), _mm256_setzero_si256())));
+
+        if (stop == 0)
+            length -= UTF8IncompleteTail(p + 32);
+        if ((errors & ((static_cast<uint64_t>(2) << length) - 1)) != 0)
+            return p;
+        if (stop != 0)
+            return p + length;
+        p += length;
+    }
+}
+#endif // RAPIDJSON_SIMD_HAS_AVX2
+
+#ifdef RAPIDJSON_SIMD_HAS_AVX512
+//! Find the end of a run of valid UTF-8 without quotation mark, backslash or control character with AVX-512BW instructions.
+/*! \see ScanValidUnescapedString_SIMD
+*/
+RAPIDJSON_TARGET_AVX512 inline const char *ScanValidUnescapedString_AVX512(const char* p) {
+    const unsigned char* tables = GetUTF8ValidationTables();
+    const __m512i byte1High = _mm512_maskz_broadcast_i32x4(0xFFFF, _mm_loadu_si128(reinterpret_cast<const __m128i *>(tables)));
+    const __m512i byte1Low = _mm512_maskz_broadcast_i32x4(0xFFFF, _mm_loadu_si128(reinterpret_cast<const __m128i *>(tables + 16)));
+    const __m512i byte2High = _mm512_maskz_broadcast_i32x4(0xFFFF, _mm_loadu_si128(reinterpret_cast<const __m128i *>(tables + 32)));
+    const __m512i dq = _mm512_set1_epi8('\"');
+    const __m512i bs = _mm512_set1_epi8('\\');
+    const __m512i sp = _mm512_set1_epi8(0x20);
+    const __m512i nibble = _mm512_set1_epi8(0x0F);
+    const __m512i third = _mm512_set1_epi8(0xE0 - 0x80);
+    const __m512i fourth = _mm512_set1_epi8(0xF0 - 0x80);
+    const __m512i msb = _mm512_set1_epi8(static_cast<char>(0x80));
+    const __m512i laneUp = _mm512_set_epi64(5, 4, 3, 2, 1, 0, 7, 6);
+
+    for (;;) {
+        if (RAPIDJSON_UNLIKELY((reinterpret_cast<size_t>(p) & 4095) > 4096 - 64)) {
+            const char* q = ScanValidUnescapedStringToPage(p);
+            if (reinterpret_cast<size_t>(q) & 4095)
+                return q;
+            p = q;
+        }
+
+        const __m512i s = _mm512_loadu_si512(p);
+        const uint64_t stop = static_cast<uint64_t>(
+            _mm512_cmpeq_epi8_mask(s, dq) | _mm512_cmpeq_epi8_mask(s, bs) | _mm512_cmplt_epu8_mask(s, sp));
+        const uint64_t high = static_cast<uint64_t>(_mm512_movepi8_mask(s));
+        if (RAPIDJSON_LIKELY((stop | high) == 0)) {
+            p += 64;
+            continue;
+        }
+
+        const uint64_t beforeStop = stop != 0 ? (stop - 1) & ~stop : ~static_cast<uint64_t>(0);
+        if ((high & beforeStop) == 0)
+            return p + (stop != 0 ? internal::LowestBit(stop) : 64);
+
+        const __m512i lanes = _mm512_maskz_permutexvar_epi64(0xFC, laneUp, s); // Each lane moved up one, zeros below
+        const __m512i prev1 = _mm512_alignr_epi8(s, lanes, 16 - 1);
+        const __m512i prev2 = _mm512_alignr_epi8(s, lanes, 16 - 2);
+        const __m512i prev3 = _mm512_alignr_epi8(s, lanes, 16 - 3);
+        const __m512i special = _mm512_and_si512(_mm512_and_si512(
+            _mm512_shuffle_epi8(byte1High, _mm512_and_si512(_mm512_srli_epi16(prev1, 4), nibble)),
+            _mm512_shuffle_epi8(byte1Low, _mm512_and_si512(prev1, nibble))),
+            _mm512_shuffle_epi8(byte2High, _mm512_and_si512(_mm512_srli_epi16(s, 4), nibble)));
+        const __m512i must23 = _mm512_and_si512(_mm512_or_si512(_mm512_subs_epu8(prev2, third), _mm512_subs_epu8(prev3, fourth)), msb);
+        const __m512i e = _mm512_xor_si512(must23, special);
+        const uint64_t errors = static_cast<uint64_t>(_mm512_test_epi8_mask(e, e));
+
+        if (stop != 0)
+            return (errors & (beforeStop | (stop & ~(stop - 1)))) == 0 ? p + internal::LowestBit(stop) : p;
+        const unsigned length = 64 - UTF8IncompleteTail(p + 64);
+        if ((errors & (~static_cast<uint64_t>(0) >> (64 - length) << 1 | 1)) != 0) // Up to the byte after the block
+            return p;
+        p += length;
+    }
+}
+#endif // RAPIDJSON_SIMD_HAS_AVX512
+
 #ifdef RAPIDJSON_SIMD
+//! Skip whitespace with the widest instruction set available.
+inline const char *SkipWhitespace_Dispatch(const char* p) {
+#ifdef RAPIDJSON_SIMD_HAS_AVX512
+    if (internal::GetSimdLevel() == internal::kSimdAVX512)
+        return SkipWhitespace_AVX512(p);
+#endif
+#ifdef RAPIDJSON_SIMD_HAS_AVX2
+    if (internal::GetSimdLevel() == internal::kSimdAVX2)
+        return SkipWhitespace_AVX2(p);
+#endif
+    return SkipWhitespace_SIMD(p);
+}
+
+inline const char *SkipWhitespace_Dispatch(const char* p, const char* end) {
+#ifdef RAPIDJSON_SIMD_HAS_AVX512
+    if (internal::GetSimdLevel() == internal::kSimdAVX512)
+        return SkipWhitespace_AVX512(p, end);
+#endif
+#ifdef RAPIDJSON_SIMD_HAS_AVX2
+    if (internal::GetSimdLevel() == internal::kSimdAVX2)
+        return SkipWhitespace_AVX2(p, end);
+#endif
+    return SkipWhitespace_SIMD(p, end);
+}
+
+#ifdef RAPIDJSON_SIMD_HAS_AVX2
+//! Find the end of an unescaped run with AVX-512BW or AVX2, whichever is available.
+inline const char *ScanUnescapedString_AVX(const char* p) {
+#ifdef RAPIDJSON_SIMD_HAS_AVX512
+    if (internal::GetSimdLevel() == internal::kSimdAVX512)
+        return ScanUnescapedString_AVX512(p);
+#endif
+    return ScanUnescapedString_AVX2(p);
+}
+
+template <typename OutputStream>
+inline const char *ScanCopyUnescapedString_AVX(const char* p, OutputStream& os) {
+#ifdef RAPIDJSON_SIMD_HAS_AVX512
+    if (internal::GetSimdLevel() == internal::kSimdAVX512)
+        return ScanCopyUnescapedString_AVX512(p, os);
+#endif
+    return ScanCopyUnescapedString_AVX2(p, os);
+}
+#endif
+
+//! Find the end of a run of valid UTF-8 with the widest instruction set available.
+/*! Without SSE4.2 or AVX2 it returns \c p, the reader then validates character by character.
+*/
+inline const char *ScanValidUnescapedString_Dispatch(const char* p) {
+#ifdef RAPIDJSON_SIMD_HAS_AVX512
+    if (internal::GetSimdLevel() == internal::kSimdAVX512)
+        return ScanValidUnescapedString_AVX512(p);
+#endif
+#ifdef RAPIDJSON_SIMD_HAS_AVX2
+    if (internal::GetSimdLevel() == internal::kSimdAVX2)
+        return ScanValidUnescapedString_AVX2(p);
+#endif
+#ifdef RAPIDJSON_SSE42
+    return ScanValidUnescapedString_SIMD(p);
+#else
+    return p;
+#endif
+}
+
 //! Template function specialization for InsituStringStream
 template<> inline void SkipWhitespace(InsituStringStream& is) {
-    is.src_ = const_cast<char*>(SkipWhitespace_SIMD(is.src_));
+    is.src_ = const_cast<char*>(SkipWhitespace_Dispatch(is.src_));
 }
 
 //! Template function specialization for StringStream
 template<> inline void SkipWhitespace(StringStream& is) {
-    is.src_ = SkipWhitespace_SIMD(is.src_);
+    is.src_ = SkipWhitespace_Dispatch(is.src_);
 }
 
 template<> inline void SkipWhitespace(EncodedInputStream<UTF8<>, MemoryStream>& is) {
-    is.is_.src_ = SkipWhitespace_SIMD(is.is_.src_, is.is_.end_);
+    is.is_.src_ = SkipWhitespace_Dispatch(is.is_.src_, is.is_.end_);
 }
 #endif // RAPIDJSON_SIMD
 
+///////////////////////////////////////////////////////////////////////////////
+// IsStringStream
+
+namespace internal {
+
+//! Whether a stream keeps the whole text, so the reader can read a token again from its head.
+template <typename Stream> struct IsStringStream : FalseType {};
+template <typename Encoding> struct IsStringStream<GenericStringStream<Encoding> > : TrueType {};
+template <typename Encoding> struct IsStringStream<GenericInsituStringStream<Encoding> > : TrueType {};
+
+} // namespace internal
+
 ///////////////////////////////////////////////////////////////////////////////
 // GenericReader
 
@@ -471,7 +1046,7 @@ public:
     /*! \param stackAllocator Optional allocator for allocating stack memory. (Only use for non-destructive parsing)
         \param stackCapacity stack capacity in bytes for storing a single decoded string.  (Only use for non-destructive parsing)
     */
-    GenericReader(StackAllocator* stackAllocator = 0, size_t stackCapacity = kDefaultStackCapacity) : stack_(stackAllocator, stackCapacity), parseResult_() {}
+    GenericReader(StackAllocator* stackAllocator = 0, size_t stackCapacity = kDefaultStackCapacity) : stack_(stackAllocator, stackCapacity), index_(stackAllocator, stackCapacity), parseResult_() {}
 
     //! Parse JSON text.
     /*! \tparam parseFlags Combination of \ref ParseFlag.
@@ -486,6 +1061,9 @@ public:
         if (parseFlags & kParseIterativeFlag)
             return IterativeParse<parseFlags>(is, handler);
 
+        if (parseFlags & kParseStructuralIndexFlag)
+            return IndexedParse<parseFlags>(is, handler);
+
         parseResult_.Clear();
 
         ClearStackOnExit scope(*this);
@@ -544,7 +1122,7 @@ private:
     GenericReader(const GenericReader&);
     GenericReader& operator=(const GenericReader&);
 
-    void ClearStack() { stack_.Clear(); }
+    void ClearStack() { stack_.Clear(); index_.Clear(); }
 
     // clear stack on any exit from ParseStream, e.g. due to exception
     struct ClearStackOnExit {
@@ -556,6 +1134,178 @@ private:
         ClearStackOnExit& operator=(const ClearStackOnExit&);
     };
 
+    // Streams without an index specialization are parsed directly
+    template <unsigned parseFlags, typename InputStream, typename Handler>
+    ParseResult IndexedParse(InputStream& is, Handler& handler) {
+        return Parse<parseFlags & ~kParseStructuralIndexFlag>(is, handler);
+    }
+
+    template <unsigned parseFlags, typename Handler>
+    ParseResult IndexedParse(StringStream& is, Handler& handler) {
+        return IndexedParseString<parseFlags>(is, handler);
+    }
+
+    template <unsigned parseFlags, typename Handler>
+    ParseResult IndexedParse(InsituStringStream& is, Handler& handler) {
+        return IndexedParseString<parseFlags>(is, handler);
+    }
+
+    // Same events and errors as Parse(), finding the tokens from the positions indexed by internal::StructuralIndex
+    template <unsigned parseFlags, typename InputStream, typename Handler>
+    ParseResult IndexedParseString(InputStream& is, Handler& handler) {
+        if (parseFlags & kParseCommentsFlag) // Comments may contain unbalanced quotation marks
+            return Parse<parseFlags & ~kParseStructuralIndexFlag>(is, handler);
+
+        parseResult_.Clear();
+
+        ClearStackOnExit scope(*this);
+
+        index_.Reset(is.src_);
+        is.src_ = const_cast<typename InputStream::Ch*>(index_.Peek(is.src_));
+
+        if (RAPIDJSON_UNLIKELY(is.Peek() == '\0')) {
+            RAPIDJSON_PARSE_ERROR_NORETURN(kParseErrorDocumentEmpty, is.Tell());
+            RAPIDJSON_PARSE_ERROR_EARLY_RETURN(parseResult_);
+        }
+        else {
+            ParseIndexedValue<parseFlags>(is, handler);
+            RAPIDJSON_PARSE_ERROR_EARLY_RETURN(parseResult_);
+
+            if (!(parseFlags & kParseStopWhenDoneFlag)) {
+                SkipIndexed(is);
+
+                if (RAPIDJSON_UNLIKELY(is.Peek() != '\0')) {
+                    RAPIDJSON_PARSE_ERROR_NORETURN(kParseErrorDocumentRootNotSingular, is.Tell());
+                    RAPIDJSON_PARSE_ERROR_EARLY_RETURN(parseResult_);
+                }
+            }
+        }
+
+        return parseResult_;
+    }
+
+    // Jump over whitespace to the next token, after the current one has been read
+    template <typename InputStream>
+    RAPIDJSON_FORCEINLINE void SkipIndexed(InputStream& is) {
+        is.src_ = const_cast<typename InputStream::Ch*>(index_.Next(is.src_));
+    }
+
+    // An object or array being parsed by ParseIndexedValue()
+    struct IndexedLevel {
+        SizeType count;     // Members or elements so far
+        bool object;
+    };
+
+    // Parse a value without recursion, the open objects and arrays are kept on the stack
+    template<unsigned parseFlags, typename InputStream, typename Handler>
+    void ParseIndexedValue(InputStream& is, Handler& handler) {
+        for (;;) {
+            switch (is.Peek()) {
+                case '{':
+                    is.Take();
+                    if (RAPIDJSON_UNLIKELY(!handler.StartObject()))
+                        RAPIDJSON_PARSE_ERROR(kParseErrorTermination, is.Tell());
+                    SkipIndexed(is);
+                    if (!Consume(is, '}')) {
+                        IndexedLevel* level = stack_.template Push<IndexedLevel>();
+                        level->count = 0;
+                        level->object = true;
+                        ParseIndexedName<parseFlags>(is, handler);
+                        RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
+                        continue;
+                    }
+                    if (RAPIDJSON_UNLIKELY(!handler.EndObject(0)))  // empty object
+                        RAPIDJSON_PARSE_ERROR(kParseErrorTermination, is.Tell());
+                    break;
+                case '[':
+                    is.Take();
+                    if (RAPIDJSON_UNLIKELY(!handler.StartArray()))
+                        RAPIDJSON_PARSE_ERROR(kParseErrorTermination, is.Tell());
+                    SkipIndexed(is);
+                    if (!Consume(is, ']')) {
+                        IndexedLevel* level = stack_.template Push<IndexedLevel>();
+                        level->count = 0;
+                        level->object = false;
+                        continue;
+                    }
+                    if (RAPIDJSON_UNLIKELY(!handler.EndArray(0))) // empty array
+                        RAPIDJSON_PARSE_ERROR(kParseErrorTermination, is.Tell());
+                    break;
+                case 'n': ParseNull  <parseFlags>(is, handler); break;
+                case 't': ParseTrue  <parseFlags>(is, handler); break;
+                case 'f': ParseFalse <parseFlags>(is, handler); break;
+                case '"': ParseString<parseFlags>(is, handler); break;
+                default : ParseNumber<parseFlags>(is, handler); break;
+            }
+            RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
+
+            // Close the objects and arrays ending after the value, until the next value
+            for (;;) {
+                if (stack_.Empty())
+                    return;
+
+                IndexedLevel& level = *stack_.template Top<IndexedLevel>();
+                const SizeType count = ++level.count;
+                SkipIndexed(is);
+
+                if (level.object) {
+                    if (Consume(is, ',')) {
+                        SkipIndexed(is);
+                        if ((parseFlags & kParseTrailingCommasFlag) && is.Peek() == '}') {
+                            if (RAPIDJSON_UNLIKELY(!handler.EndObject(count)))
+                                RAPIDJSON_PARSE_ERROR(kParseErrorTermination, is.Tell());
+                            is.Take();
+                            stack_.template Pop<IndexedLevel>(1);
+                            continue;
+                        }
+                        ParseIndexedName<parseFlags>(is, handler);
+                        RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
+                        break;
+                    }
+                    if (RAPIDJSON_UNLIKELY(!Consume(is, '}')))
+                        RAPIDJSON_PARSE_ERROR(kParseErrorObjectMissCommaOrCurlyBracket, is.Tell());
+                    stack_.template Pop<IndexedLevel>(1);
+                    if (RAPIDJSON_UNLIKELY(!handler.EndObject(count)))
+                        RAPIDJSON_PARSE_ERROR(kParseErrorTermination, is.Tell());
+                }
+                else {
+                    if (Consume(is, ',')) {
+                        SkipIndexed(is);
+                        if ((parseFlags & kParseTrailingCommasFlag) && is.Peek() == ']') {
+                            if (RAPIDJSON_UNLIKELY(!handler.EndArray(count)))
+                                RAPIDJSON_PARSE_ERROR(kParseErrorTermination, is.Tell());
+                            is.Take();
+                            stack_.template Pop<IndexedLevel>(1);
+                            continue;
+                        }
+                        break;
+                    }
+                    if (RAPIDJSON_UNLIKELY(!Consume(is, ']')))
+                        RAPIDJSON_PARSE_ERROR(kParseErrorArrayMissCommaOrSquareBracket, is.Tell());
+                    stack_.template Pop<IndexedLevel>(1);
+                    if (RAPIDJSON_UNLIKELY(!handler.EndArray(count)))
+                        RAPIDJSON_PARSE_ERROR(kParseErrorTermination, is.Tell());
+                }
+            }
+        }
+    }
+
+    // Parse the name of a member up to its value: string :
+    template<unsigned parseFlags, typename InputStream, typename Handler>
+    void ParseIndexedName(InputStream& is, Handler& handler) {
+        if (RAPIDJSON_UNLIKELY(is.Peek() != '"'))
+            RAPIDJSON_PARSE_ERROR(kParseErrorObjectMissName, is.Tell());
+
+        ParseString<parseFlags>(is, handler, true);
+        RAPIDJSON_PARSE_ERROR_EARLY_RETURN_VOID;
+
+        SkipIndexed(is);
+        if (RAPIDJSON_UNLIKELY(!Consume(is, ':')))
+            RAPIDJSON_PARSE_ERROR(kParseErrorObjectMissColon, is.Tell());
+
+        SkipIndexed(is);
+    }
+
     template<unsigned parseFlags, typename InputStream>
     void SkipWhitespaceAndComments(InputStream& is) {
         SkipWhitespace(is);
@@ -852,7 +1602,9 @@ private:
 
         for (;;) {
             // Scan and copy string before "\\\"" or < 0x20. This is an optional optimzation.
-            if (!(parseFlags & kParseValidateEncodingFlag))
+            if (parseFlags & kParseValidateEncodingFlag)
+                ScanCopyValidUnescapedString(SEncoding(), TEncoding(), is, os);
+            else
                 ScanCopyUnescapedString(is, os);
 
             Ch c = is.Peek();
@@ -909,9 +1661,21 @@ private:
             // Do nothing for generic version
     }
 
+    template<typename SEncoding, typename TEncoding, typename InputStream, typename OutputStream>
+    static RAPIDJSON_FORCEINLINE void ScanCopyValidUnescapedString(SEncoding, TEncoding, InputStream&, OutputStream&) {
+            // Do nothing for generic version
+    }
+
 #if defined(RAPIDJSON_SSE2) || defined(RAPIDJSON_SSE42)
     // StringStream -> StackStream<char>
     static RAPIDJSON_FORCEINLINE void ScanCopyUnescapedString(StringStream& is, StackStream<char>& os) {
+#ifdef RAPIDJSON_SIMD_HAS_AVX2
+        if (internal::GetSimdLevel() != internal::kSimdSSE) {
+            is.src_ = ScanCopyUnescapedString_AVX(is.src_, os);
+            return;
+        }
+#endif
+
         const char* p = is.src_;
 
         // Scan one by one until alignment (unaligned load may cross page boundary and cause crash)
@@ -927,7 +1691,7 @@ private:
         // The rest of string using SIMD
         static const char dquote[16] = { '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"' };
         static const char bslash[16] = { '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\' };
-        static const char space[16]  = { 0x19, 0x19, 0x19, 0x19, 0x19, 0x19, 0x19, 0x19, 0x19, 0x19, 0x19, 0x19, 0x19, 0x19, 0x19, 0x19 };
+        static const char space[16]  = { 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F };
         const __m128i dq = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&dquote[0]));
         const __m128i bs = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&bslash[0]));
         const __m128i sp = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&space[0]));
@@ -936,7 +1700,7 @@ private:
             const __m128i s = _mm_load_si128(reinterpret_cast<const __m128i *>(p));
             const __m128i t1 = _mm_cmpeq_epi8(s, dq);
             const __m128i t2 = _mm_cmpeq_epi8(s, bs);
-            const __m128i t3 = _mm_cmpeq_epi8(_mm_max_epu8(s, sp), sp); // s < 0x20 <=> max(s, 0x19) == 0x19
+            const __m128i t3 = _mm_cmpeq_epi8(_mm_max_epu8(s, sp), sp); // s < 0x20 <=> max(s, 0x1F) == 0x1F
             const __m128i x = _mm_or_si128(_mm_or_si128(t1, t2), t3);
             unsigned short r = static_cast<unsigned short>(_mm_movemask_epi8(x));
             if (RAPIDJSON_UNLIKELY(r != 0)) {   // some of characters is escaped
@@ -961,6 +1725,19 @@ private:
         is.src_ = p;
     }
 
+#ifdef RAPIDJSON_SIMD_HAS_AVX2
+    // Lets the AVX code write to the destination of an insitu stream like to a StackStream
+    struct InsituPushStream {
+        explicit InsituPushStream(char* dst) : dst_(dst) {}
+        RAPIDJSON_FORCEINLINE void* Push(SizeType count) {
+            char* q = dst_;
+            dst_ += count;
+            return q;
+        }
+        char* dst_;
+    };
+#endif
+
     // InsituStringStream -> InsituStringStream
     static RAPIDJSON_FORCEINLINE void ScanCopyUnescapedString(InsituStringStream& is, InsituStringStream& os) {
         RAPIDJSON_ASSERT(&is == &os);
@@ -971,6 +1748,15 @@ private:
             return;
         }
 
+#ifdef RAPIDJSON_SIMD_HAS_AVX2
+        if (internal::GetSimdLevel() != internal::kSimdSSE) {
+            InsituPushStream dst(is.dst_);
+            is.src_ = const_cast<char*>(ScanCopyUnescapedString_AVX(is.src_, dst));
+            is.dst_ = dst.dst_;
+            return;
+        }
+#endif
+
         char* p = is.src_;
         char *q = is.dst_;
 
@@ -988,7 +1774,7 @@ private:
         // The rest of string using SIMD
         static const char dquote[16] = { '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"' };
         static const char bslash[16] = { '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\' };
-        static const char space[16] = { 0x19, 0x19, 0x19, 0x19, 0x19, 0x19, 0x19, 0x19, 0x19, 0x19, 0x19, 0x19, 0x19, 0x19, 0x19, 0x19 };
+        static const char space[16] = { 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F };
         const __m128i dq = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&dquote[0]));
         const __m128i bs = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&bslash[0]));
         const __m128i sp = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&space[0]));
@@ -997,7 +1783,7 @@ private:
             const __m128i s = _mm_load_si128(reinterpret_cast<const __m128i *>(p));
             const __m128i t1 = _mm_cmpeq_epi8(s, dq);
             const __m128i t2 = _mm_cmpeq_epi8(s, bs);
-            const __m128i t3 = _mm_cmpeq_epi8(_mm_max_epu8(s, sp), sp); // s < 0x20 <=> max(s, 0x19) == 0x19
+            const __m128i t3 = _mm_cmpeq_epi8(_mm_max_epu8(s, sp), sp); // s < 0x20 <=> max(s, 0x1F) == 0x1F
             const __m128i x = _mm_or_si128(_mm_or_si128(t1, t2), t3);
             unsigned short r = static_cast<unsigned short>(_mm_movemask_epi8(x));
             if (RAPIDJSON_UNLIKELY(r != 0)) {   // some of characters is escaped
@@ -1020,9 +1806,37 @@ private:
         is.dst_ = q;
     }
 
+    // StringStream -> StackStream<char>, validating UTF-8
+    static RAPIDJSON_FORCEINLINE void ScanCopyValidUnescapedString(UTF8<>, UTF8<>, StringStream& is, StackStream<char>& os) {
+        const char* p = is.src_;
+        const char* q = ScanValidUnescapedString_Dispatch(p);
+        if (q != p) {
+            const SizeType length = static_cast<SizeType>(q - p);
+            std::memcpy(os.Push(length), p, length);
+            is.src_ = q;
+        }
+    }
+
+    // InsituStringStream -> InsituStringStream, validating UTF-8
+    static RAPIDJSON_FORCEINLINE void ScanCopyValidUnescapedString(UTF8<>, UTF8<>, InsituStringStream& is, InsituStringStream& os) {
+        RAPIDJSON_ASSERT(&is == &os);
+        (void)os;
+        char* q = const_cast<char*>(ScanValidUnescapedString_Dispatch(is.src_));
+        if (is.src_ != is.dst_)
+            std::memmove(is.dst_, is.src_, static_cast<size_t>(q - is.src_));
+        is.dst_ += q - is.src_;
+        is.src_ = q;
+    }
+
     // When read/write pointers are the same for insitu stream, just skip unescaped characters
     static RAPIDJSON_FORCEINLINE void SkipUnescapedString(InsituStringStream& is) {
         RAPIDJSON_ASSERT(is.src_ == is.dst_);
+#ifdef RAPIDJSON_SIMD_HAS_AVX2
+        if (internal::GetSimdLevel() != internal::kSimdSSE) {
+            is.src_ = is.dst_ = const_cast<char*>(ScanUnescapedString_AVX(is.src_));
+            return;
+        }
+#endif
         char* p = is.src_;
 
         // Scan one by one until alignment (unaligned load may cross page boundary and cause crash)
@@ -1036,7 +1850,7 @@ private:
         // The rest of string using SIMD
         static const char dquote[16] = { '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"', '\"' };
         static const char bslash[16] = { '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\', '\\' };
-        static const char space[16] = { 0x19, 0x19, 0x19, 0x19, 0x19, 0x19, 0x19, 0x19, 0x19, 0x19, 0x19, 0x19, 0x19, 0x19, 0x19, 0x19 };
+        static const char space[16] = { 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F };
         const __m128i dq = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&dquote[0]));
         const __m128i bs = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&bslash[0]));
         const __m128i sp = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&space[0]));
@@ -1045,7 +1859,7 @@ private:
             const __m128i s = _mm_load_si128(reinterpret_cast<const __m128i *>(p));
             const __m128i t1 = _mm_cmpeq_epi8(s, dq);
             const __m128i t2 = _mm_cmpeq_epi8(s, bs);
-            const __m128i t3 = _mm_cmpeq_epi8(_mm_max_epu8(s, sp), sp); // s < 0x20 <=> max(s, 0x19) == 0x19
+            const __m128i t3 = _mm_cmpeq_epi8(_mm_max_epu8(s, sp), sp); // s < 0x20 <=> max(s, 0x1F) == 0x1F
             const __m128i x = _mm_or_si128(_mm_or_si128(t1, t2), t3);
             unsigned short r = static_cast<unsigned short>(_mm_movemask_epi8(x));
             if (RAPIDJSON_UNLIKELY(r != 0)) {   // some of characters is escaped
@@ -1066,6 +1880,34 @@ private:
     }
 #endif
 
+    // Take eight ASCII digits at once, from the streams which expose their buffer.
+    template<typename InputStream>
+    static RAPIDJSON_FORCEINLINE bool TakeEightDigits(InputStream&, uint64_t*) { return false; }
+
+#if defined(RAPIDJSON_SIMD) && RAPIDJSON_64BIT && RAPIDJSON_ENDIAN == RAPIDJSON_LITTLEENDIAN
+    static RAPIDJSON_FORCEINLINE bool PeekEightDigits(const char* p, uint64_t* chunk) {
+        // The load may pass the end of the text, but not the end of its memory page
+        if ((reinterpret_cast<size_t>(p) & 4095) > 4096 - 8)
+            return false;
+        std::memcpy(chunk, p, 8);
+        return internal::IsEightDigits(*chunk);
+    }
+
+    static RAPIDJSON_FORCEINLINE bool TakeEightDigits(StringStream& is, uint64_t* chunk) {
+        if (!PeekEightDigits(is.src_, chunk))
+            return false;
+        is.src_ += 8;
+        return true;
+    }
+
+    static RAPIDJSON_FORCEINLINE bool TakeEightDigits(InsituStringStream& is, uint64_t* chunk) {
+        if (!PeekEightDigits(is.src_, chunk))
+            return false;
+        is.src_ += 8;
+        return true;
+    }
+#endif
+
     template<typename InputStream, bool backup, bool pushOnTake>
     class NumberStream;
 
@@ -1079,6 +1921,7 @@ private:
 
         RAPIDJSON_FORCEINLINE Ch Peek() const { return is.Peek(); }
         RAPIDJSON_FORCEINLINE Ch TakePush() { return is.Take(); }
+        RAPIDJSON_FORCEINLINE bool TakePushEightDigits(uint64_t* chunk) { return TakeEightDigits(is, chunk); }
         RAPIDJSON_FORCEINLINE Ch Take() { return is.Take(); }
 		  RAPIDJSON_FORCEINLINE void Push(char) {}
 
@@ -1104,6 +1947,13 @@ private:
             return Base::is.Take();
         }
 
+        RAPIDJSON_FORCEINLINE bool TakePushEightDigits(uint64_t* chunk) {
+            if (!Base::TakePushEightDigits(chunk))
+                return false;
+            std::memcpy(stackStream.Push(8), chunk, 8);
+            return true;
+        }
+
         RAPIDJSON_FORCEINLINE void Push(char c) {
             stackStream.Put(c);
         }
@@ -1129,13 +1979,39 @@ private:
         RAPIDJSON_FORCEINLINE Ch Take() { return Base::TakePush(); }
     };
 
+    // Copy the digits of a number back from a stream which keeps the text, for full precision without a NumberStream backup.
+    template<typename InputStream>
+    const char* PushNumberDigits(InputStream& is, size_t startOffset, size_t* length, size_t* decimalPosition, internal::TrueType) {
+        const typename InputStream::Ch* p = is.head_ + startOffset;
+        const typename InputStream::Ch* end = is.head_ + is.Tell();
+        StackStream<char> digits(stack_);
+        bool fraction = false;
+        for (; p != end && *p != 'e' && *p != 'E'; ++p) {
+            if (*p == '.') {
+                *decimalPosition = digits.Length();
+                fraction = true;
+            }
+            else if (*p != '-')
+                digits.Put(static_cast<char>(*p));
+        }
+        *length = digits.Length();
+        if (!fraction)
+            *decimalPosition = *length;
+        digits.Put('\0');
+        return digits.Pop();
+    }
+
+    template<typename InputStream>
+    const char* PushNumberDigits(InputStream&, size_t, size_t*, size_t*, internal::FalseType) { return 0; }
+
     template<unsigned parseFlags, typename InputStream, typename Handler>
     void ParseNumber(InputStream& is, Handler& handler) {
+        // Full precision copies the digits while parsing, unless they can be read again from the text
         internal::StreamLocalCopy<InputStream> copy(is);
         NumberStream<InputStream,
             ((parseFlags & kParseNumbersAsStringsFlag) != 0) ?
                 ((parseFlags & kParseInsituFlag) == 0) :
-                ((parseFlags & kParseFullPrecisionFlag) != 0),
+                ((parseFlags & kParseFullPrecisionFlag) != 0 && !internal::IsStringStream<InputStream>::Value),
             (parseFlags & kParseNumbersAsStringsFlag) != 0 &&
                 (parseFlags & kParseInsituFlag) == 0> s(*this, copy.s);
 
@@ -1158,6 +2034,13 @@ private:
         else if (RAPIDJSON_LIKELY(s.Peek() >= '1' && s.Peek() <= '9')) {
             i = static_cast<unsigned>(s.TakePush() - '0');
 
+            // Nine digits cannot overflow
+            uint64_t chunk;
+            if (s.TakePushEightDigits(&chunk)) {
+                i = i * 100000000u + internal::ParseEightDigits(chunk);
+                significandDigit += 8;
+            }
+
             if (minus)
                 while (RAPIDJSON_LIKELY(s.Peek() >= '0' && s.Peek() <= '9')) {
                     if (RAPIDJSON_UNLIKELY(i >= 214748364)) { // 2^31 = 2147483648
@@ -1204,6 +2087,14 @@ private:
         // Parse 64bit int
         bool useDouble = false;
         if (use64bit) {
+            // Eight digits at a time while they cannot overflow
+            const uint64_t maxChunkPrefix = minus ? RAPIDJSON_UINT64_C2(0x00000015, 0x798EE22F) : RAPIDJSON_UINT64_C2(0x0000002A, 0xF31DC460); // 92233720367, 184467440736
+            uint64_t chunk;
+            while (i64 <= maxChunkPrefix && s.TakePushEightDigits(&chunk)) {
+                i64 = i64 * 100000000u + internal::ParseEightDigits(chunk);
+                significandDigit += 8;
+            }
+
             if (minus)
                 while (RAPIDJSON_LIKELY(s.Peek() >= '0' && s.Peek() <= '9')) {
                      if (RAPIDJSON_UNLIKELY(i64 >= RAPIDJSON_UINT64_C2(0x0CCCCCCC, 0xCCCCCCCC))) // 2^63 = 9223372036854775808
@@ -1240,6 +2131,7 @@ private:
         // Parse frac = decimal-point 1*DIGIT
         int expFrac = 0;
         size_t decimalPosition;
+        bool useI64Significand = false; // all digits of a double are in i64
         if (Consume(s, '.')) {
             decimalPosition = s.Length();
 
@@ -1248,12 +2140,29 @@ private:
 
             if (!useDouble) {
 #if RAPIDJSON_64BIT
-                // Use i64 to store significand in 64-bit architecture
+                // Use i64 to store significand in 64-bit architecture, up to 19 digits for full precision
                 if (!use64bit)
                     i64 = i;
+                const uint64_t maxSignificand = (parseFlags & kParseFullPrecisionFlag) ?
+                    RAPIDJSON_UINT64_C2(0x19999999, 0x99999998) :   // (2^64 - 1 - 9) / 10
+                    RAPIDJSON_UINT64_C2(0x1FFFFF, 0xFFFFFFFF);      // 2^53 - 1 for fast path
+
+                // Eight digits at a time while the digit loop below would take all of them
+                const uint64_t maxChunkPrefix = (parseFlags & kParseFullPrecisionFlag) ? RAPIDJSON_UINT64_C2(0x0000002A, 0xF31DC460) : 900719924; // 184467440736
+                uint64_t chunk;
+                while (i64 <= maxChunkPrefix && s.TakePushEightDigits(&chunk)) {
+                    const bool leadingZeros = i64 == 0;
+                    i64 = i64 * 100000000u + internal::ParseEightDigits(chunk);
+                    expFrac -= 8;
+                    if (!leadingZeros)
+                        significandDigit += 8;
+                    else
+                        for (uint64_t t = i64; t != 0; t /= 10)
+                            significandDigit++;
+                }
 
                 while (RAPIDJSON_LIKELY(s.Peek() >= '0' && s.Peek() <= '9')) {
-                    if (i64 > RAPIDJSON_UINT64_C2(0x1FFFFF, 0xFFFFFFFF)) // 2^53 - 1 for fast path
+                    if (i64 > maxSignificand)
                         break;
                     else {
                         i64 = i64 * 10 + static_cast<unsigned>(s.TakePush() - '0');
@@ -1264,6 +2173,7 @@ private:
                 }
 
                 d = static_cast<double>(i64);
+                useI64Significand = true;
 #else
                 // Use double to store significand in 32-bit architecture
                 d = static_cast<double>(use64bit ? i64 : i);
@@ -1272,6 +2182,7 @@ private:
             }
 
             while (RAPIDJSON_LIKELY(s.Peek() >= '0' && s.Peek() <= '9')) {
+                useI64Significand = false;
                 if (significandDigit < 17) {
                     d = d * 10.0 + (s.TakePush() - '0');
                     --expFrac;
@@ -1289,8 +2200,11 @@ private:
         int exp = 0;
         if (Consume(s, 'e') || Consume(s, 'E')) {
             if (!useDouble) {
-                d = static_cast<double>(use64bit ? i64 : i);
+                if (!use64bit)
+                    i64 = i;
+                d = static_cast<double>(i64);
                 useDouble = true;
+                useI64Significand = true;
             }
 
             bool expMinus = false;
@@ -1358,8 +2272,13 @@ private:
 
            if (useDouble) {
                int p = exp + expFrac;
-               if (parseFlags & kParseFullPrecisionFlag)
-                   d = internal::StrtodFullPrecision(d, p, decimal, length, decimalPosition, exp);
+               if (parseFlags & kParseFullPrecisionFlag) {
+                   if (!useI64Significand || !internal::StrtodSignificand(i64, p, &d)) {
+                       if (internal::IsStringStream<InputStream>::Value)
+                           decimal = PushNumberDigits(copy.s, startOffset, &length, &decimalPosition, internal::IsStringStream<InputStream>());
+                       d = internal::StrtodFullPrecision(d, p, decimal, length, decimalPosition, exp);
+                   }
+               }
                else
                    d = internal::StrtodNormalPrecision(d, p);
 
@@ -1855,6 +2774,7 @@ private:
 
     static const size_t kDefaultStackCapacity = 256;    //!< Default stack capacity in bytes for storing a single decoded string.
     internal::Stack<StackAllocator> stack_;  //!< A stack for storing decoded string temporarily during non-destructive parsing.
+    internal::StructuralIndex<StackAllocator> index_;  //!< Token positions from the first stage of kParseStructuralIndexFlag.
     ParseResult parseResult_;
 }; // class GenericReader
 
@@ -30,6 +30,13 @@
 #  define RAPIDJSON_SSE2
 #endif
 
+// Likewise __AVX2__ and __AVX512BW__ for the wider code.
+#if defined(__AVX512BW__)
+#  define RAPIDJSON_AVX512
+#elif defined(__AVX2__)
+#  define RAPIDJSON_AVX2
+#endif
+
 #define RAPIDJSON_HAS_STDSTRING 1
 
 ////////////////////////////////////////////////////////////////////////////////
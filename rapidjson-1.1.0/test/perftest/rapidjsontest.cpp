@@ -23,8 +23,15 @@
 #include "rapidjson/filereadstream.h"
 #include "rapidjson/encodedstream.h"
 #include "rapidjson/memorystream.h"
+#if RAPIDJSON_HAS_CXX11_THREAD
+#include "rapidjson/parallelparser.h"
+#endif
 
-#ifdef RAPIDJSON_SSE2
+#ifdef RAPIDJSON_AVX512
+#define SIMD_SUFFIX(name) name##_AVX512
+#elif defined(RAPIDJSON_AVX2)
+#define SIMD_SUFFIX(name) name##_AVX2
+#elif defined(RAPIDJSON_SSE2)
 #define SIMD_SUFFIX(name) name##_SSE2
 #elif defined(RAPIDJSON_SSE42)
 #define SIMD_SUFFIX(name) name##_SSE42
@@ -112,6 +119,14 @@ TEST_F(RapidJson, SIMD_SUFFIX(ReaderParseInsitu_DummyHandler_##Name)) {\
         Reader reader;\
         EXPECT_TRUE(reader.Parse<kParseInsituFlag>(s, h));\
     }\
+}\
+TEST_F(RapidJson, SIMD_SUFFIX(ReaderParse_DummyHandler_StructuralIndex_##Name)) {\
+    for (size_t i = 0; i < kTrialCount * 10; i++) {\
+        StringStream s(types_[index]);\
+        BaseReaderHandler<> h;\
+        Reader reader;\
+        EXPECT_TRUE(reader.Parse<kParseStructuralIndexFlag>(s, h));\
+    }\
 }
 
 TEST_TYPED(0, Booleans)
@@ -133,6 +148,59 @@ TEST_F(RapidJson, SIMD_SUFFIX(ReaderParse_DummyHandler_FullPrecision)) {
     }
 }
 
+// Array of 17-digit doubles in shortest form, like coordinates and metrics
+static void GenerateDoubles(StringBuffer& sb) {
+    Writer<StringBuffer> writer(sb);
+    uint64_t u = 1;
+    writer.StartArray();
+    for (int i = 0; i < 10000; i++) {
+        u = u * RAPIDJSON_UINT64_C2(0x5851F42D, 0x4C957F2D) + 1; // Deterministic across platforms
+        writer.Double(static_cast<double>(static_cast<int64_t>(u >> 11) - (int64_t(1) << 52)) / 25000000000000.0); // about -180..180
+    }
+    writer.EndArray();
+}
+
+TEST_F(RapidJson, SIMD_SUFFIX(ReaderParse_DummyHandler_Doubles)) {
+    StringBuffer sb;
+    GenerateDoubles(sb);
+    for (size_t i = 0; i < kTrialCount; i++) {
+        StringStream s(sb.GetString());
+        BaseReaderHandler<> h;
+        Reader reader;
+        EXPECT_TRUE(reader.Parse(s, h));
+    }
+}
+
+TEST_F(RapidJson, SIMD_SUFFIX(ReaderParse_DummyHandler_Doubles_FullPrecision)) {
+    StringBuffer sb;
+    GenerateDoubles(sb);
+    for (size_t i = 0; i < kTrialCount; i++) {
+        StringStream s(sb.GetString());
+        BaseReaderHandler<> h;
+        Reader reader;
+        EXPECT_TRUE(reader.Parse<kParseFullPrecisionFlag>(s, h));
+    }
+}
+
+TEST_F(RapidJson, SIMD_SUFFIX(ReaderParse_DummyHandler_StructuralIndex)) {
+    for (size_t i = 0; i < kTrialCount; i++) {
+        StringStream s(json_);
+        BaseReaderHandler<> h;
+        Reader reader;
+        EXPECT_TRUE(reader.Parse<kParseStructuralIndexFlag>(s, h));
+    }
+}
+
+TEST_F(RapidJson, SIMD_SUFFIX(ReaderParseInsitu_DummyHandler_StructuralIndex)) {
+    for (size_t i = 0; i < kTrialCount; i++) {
+        memcpy(temp_, json_, length_ + 1);
+        InsituStringStream s(temp_);
+        BaseReaderHandler<> h;
+        Reader reader;
+        EXPECT_TRUE(reader.Parse<kParseInsituFlag | kParseStructuralIndexFlag>(s, h));
+    }
+}
+
 TEST_F(RapidJson, SIMD_SUFFIX(ReaderParseIterative_DummyHandler)) {
     for (size_t i = 0; i < kTrialCount; i++) {
         StringStream s(json_);
@@ -187,6 +255,14 @@ TEST_F(RapidJson, SIMD_SUFFIX(DocumentParse_MemoryPoolAllocator)) {
     }
 }
 
+TEST_F(RapidJson, SIMD_SUFFIX(DocumentParse_MemoryPoolAllocator_StructuralIndex)) {
+    for (size_t i = 0; i < kTrialCount; i++) {
+        Document doc;
+        doc.Parse<kParseStructuralIndexFlag>(json_);
+        ASSERT_TRUE(doc.IsObject());
+    }
+}
+
 TEST_F(RapidJson, SIMD_SUFFIX(DocumentParseLength_MemoryPoolAllocator)) {
     for (size_t i = 0; i < kTrialCount; i++) {
         Document doc;
@@ -432,6 +508,82 @@ TEST_F(RapidJson, SIMD_SUFFIX(ReaderParse_DummyHandler_FileReadStream)) {
     }
 }
 
+#if RAPIDJSON_HAS_CXX11_THREAD
+
+// Array of about 32 MB of log-like records
+static const StringBuffer& Records() {
+    static StringBuffer sb;
+    if (sb.GetSize() == 0) {
+        Writer<StringBuffer> writer(sb);
+        uint64_t u = 1;
+        writer.StartArray();
+        for (int i = 0; sb.GetSize() < 32 * 1024 * 1024; i++) {
+            u = u * RAPIDJSON_UINT64_C2(0x5851F42D, 0x4C957F2D) + 1;
+            writer.StartObject();
+            writer.Key("id"); writer.Int(i);
+            writer.Key("user"); writer.String(i % 3 ? "alice, \"bob\" [admin]" : "carol");
+            writer.Key("latency"); writer.Double(static_cast<double>(u >> 40) / 1000.0);
+            writer.Key("ok"); writer.Bool((u & 1) != 0);
+            writer.Key("tags");
+            writer.StartArray();
+            for (unsigned j = 0; j < (u >> 60); j++) {
+                writer.StartObject(); writer.Key("k"); writer.Uint(j); writer.EndObject();
+            }
+            writer.EndArray();
+            writer.EndObject();
+        }
+        writer.EndArray();
+    }
+    return sb;
+}
+
+static const size_t kRecordsTrialCount = 10;
+
+TEST_F(RapidJson, SIMD_SUFFIX(DocumentParse_Records)) {
+    const StringBuffer& sb = Records();
+    for (size_t i = 0; i < kRecordsTrialCount; i++) {
+        Document doc;
+        doc.Parse(sb.GetString());
+        ASSERT_TRUE(doc.IsArray());
+    }
+}
+
+#define TEST_THREADS(threadCount, Name)\
+TEST_F(RapidJson, SIMD_SUFFIX(DocumentParseParallel_Records_##Name)) {\
+    const StringBuffer& sb = Records();\
+    ParallelParser parser(threadCount);\
+    for (size_t i = 0; i < kRecordsTrialCount; i++) {\
+        MemoryStream ms(sb.GetString(), sb.GetSize());\
+        Document doc;\
+        parser.Parse<0>(ms, doc);\
+        ASSERT_TRUE(doc.IsArray());\
+    }\
+}
+TEST_THREADS(1, 1Thread)
+TEST_THREADS(2, 2Threads)
+TEST_THREADS(4, 4Threads)
+TEST_THREADS(8, 8Threads)
+#undef TEST_THREADS
+
+TEST_F(RapidJson, SIMD_SUFFIX(DocumentParseParallel_Records_FileReadStream)) {
+    const StringBuffer& sb = Records();
+    FILE *fp = tmpfile();
+    ASSERT_TRUE(fp != 0);
+    fwrite(sb.GetString(), 1, sb.GetSize(), fp);
+    ParallelParser parser;
+    for (size_t i = 0; i < kRecordsTrialCount; i++) {
+        rewind(fp);
+        char buffer[65536];
+        FileReadStream s(fp, buffer, sizeof(buffer));
+        Document doc;
+        parser.Parse<0>(s, doc);
+        ASSERT_TRUE(doc.IsArray());
+    }
+    fclose(fp);
+}
+
+#endif // RAPIDJSON_HAS_CXX11_THREAD
+
 TEST_F(RapidJson, StringBuffer) {
     StringBuffer sb;
     for (int i = 0; i < 32 * 1024 * 1024; i++)
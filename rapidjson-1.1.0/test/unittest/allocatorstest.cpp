@@ -15,6 +15,7 @@
 #include "unittest.h"
 
 #include "rapidjson/allocators.h"
+#include <cstring>
 
 using namespace rapidjson;
 
@@ -100,3 +101,32 @@ TEST(Allocator, Issue399) {
         }
     }
 }
+
+TEST(Allocator, Splice) {
+    MemoryPoolAllocator<> a;
+    char* p = static_cast<char*>(a.Malloc(100));
+    std::memset(p, 'a', 100);
+
+    char buffer[256];
+    MemoryPoolAllocator<> b(buffer, sizeof(buffer), 64);
+    size_t userCapacity = b.Capacity();
+    b.Malloc(200);                                  // in the user buffer
+    char* q = static_cast<char*>(b.Malloc(1000));   // in a chunk
+    std::memset(q, 'q', 1000);
+    size_t capacity = a.Capacity() + b.Capacity() - userCapacity;
+    size_t size = a.Size() + b.Size() - 200;
+
+    a.Splice(b);
+    EXPECT_EQ(userCapacity, b.Capacity());
+    EXPECT_EQ(200u, b.Size());
+    EXPECT_EQ(capacity, a.Capacity());
+    EXPECT_EQ(size, a.Size());
+    EXPECT_EQ('a', p[99]);
+    EXPECT_EQ('q', q[999]);
+
+    char buffer2[256];
+    MemoryPoolAllocator<> c(buffer2, sizeof(buffer2));
+    c.Splice(a); // creates a base allocator to free the chunks
+    EXPECT_EQ(0u, a.Capacity());
+    EXPECT_EQ('q', q[999]);
+}
@@ -120,6 +120,8 @@ TEST(BigInteger, LeftShift) {
     EXPECT_TRUE(BIGINTEGER_LITERAL("4537899042132549697536") == a);
     a <<= 99;
     EXPECT_TRUE(BIGINTEGER_LITERAL("2876235222267216943024851750785644982682875244576768") == a);
+    a <<= 128; // Whole digits only, with more than one digit
+    EXPECT_TRUE(BIGINTEGER_LITERAL("978732129254460111761792264352943413317697704769180307922833106525737890120665683049054208") == a);
 }
 
 TEST(BigInteger, Compare) {
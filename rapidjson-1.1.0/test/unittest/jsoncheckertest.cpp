@@ -74,6 +74,9 @@ TEST(JsonChecker, Reader) {
         document.Parse<kParseIterativeFlag>(json);
         EXPECT_TRUE(document.HasParseError());
 
+        document.Parse<kParseStructuralIndexFlag>(json);
+        EXPECT_TRUE(document.HasParseError());
+
         free(json);
     }
 
@@ -94,6 +97,9 @@ TEST(JsonChecker, Reader) {
         document.Parse<kParseIterativeFlag>(json);
         EXPECT_FALSE(document.HasParseError());
 
+        document.Parse<kParseStructuralIndexFlag>(json);
+        EXPECT_FALSE(document.HasParseError());
+
         free(json);
     }
 }
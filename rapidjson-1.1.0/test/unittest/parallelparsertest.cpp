@@ -0,0 +1,182 @@
+// Tencent is pleased to support the open source community by making RapidJSON available.
+//
+// Copyright (C) 2015 THL A29 Limited, a Tencent company, and Milo Yip. All rights reserved.
+//
+// Licensed under the MIT License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// http://opensource.org/licenses/MIT
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "unittest.h"
+#include "rapidjson/rapidjson.h"
+
+#if RAPIDJSON_HAS_CXX11_THREAD
+
+#include "rapidjson/parallelparser.h"
+#include "rapidjson/filewritestream.h"
+#include <sstream>
+
+using namespace rapidjson;
+
+// Records with commas, brackets and escapes in strings, and arrays of objects, to mislead the slices.
+static std::string Records(unsigned count, unsigned seed = 0) {
+    Random r(seed);
+    std::ostringstream os;
+    os << "[";
+    for (unsigned i = 0; i < count; i++) {
+        if (i > 0)
+            os << (r() % 4 == 0 ? ",\n  " : ",");
+        os << "{\"id\":" << i
+           << ",\"name\":\"" << (r() % 2 ? "a,{\\\"b\\\":[1,{\\\"c\\\":2}]}" : "],[{,") << i << "\""
+           << ",\"score\":" << (r() % 1000) << "." << (r() % 100)
+           << ",\"tags\":[" << (r() % 3 ? "{\"k\":\",\"},{\"k\":[]}" : "") << "]"
+           << ",\"ok\":" << (r() % 2 ? "true" : "null") << "}";
+    }
+    os << "]";
+    return os.str();
+}
+
+template <unsigned parseFlags>
+static void TestParse(const std::string& json, unsigned threadCount, size_t sliceSize, const char* path = "") {
+    Document expected;
+    expected.Parse<parseFlags>(json.c_str());
+
+    ParallelParser parser(threadCount, sliceSize);
+    Document d;
+    MemoryStream ms(json.data(), json.size());
+    ParseResult result = parser.Parse<parseFlags>(ms, d, Pointer(path));
+
+    EXPECT_EQ(expected.GetParseError(), result.Code());
+    EXPECT_EQ(expected.GetErrorOffset(), result.Offset());
+    EXPECT_EQ(expected.GetParseError(), d.GetParseError());
+    EXPECT_EQ(expected.GetErrorOffset(), d.GetErrorOffset());
+    if (!expected.HasParseError()) {
+        EXPECT_TRUE(expected == d);
+    }
+}
+
+static void TestParse(const std::string& json, const char* path = "") {
+    TestParse<kParseDefaultFlags>(json, 1, 1024, path);
+    TestParse<kParseDefaultFlags>(json, 4, 1024, path);
+    TestParse<kParseDefaultFlags>(json, 3, 997, path);
+    TestParse<kParseDefaultFlags>(json, 8, 64, path);
+}
+
+TEST(ParallelParser, Records) {
+    TestParse(Records(0));
+    TestParse(Records(1));
+    TestParse(Records(1000));
+    TestParse(Records(1000, 1));
+    TestParse<kParseFullPrecisionFlag | kParseNanAndInfFlag>(Records(1000, 2), 4, 1024);
+    TestParse<kParseStructuralIndexFlag>(Records(1000, 3), 4, 1024);
+}
+
+TEST(ParallelParser, Scalars) {
+    TestParse("[]");
+    TestParse("  [ 1 , 2 ,\"3\", null,[ ]] ");
+    std::string numbers = "[";
+    std::string strings = "[";
+    for (int i = 0; i < 10000; i++) {
+        numbers += (i ? "," : "") + std::to_string(i * 31);
+        strings += (i ? ",\"" : "\"") + std::to_string(i) + (i % 3 ? "\\\"," : "]") + "\"";
+    }
+    TestParse(numbers + "]");
+    TestParse(strings + "]");
+}
+
+TEST(ParallelParser, NestedArrays) {
+    std::string json = "[";
+    for (int i = 0; i < 2000; i++)
+        json += i ? ",[[1,2],[3,[4,5]],{\"a\":[6,7]}]" : "[[1,2],[3,[4,5]],{\"a\":[6,7]}]";
+    TestParse(json + "]");
+}
+
+TEST(ParallelParser, BOM) {
+    TestParse("\xEF\xBB\xBF" + Records(200));
+}
+
+TEST(ParallelParser, Pointer) {
+    std::string records = Records(500);
+    TestParse("{\"name\":\"x\",\"items\":" + records + ",\"tail\":[\"]\"]}", "/items");
+    TestParse("{\"a\\u0062c\":{\"c\":1},\"a\\u0062\":[0," + records + "]}", "/ab/1");
+    TestParse("{\"items\":" + records + "}", "/missing");
+    TestParse("[1," + records + "]", "/0");
+    TestParse("{\"items\":" + records + "}"); // Root is not an array
+    TestParse("\"text\"");
+}
+
+TEST(ParallelParser, TrailingCommas) {
+    TestParse<kParseTrailingCommasFlag>("[1,2,]", 2, 1);
+    std::string records = Records(500);
+    TestParse<kParseTrailingCommasFlag>(records.substr(0, records.size() - 1) + ",]", 4, 1024);
+    TestParse<kParseDefaultFlags>("[1,2,]", 2, 1);
+}
+
+TEST(ParallelParser, Comments) {
+    TestParse<kParseCommentsFlag>("/* c */ [1, // c\n 2]", 4, 1);
+}
+
+TEST(ParallelParser, Error) {
+    std::string records = Records(1000);
+    TestParse(records.substr(0, records.size() - 1));
+    TestParse(records.substr(0, records.size() / 2));
+    TestParse(records.substr(0, records.size() / 2) + "]");
+    TestParse(records.substr(0, records.size() / 2) + "}" + records.substr(records.size() / 2));
+    TestParse(records + "x");
+    TestParse(records + "]");
+    TestParse("[1,]");
+    TestParse("[1 2]");
+    TestParse("[");
+    TestParse("");
+    TestParse("{\"items\":" + records + ",}", "/items");
+    TestParse("{\"items\":" + records.substr(0, records.size() / 3), "/items");
+    TestParse("{\"x\" 1,\"items\":" + records + "}", "/items");
+    TestParse("{\"x\":{\"items\":1}]" + records, "/x/items");
+}
+
+TEST(ParallelParser, FileReadStream) {
+    std::string json = "{\"items\":" + Records(5000) + "}";
+    char filename[L_tmpnam];
+    FILE* fp = TempFile(filename);
+    fwrite(json.data(), 1, json.size(), fp);
+    fclose(fp);
+
+    Document expected;
+    expected.Parse(json.c_str());
+
+    fp = fopen(filename, "rb");
+    char buffer[4096];
+    FileReadStream is(fp, buffer, sizeof(buffer));
+    ParallelParser parser(4, 10000);
+    Document d;
+    EXPECT_FALSE(parser.Parse<kParseDefaultFlags>(is, d, Pointer("/items")).IsError());
+    EXPECT_TRUE(expected == d);
+    fclose(fp);
+
+    // Parser is reused
+    MemoryStream ms(json.data(), json.size());
+    Document d2;
+    EXPECT_FALSE(parser.Parse<kParseDefaultFlags>(ms, d2, Pointer("/items")).IsError());
+    EXPECT_TRUE(expected == d2);
+    remove(filename);
+}
+
+TEST(ParallelParser, CrtAllocator) {
+    typedef GenericDocument<UTF8<>, CrtAllocator> CrtDocument;
+    std::string json = Records(1000);
+    CrtDocument expected;
+    expected.Parse(json.c_str());
+
+    GenericParallelParser<UTF8<>, CrtAllocator> parser(4, 1024);
+    CrtDocument d;
+    MemoryStream ms(json.data(), json.size());
+    EXPECT_FALSE(parser.Parse(ms, d).IsError());
+    EXPECT_TRUE(expected == d);
+}
+
+#endif // RAPIDJSON_HAS_CXX11_THREAD
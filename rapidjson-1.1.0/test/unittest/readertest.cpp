@@ -19,7 +19,10 @@
 #include "rapidjson/internal/itoa.h"
 #include "rapidjson/memorystream.h"
 
+#include <cstdlib>
+#include <cstring>
 #include <limits>
+#include <string>
 
 using namespace rapidjson;
 
@@ -291,6 +294,14 @@ static void TestParseDouble() {
     TEST_DOUBLE(fullPrecision, "5708990770823839207320493820740630171355185151999e-3", 5708990770823838890407843763683279797179383808.0);
     TEST_DOUBLE(fullPrecision, "5708990770823839207320493820740630171355185152001e-3", 5708990770823839524233143877797980545530986496.0);
 
+    // Eisel-Lemire: ties to even, more than 19 digits, and exponents out of its table
+    TEST_DOUBLE(fullPrecision, "5777326365.9166695e6", 5777326365916670.0);
+    TEST_DOUBLE(fullPrecision, "9007199254740993e0", 9007199254740992.0);
+    TEST_DOUBLE(fullPrecision, "126274749045196223849008707423.236e-213", 1.2627474904519621e-184);
+    TEST_DOUBLE(fullPrecision, "455709630773.3187481008e-191", 4.5570963077331871e-180);
+    TEST_DOUBLE(fullPrecision, "370.3547128703520828299741044e-340", 0.0);
+    TEST_DOUBLE(fullPrecision, "2.4703282292062328e-324", 4.9406564584124654e-324);
+
     {
         char n1e308[310];   // '1' followed by 308 '0'
         n1e308[0] = '1';
@@ -387,6 +398,77 @@ TEST(Reader, ParseNumber_FullPrecisionDouble) {
     TestParseDouble<true>();
 }
 
+static void TestFullPrecisionStrtod(const char* str) {
+    StringStream s(str);
+    ParseDoubleHandler h;
+    Reader reader;
+    ASSERT_EQ(kParseErrorNone, reader.Parse<kParseFullPrecisionFlag>(s, h).Code());
+    EXPECT_EQ(1u, h.step_);
+    internal::Double e(strtod(str, 0));
+    internal::Double a(h.actual_);
+    EXPECT_EQ(e.Uint64Value(), a.Uint64Value());
+    if (e.Uint64Value() != a.Uint64Value())
+        printf("  String: %s\n  Actual: %.17g\nExpected: %.17g\n", str, h.actual_, e.Value());
+}
+
+// Differential test against the C library's correctly rounded strtod().
+TEST(Reader, ParseNumber_FullPrecisionStrtod) {
+    Random r;
+    char buffer[128];
+
+    // Random significands of every length up to 40 digits, so both sides of each
+    // eight digit chunk and of the 19 digit limit are covered, with exponents
+    // from the subnormal range up to the largest doubles.
+    for (unsigned length = 1; length <= 40; length++) {
+        for (unsigned i = 0; i < 200; i++) {
+            char* p = buffer;
+            unsigned point = r() % (length + 1);
+            for (unsigned j = 0; j < length; j++) {
+                if (j == point && j > 0)
+                    *p++ = '.';
+                unsigned digit = r() % 10;
+                if (i % 4 == 1)
+                    digit = j == 0 ? 1 : (j < 17 ? digit : 0);  // runs of trailing zeros
+                else if (i % 4 == 2)
+                    digit = j == 0 ? 1 : (j < 17 ? digit : 9);  // runs of trailing nines
+                *p++ = static_cast<char>('0' + (j == 0 && digit == 0 ? 1 : digit));
+            }
+            // Decimal exponent of the leading digit from -340 to 307, short of overflow
+            int exp = static_cast<int>(r() % 648) - 339 - static_cast<int>(point ? point : length);
+            sprintf(p, "e%d", exp);
+            TestFullPrecisionStrtod(buffer);
+        }
+    }
+
+    // Exactly halfway between two adjacent doubles, and one digit either side of it,
+    // for normal and subnormal doubles. The 54 bit midpoint is exact in long double
+    // where it is wider than double.
+    for (uint64_t exp = 0; exp < 2046; exp += 5) {
+        for (unsigned i = 0; i < 10; i++) {
+            uint64_t u = (exp << 52) | uint64_t(r() & 0x000FFFFF) << 32;
+            u |= uint64_t(r());
+            internal::Double d(u);
+            long double mid = (static_cast<long double>(d.Value()) + static_cast<long double>(d.NextPositiveDouble())) / 2;
+            int n = sprintf(buffer, "%.60Le", mid);
+            TestFullPrecisionStrtod(buffer);
+
+            char* e = strchr(buffer, 'e');
+            char* last = e - 1;
+            while (*last == '0')
+                last--;
+            if (*last == '.')
+                continue;
+            std::string below(buffer, static_cast<size_t>(last - buffer));
+            below += static_cast<char>(*last - 1);
+            below.append(last + 1, static_cast<size_t>(buffer + n - last - 1));
+            TestFullPrecisionStrtod(below.c_str());
+            *e = '\0';
+            std::string above = std::string(buffer) + "1" + std::string("e") + (e + 1);
+            TestFullPrecisionStrtod(above.c_str());
+        }
+    }
+}
+
 TEST(Reader, ParseNumber_NormalPrecisionError) {
     static unsigned count = 1000000;
     Random r;
@@ -1841,4 +1923,193 @@ TEST(Reader, ParseNanAndInfinity) {
 #undef TEST_NAN_INF
 }
 
+// Records all events as text, to compare two ways of parsing
+struct LoggingHandler : BaseReaderHandler<UTF8<>, LoggingHandler> {
+    explicit LoggingHandler(int limit = -1) : log(), remaining(limit) {}
+    bool Default() { return Add("?"); }
+    bool Null() { return Add("n"); }
+    bool Bool(bool b) { return Add(b ? "t" : "f"); }
+    bool Int64(int64_t i) { std::ostringstream o; o << 'i' << i; return Add(o.str()); }
+    bool Uint64(uint64_t u) { std::ostringstream o; o << 'u' << u; return Add(o.str()); }
+    bool Int(int i) { return Int64(i); }
+    bool Uint(unsigned u) { return Uint64(u); }
+    bool Double(double d) { std::ostringstream o; o.precision(17); o << 'd' << d; return Add(o.str()); }
+    bool RawNumber(const char* str, SizeType length, bool) { return Add("r" + std::string(str, length)); }
+    bool String(const char* str, SizeType length, bool) { return Add("s[" + std::string(str, length) + "]"); }
+    bool Key(const char* str, SizeType length, bool) { return Add("ks[" + std::string(str, length) + "]"); }
+    bool StartObject() { return Add("{"); }
+    bool EndObject(SizeType n) { std::ostringstream o; o << '}' << n; return Add(o.str()); }
+    bool StartArray() { return Add("["); }
+    bool EndArray(SizeType n) { std::ostringstream o; o << ']' << n; return Add(o.str()); }
+
+    // Stops the parser after limit events, if not negative
+    bool Add(const std::string& event) {
+        log += event;
+        return remaining < 0 || remaining-- > 0;
+    }
+
+    std::string log;
+    int remaining;
+};
+
+template <unsigned parseFlags>
+static void TestStructuralIndex(const char* json, int limit = -1) {
+    Reader reader;
+    LoggingHandler expected(limit), actual(limit);
+    StringStream s1(json), s2(json);
+    const ParseResult r1 = reader.Parse<parseFlags>(s1, expected);
+    const ParseResult r2 = reader.Parse<parseFlags | kParseStructuralIndexFlag>(s2, actual);
+    EXPECT_EQ(r1.Code(), r2.Code()) << json;
+    EXPECT_EQ(r1.Offset(), r2.Offset()) << json;
+    EXPECT_EQ(s1.Tell(), s2.Tell()) << json;
+    EXPECT_EQ(expected.log, actual.log) << json;
+
+    std::string b1(json), b2(json);
+    LoggingHandler insituExpected(limit), insituActual(limit);
+    InsituStringStream i1(&b1[0]), i2(&b2[0]);
+    const ParseResult r3 = reader.Parse<parseFlags | kParseInsituFlag>(i1, insituExpected);
+    const ParseResult r4 = reader.Parse<parseFlags | kParseInsituFlag | kParseStructuralIndexFlag>(i2, insituActual);
+    EXPECT_EQ(r3.Code(), r4.Code()) << json;
+    EXPECT_EQ(r3.Offset(), r4.Offset()) << json;
+    EXPECT_EQ(i1.Tell(), i2.Tell()) << json;
+    EXPECT_EQ(insituExpected.log, insituActual.log) << json;
+    EXPECT_EQ(b1, b2) << json;
+}
+
+template <unsigned parseFlags>
+static void TestStructuralIndex(const std::string& json, int limit = -1) {
+    TestStructuralIndex<parseFlags>(json.c_str(), limit);
+}
+
+// Parses one root after the other from the same stream
+static void TestStructuralIndexStopWhenDone(const std::string& json) {
+    Reader reader;
+    LoggingHandler expected, actual;
+    StringStream s1(json.c_str()), s2(json.c_str());
+    for (;;) {
+        const ParseResult r1 = reader.Parse<kParseStopWhenDoneFlag>(s1, expected);
+        const ParseResult r2 = reader.Parse<kParseStopWhenDoneFlag | kParseStructuralIndexFlag>(s2, actual);
+        EXPECT_EQ(r1.Code(), r2.Code()) << json;
+        EXPECT_EQ(r1.Offset(), r2.Offset()) << json;
+        EXPECT_EQ(s1.Tell(), s2.Tell()) << json;
+        if (r1.IsError() || r2.IsError() || s1.Tell() != s2.Tell())
+            break;
+    }
+    EXPECT_EQ(expected.log, actual.log) << json;
+}
+
+TEST(Reader, StructuralIndex) {
+    static const char* json[] = {
+        "", " ", "[]", " { } ", "\t\n\r [ 1 , 2 ,\n3 ]\n", "{\"a\":1,\"b\":[true,false,null]}",
+        "  \"\\\\\" ", "\"\\\"\"", "[\"\\\\\\\"\", \"x\"]", "\"\\u0041\\uD834\\uDD1E\"", "\"a\tb\"",
+        "\"abc", "[1,", "[1 2]", "{\"a\" 1}", "[\"\\x\"]", " 1 2", "[\\\"]", "{\"a\\\"b\":\"c\"}",
+        "[\"a\\\"   \", \"  b\"]  ", "[0.5, -1e10, 12345678901234567890]", "[\" \\\\\" , \" \\\\\\\\\" ]",
+        "[1,]", "[1,,]", "[,]", "{\"a\":1,}", "{\"a\":1,,}", "{,}", "[1x]", "[truex, 1]", "[tru]", "nul", "-", "[-]",
+        "{\"a\":1 \"b\":2}", "[\"a\"\"b\"]", "{\"a\"}", "{\"a\":}", "{1:2}", "{\"a\":1]", "[1}", "[[[]],[{}],{\"a\":[{}]}]",
+        "[1] x", "1.5e3 ", "\"a\x01 b\"", "\x1A", "[\x0C]", "[1 ,\x1A" "2]", "[1,\x0C]", "{\"a\":\"b\"\x1A}",
+        "[NaN, -Infinity, Inf]", "[\"\xC3\xA9\", \"\xC3\"]", "[0.1e-400, 1e400]", "123456789012345678901234567890",
+    };
+    for (size_t i = 0; i < sizeof(json) / sizeof(json[0]); i++) {
+        TestStructuralIndex<kParseNoFlags>(json[i]);
+        TestStructuralIndex<kParseIterativeFlag>(json[i]);
+        TestStructuralIndex<kParseStopWhenDoneFlag>(json[i]);
+        TestStructuralIndex<kParseTrailingCommasFlag>(json[i]);
+        TestStructuralIndex<kParseNumbersAsStringsFlag>(json[i]);
+        TestStructuralIndex<kParseNanAndInfFlag | kParseFullPrecisionFlag>(json[i]);
+        TestStructuralIndex<kParseValidateEncodingFlag>(json[i]);
+        TestStructuralIndexStopWhenDone(json[i]);
+
+        // The handler stops the parser at every event
+        for (int limit = 0; limit < 12; limit++) {
+            TestStructuralIndex<kParseNoFlags>(json[i], limit);
+            TestStructuralIndex<kParseTrailingCommasFlag>(json[i], limit);
+        }
+    }
+
+    // Backslash runs, strings and whitespace across 64-byte block boundaries
+    for (size_t shift = 0; shift < 70; shift++) {
+        for (size_t backslashes = 1; backslashes <= 6; backslashes++) {
+            std::string s(shift, ' ');
+            s += "[\"";
+            s.append(shift, 'x');
+            s.append(backslashes, '\\');
+            s += "\" , \"";
+            s.append(64 - shift % 64, 'y');
+            s += "\"   ,\n\t\"z\"]";
+            s.append(shift, ' ');
+            TestStructuralIndex<kParseNoFlags>(s);
+        }
+    }
+
+    // Tokens, whitespace runs and strings across the batches of the index
+    {
+        std::string s = "[";
+        for (int i = 0; i < 20000; i++) {
+            s.append(static_cast<size_t>(i % 7), ' ');
+            s += i % 3 ? "{\"a\" :[1,-2.5e1, true ,null]}" : "\"\\\\x\\\"\"";
+            s += ",";
+        }
+        s.append(200000, ' ');
+        s += "\"";
+        s.append(200000, 'z');
+        s += "\"]";
+        TestStructuralIndex<kParseNoFlags>(s);
+        TestStructuralIndexStopWhenDone(s.substr(1, s.size() - 2));
+    }
+
+    // Texts ending right before or after a page boundary
+    {
+        char* buffer = static_cast<char*>(malloc(4 * 4096));
+        char* page = reinterpret_cast<char*>((reinterpret_cast<size_t>(buffer) | 4095) + 1);
+        static const char* text = "[1, \"a\\\"b\", {\"c\": [true, false]}, null ]";
+        const size_t length = strlen(text);
+        for (size_t end = 4096 - 80; end <= 4096 + 80; end++) {
+            memset(page, '"', 3 * 4096);
+            memcpy(page + end - length, text, length + 1);
+            TestStructuralIndex<kParseNoFlags>(page + end - length);
+            for (size_t i = 0; i < length; i++) // Strings and numbers cut off by the end of the text
+                if (text[i] == '"' || text[i] == '1') {
+                    memcpy(page + end - i, text, i);
+                    page[end] = '\0';
+                    TestStructuralIndex<kParseNoFlags>(page + end - i);
+                }
+        }
+        free(buffer);
+    }
+
+    // Random texts from the characters that matter to the index
+    {
+        static const char alphabet[] = "{}[]:,\"\\ \t\nan1-.e0tf";
+        unsigned seed = 1;
+        for (int i = 0; i < 20000; i++) {
+            std::string s;
+            seed = seed * 1103515245u + 12345u;
+            const size_t length = (seed >> 16) % 150;
+            for (size_t j = 0; j < length; j++) {
+                seed = seed * 1103515245u + 12345u;
+                s += alphabet[(seed >> 16) % (sizeof(alphabet) - 1)];
+            }
+            TestStructuralIndex<kParseNoFlags>(s);
+            TestStructuralIndex<kParseTrailingCommasFlag | kParseStopWhenDoneFlag>(s);
+        }
+
+        // Valid text with one or two characters replaced
+        const std::string valid = "{\"a\": [1, -2.5e3, \"x\\\\\\\"y\", true, false, null, {\"b\": {}}, []], \"c\" : \"\\\"\"}";
+        for (int i = 0; i < 20000; i++) {
+            std::string s(valid);
+            for (int j = 0; j < 1 + i % 2; j++) {
+                seed = seed * 1103515245u + 12345u;
+                const size_t position = (seed >> 16) % s.size();
+                seed = seed * 1103515245u + 12345u;
+                s[position] = alphabet[(seed >> 16) % (sizeof(alphabet) - 1)];
+            }
+            TestStructuralIndex<kParseNoFlags>(s);
+            TestStructuralIndex<kParseTrailingCommasFlag>(s);
+        }
+    }
+
+    // Comments are parsed without the index
+    TestStructuralIndex<kParseCommentsFlag>("[\"a\", /* \" */ 1 // \"\n]");
+}
+
 RAPIDJSON_DIAG_POP
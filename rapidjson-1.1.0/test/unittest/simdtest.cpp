@@ -23,6 +23,13 @@
 #  define RAPIDJSON_SSE2
 #endif
 
+// Likewise __AVX2__ and __AVX512BW__ for the wider code.
+#if defined(__AVX512BW__)
+#  define RAPIDJSON_AVX512
+#elif defined(__AVX2__)
+#  define RAPIDJSON_AVX2
+#endif
+
 #define RAPIDJSON_NAMESPACE rapidjson_simd
 
 #include "unittest.h"
@@ -37,7 +44,11 @@ RAPIDJSON_DIAG_OFF(effc++)
 
 using namespace rapidjson_simd;
 
-#ifdef RAPIDJSON_SSE2
+#ifdef RAPIDJSON_AVX512
+#define SIMD_SUFFIX(name) name##_AVX512
+#elif defined(RAPIDJSON_AVX2)
+#define SIMD_SUFFIX(name) name##_AVX2
+#elif defined(RAPIDJSON_SSE2)
 #define SIMD_SUFFIX(name) name##_SSE2
 #elif defined(RAPIDJSON_SSE42)
 #define SIMD_SUFFIX(name) name##_SSE42
@@ -95,6 +106,165 @@ TEST(SIMD, SIMD_SUFFIX(SkipWhitespace_EncodedMemoryStream)) {
     }
 }
 
+#ifdef RAPIDJSON_SIMD
+struct SimdKernels {
+    internal::SimdLevel level;
+    const char* (*skipWhitespace)(const char*);
+    const char* (*skipWhitespaceEnd)(const char*, const char*);
+    const char* (*scanUnescapedString)(const char*);
+    const char* (*scanValidUnescapedString)(const char*);
+};
+
+// Every code path compiled in and supported by this processor, not only the one the reader picks.
+static size_t GetSimdKernels(SimdKernels* kernels) {
+    size_t count = 0;
+#ifdef RAPIDJSON_SSE42
+    SimdKernels sse = { internal::kSimdSSE, SkipWhitespace_SIMD, SkipWhitespace_SIMD, 0, ScanValidUnescapedString_SIMD };
+#else
+    SimdKernels sse = { internal::kSimdSSE, SkipWhitespace_SIMD, SkipWhitespace_SIMD, 0, 0 };
+#endif
+    kernels[count++] = sse;
+#ifdef RAPIDJSON_SIMD_HAS_AVX2
+    if (internal::GetSimdLevel() >= internal::kSimdAVX2) {
+        SimdKernels avx2 = { internal::kSimdAVX2, SkipWhitespace_AVX2, SkipWhitespace_AVX2, ScanUnescapedString_AVX2, ScanValidUnescapedString_AVX2 };
+        kernels[count++] = avx2;
+    }
+#endif
+#ifdef RAPIDJSON_SIMD_HAS_AVX512
+    if (internal::GetSimdLevel() >= internal::kSimdAVX512) {
+        SimdKernels avx512 = { internal::kSimdAVX512, SkipWhitespace_AVX512, SkipWhitespace_AVX512, ScanUnescapedString_AVX512, ScanValidUnescapedString_AVX512 };
+        kernels[count++] = avx512;
+    }
+#endif
+    return count;
+}
+
+TEST(SIMD, SkipWhitespace_Kernels) {
+    SimdKernels kernels[3];
+    const size_t count = GetSimdKernels(kernels);
+    char buffer[64 + 200 + 2];
+    for (size_t k = 0; k < count; k++) {
+        for (size_t offset = 0; offset < 64; offset++) {
+            for (size_t length = 0; length < 200; length++) {
+                char* p = buffer + offset;
+                for (size_t i = 0; i < length; i++)
+                    p[i] = " \t\r\n"[i % 4];
+                p[length] = 'X';
+                p[length + 1] = '\0';
+
+                EXPECT_EQ(p + length, kernels[k].skipWhitespace(p)) << kernels[k].level;
+                EXPECT_EQ(p + length, kernels[k].skipWhitespaceEnd(p, p + length + 1)) << kernels[k].level;
+                EXPECT_EQ(p + length, kernels[k].skipWhitespaceEnd(p, p + length)) << kernels[k].level;
+                if (length > 0) {
+                    EXPECT_EQ(p + length - 1, kernels[k].skipWhitespaceEnd(p, p + length - 1)) << kernels[k].level;
+                }
+            }
+        }
+    }
+}
+
+TEST(SIMD, ScanUnescapedString_Kernels) {
+    SimdKernels kernels[3];
+    const size_t count = GetSimdKernels(kernels);
+    char buffer[64 + 200 + 2];
+    for (size_t k = 0; k < count; k++) {
+        if (!kernels[k].scanUnescapedString)
+            continue;
+        for (size_t offset = 0; offset < 64; offset++) {
+            for (size_t length = 0; length < 200; length++) {
+                char* p = buffer + offset;
+                for (size_t i = 0; i < length; i++)
+                    p[i] = "AB\xC3\xA9 \x7F"[i % 6];   // bytes >= 0x80 are not control characters
+                p[length] = "\"\\\x1F\0"[length % 4];
+                p[length + 1] = '\0';
+
+                EXPECT_EQ(p + length, kernels[k].scanUnescapedString(p)) << kernels[k].level;
+            }
+        }
+    }
+}
+
+// End of the valid characters before the first quotation mark, backslash or control character, checked one by one.
+static const char* ScanValidUnescapedStringReference(const char* p) {
+    GenericStringBuffer<UTF8<> > os;
+    while (*p != '\"' && *p != '\\' && static_cast<unsigned char>(*p) >= 0x20) {
+        StringStream is(p);
+        if (!UTF8<>::Validate(is, os))
+            break;
+        p = is.src_;
+    }
+    return p;
+}
+
+// Run a kernel the way the reader does: where it stops before the end of a page at a character
+// it did not look at, the character is validated one by one and the scan goes on after it.
+static const char* ScanValidUnescapedStringAsReader(const char* (*scan)(const char*), const char* p) {
+    GenericStringBuffer<UTF8<> > os;
+    for (;;) {
+        p = scan(p);
+        if (*p == '\"' || *p == '\\' || static_cast<unsigned char>(*p) < 0x20 || (reinterpret_cast<size_t>(p) & 4095) <= 4096 - 64)
+            return p;
+        StringStream is(p);
+        if (!UTF8<>::Validate(is, os))
+            return p;
+        p = is.src_;
+    }
+}
+
+TEST(SIMD, ScanValidUnescapedString_Kernels) {
+    SimdKernels kernels[3];
+    const size_t count = GetSimdKernels(kernels);
+    char buffer[2 * 4096];
+    // 160 bytes before a page boundary, so the long runs below cross it
+    char* json = buffer + (4096 - (reinterpret_cast<size_t>(buffer) + 160) % 4096) % 4096;
+    for (size_t k = 0; k < count; k++) {
+        if (!kernels[k].scanValidUnescapedString)
+            continue;
+        // All sequences of up to three bytes, and four bytes from the lead bytes of 4-byte characters,
+        // at both ends of a block
+        for (size_t offset = 0; offset < 64; offset += 61) {
+            memset(json, 'a', offset);
+            for (unsigned v = 0; v < 0x1000000; v++) {
+                const unsigned b0 = v >> 16, b1 = (v >> 8) & 0xFF, b2 = v & 0xFF;
+                if (b0 != 0 && (b0 < 0x7E || b1 < 0x7E || b1 > 0xC2 || b2 < 0x7E || b2 > 0xC2))
+                    continue;   // Longer sequences are sampled around the continuation range
+                char* p = json + offset;
+                if (b0 != 0)
+                    *p++ = static_cast<char>(b0);
+                if (b0 != 0 || b1 != 0)
+                    *p++ = static_cast<char>(b1);
+                *p++ = static_cast<char>(b2);
+                if (b0 >= 0xF0)
+                    *p++ = static_cast<char>(0x80 + (v & 0x3F));
+                strcpy(p, "\"xyz");
+
+                const char* expected = ScanValidUnescapedStringReference(json);
+                const char* actual = ScanValidUnescapedStringAsReader(kernels[k].scanValidUnescapedString, json);
+                // May stop early at an invalid block, but must not pass an error, nor stop before the end of valid text
+                ASSERT_LE(actual, expected) << kernels[k].level << " " << v;
+                if (*expected == '\"') {
+                    ASSERT_EQ(expected, actual) << kernels[k].level << " " << v;
+                }
+            }
+        }
+
+        // Long runs of multi-byte characters split at every position of a block
+        for (size_t offset = 0; offset < 64; offset++) {
+            char* p = json;
+            memset(p, 'a', offset);
+            p += offset;
+            static const char* const characters[] = { "A", "\xC3\xA9", "\xE2\x82\xAC", "\xF0\x9F\x98\x80" };
+            for (size_t i = 0; i < 120; i++)
+                p += sprintf(p, "%s", characters[i % 4]);
+            strcpy(p, "\"");
+            EXPECT_EQ(p, ScanValidUnescapedStringAsReader(kernels[k].scanValidUnescapedString, json)) << kernels[k].level;
+            p[-2] = '\xC3';    // Truncate the last character
+            EXPECT_GE(p - 2, ScanValidUnescapedStringAsReader(kernels[k].scanValidUnescapedString, json)) << kernels[k].level;
+        }
+    }
+}
+#endif // RAPIDJSON_SIMD
+
 struct ScanCopyUnescapedStringHandler : BaseReaderHandler<UTF8<>, ScanCopyUnescapedStringHandler> {
     bool String(const char* str, size_t length, bool) {
         memcpy(buffer, str, length + 1);
@@ -162,6 +332,28 @@ TEST(SIMD, SIMD_SUFFIX(ScanCopyUnescapedString)) {
     TestScanCopyUnescapedString<kParseInsituFlag, InsituStringStream>();
 }
 
+TEST(SIMD, SIMD_SUFFIX(ScanCopyUnescapedString_ControlCharacter)) {
+    char buffer[100];
+    for (unsigned c = 1; c < 0x20; c++) {
+        for (size_t i = 0; i < 80; i++) {
+            buffer[0] = '\"';
+            for (size_t j = 1; j < 81; j++)
+                buffer[j] = 'A';
+            buffer[1 + i] = static_cast<char>(c);
+            buffer[81] = '\"';
+            buffer[82] = '\0';
+
+            StringStream s(buffer);
+            BaseReaderHandler<> h;
+            Reader reader;
+            EXPECT_TRUE(reader.Parse(s, h).IsError()) << c << " at " << i;
+
+            InsituStringStream is(buffer);
+            EXPECT_TRUE(reader.Parse<kParseInsituFlag>(is, h).IsError()) << c << " at " << i;
+        }
+    }
+}
+
 TEST(SIMD, SIMD_SUFFIX(ScanWriteUnescapedString)) {
     char buffer[2048 + 1 + 32];
     for (size_t offset = 0; offset < 32; offset++) {